@@ -0,0 +1,116 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "AllocationStatistics.h"
+
+static const char* TAG_NAMES[ALLOCATION_TAG_COUNT] = {
+   "payload",
+   "envelope",
+   "atCommand",
+   "httpRequest"
+};
+
+typedef struct {
+   uint32_t sizeInBytes;
+   uint32_t tag;
+} ALLOCATION_HEADER;
+
+static ALLOCATION_STATISTICS statistics[ALLOCATION_TAG_COUNT];
+static uint32_t liveBytes       = 0;
+static uint32_t peakLiveBytes   = 0;
+
+static bool isValid(AllocationTag tag) {
+   return tag >= 0 && tag < ALLOCATION_TAG_COUNT;
+}
+
+void* writeAllocationHeader(void *storage, AllocationTag tag, size_t sizeInBytes) {
+   ALLOCATION_HEADER *header  = storage;
+   header->sizeInBytes        = sizeInBytes;
+   header->tag                = tag;
+   return (uint8_t*)storage + ALLOCATION_HEADER_SIZE;
+}
+
+void* readAllocationHeader(void *pointer, AllocationTag *tag, size_t *sizeInBytes) {
+   ALLOCATION_HEADER *header  = (ALLOCATION_HEADER*)((uint8_t*)pointer - ALLOCATION_HEADER_SIZE);
+   *sizeInBytes               = header->sizeInBytes;
+   *tag                       = header->tag;
+   return header;
+}
+
+int getLatencyBucket(uint32_t latencyUs) {
+   int bucket = 0;
+   while (latencyUs > 0 && bucket < LATENCY_BUCKET_COUNT - 1) {
+      latencyUs >>= 1;
+      bucket++;
+   }
+   return bucket;
+}
+
+void recordAllocation(AllocationTag tag, size_t sizeInBytes, uint32_t latencyUs) {
+   if (!isValid(tag)) {
+      return;
+   }
+   ALLOCATION_STATISTICS *tagStatistics = &statistics[tag];
+   tagStatistics->allocations++;
+   tagStatistics->bytes     += sizeInBytes;
+   tagStatistics->liveBytes += sizeInBytes;
+   tagStatistics->latencyHistogram[getLatencyBucket(latencyUs)]++;
+   liveBytes                += sizeInBytes;
+
+   if (tagStatistics->liveBytes > tagStatistics->peakLiveBytes) {
+      tagStatistics->peakLiveBytes = tagStatistics->liveBytes;
+   }
+   if (liveBytes > peakLiveBytes) {
+      peakLiveBytes = liveBytes;
+   }
+}
+
+void recordRelease(AllocationTag tag, size_t sizeInBytes) {
+   if (!isValid(tag)) {
+      return;
+   }
+   ALLOCATION_STATISTICS *tagStatistics = &statistics[tag];
+   uint32_t releasedBytes     = (sizeInBytes < tagStatistics->liveBytes) ? sizeInBytes : tagStatistics->liveBytes;
+   tagStatistics->releases++;
+   tagStatistics->liveBytes  -= releasedBytes;
+   liveBytes                 -= releasedBytes;
+}
+
+const ALLOCATION_STATISTICS* getAllocationStatistics(AllocationTag tag) {
+   return isValid(tag) ? &statistics[tag] : NULL;
+}
+
+uint32_t getPeakLiveBytes() {
+   return peakLiveBytes;
+}
+
+const char* getAllocationTagName(AllocationTag tag) {
+   return isValid(tag) ? TAG_NAMES[tag] : "unknown";
+}
+
+void resetAllocationStatistics() {
+   for (int tag = 0; tag < ALLOCATION_TAG_COUNT; tag++) {
+      uint32_t tagLiveBytes = statistics[tag].liveBytes;
+      memset(&statistics[tag], 0, sizeof(ALLOCATION_STATISTICS));
+      statistics[tag].liveBytes     = tagLiveBytes;
+      statistics[tag].peakLiveBytes = tagLiveBytes;
+   }
+   peakLiveBytes = liveBytes;
+}
+
+int formatMemoryStatistics(char *buffer, size_t bufferSize, const HEAP_STATISTICS *heap) {
+   size_t length = snprintf(buffer, bufferSize, "{\"heap\":[%u,%u,%u],\"peak\":%u", heap->freeBytes, heap->largestFreeBlock,
+      heap->minimumFreeBytes, peakLiveBytes);
+
+   for (int tag = 0; tag < ALLOCATION_TAG_COUNT && length < bufferSize; tag++) {
+      const ALLOCATION_STATISTICS *tagStatistics = &statistics[tag];
+      length += snprintf(buffer + length, bufferSize - length, ",\"%s\":[%u,%u,%u]", TAG_NAMES[tag], tagStatistics->allocations, 
+         tagStatistics->bytes, tagStatistics->peakLiveBytes);
+   }
+
+   if (length < bufferSize) {
+      length += snprintf(buffer + length, bufferSize - length, "}");
+   }
+   return (length < bufferSize) ? (int)length : -1;
+}
\ No newline at end of file
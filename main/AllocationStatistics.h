@@ -0,0 +1,94 @@
+#ifndef windsensor_allocation_statistics_h
+#define windsensor_allocation_statistics_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LATENCY_BUCKET_COUNT        8
+#define ALLOCATION_HEADER_SIZE      8
+
+/**
+ * Identifies the purpose of an allocation.
+ **/
+typedef enum {
+   ALLOCATION_TAG_PAYLOAD,
+   ALLOCATION_TAG_ENVELOPE,
+   ALLOCATION_TAG_AT_COMMAND,
+   ALLOCATION_TAG_HTTP_REQUEST,
+   ALLOCATION_TAG_COUNT
+} AllocationTag;
+
+/**
+ * Bucket 0 counts the allocations that took less than 1 us, bucket i (i > 0) those that took 2^(i-1) till 
+ * 2^i - 1 us and the last bucket all slower ones.
+ **/
+typedef struct {
+   uint32_t allocations;
+   uint32_t releases;
+   uint32_t bytes;
+   uint32_t liveBytes;
+   uint32_t peakLiveBytes;
+   uint32_t latencyHistogram[LATENCY_BUCKET_COUNT];
+} ALLOCATION_STATISTICS;
+
+typedef struct {
+   uint32_t freeBytes;
+   uint32_t largestFreeBlock;
+   uint32_t minimumFreeBytes;
+} HEAP_STATISTICS;
+
+/**
+ * Writes the tag and the size in front of the storage and returns the pointer the caller of allocate(...) gets. The 
+ * storage must be ALLOCATION_HEADER_SIZE bytes bigger than the requested size.
+ **/
+void* writeAllocationHeader(void *storage, AllocationTag tag, size_t sizeInBytes);
+
+/**
+ * Reads the tag and the size written by writeAllocationHeader(...) and returns the pointer to the storage.
+ **/
+void* readAllocationHeader(void *pointer, AllocationTag *tag, size_t *sizeInBytes);
+
+/**
+ * Records an allocation of the provided size that took latencyUs microseconds.
+ **/
+void recordAllocation(AllocationTag tag, size_t sizeInBytes, uint32_t latencyUs);
+
+/**
+ * Records the release of an allocation.
+ **/
+void recordRelease(AllocationTag tag, size_t sizeInBytes);
+
+/**
+ * Returns the statistics of the provided tag since the last reset.
+ **/
+const ALLOCATION_STATISTICS* getAllocationStatistics(AllocationTag tag);
+
+/**
+ * Returns the maximum of the bytes in use (all tags together) since the last reset.
+ **/
+uint32_t getPeakLiveBytes();
+
+/**
+ * Returns the index of the histogram bucket the latency belongs to.
+ **/
+int getLatencyBucket(uint32_t latencyUs);
+
+/**
+ * Returns a human readable name of the tag.
+ **/
+const char* getAllocationTagName(AllocationTag tag);
+
+/**
+ * Resets the counters but keeps the bytes in use.
+ **/
+void resetAllocationStatistics();
+
+/**
+ * Writes the statistics as compact JSON object into the buffer and returns the number of characters written (without 
+ * the null byte) or -1 if the buffer is too small.
+ * 
+ * Example: {"heap":[free,largestBlock,minimumFree],"peak":1234,"payload":[allocations,bytes,peakLiveBytes],...}
+ **/
+int formatMemoryStatistics(char *buffer, size_t bufferSize, const HEAP_STATISTICS *heap);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <string.h>
+
+#include "Arena.h"
+
+static size_t alignedSize(size_t sizeInBytes) {
+   return (sizeInBytes + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
+
+void initializeArena(ARENA *arena, void *region, size_t sizeInBytes) {
+   memset(&arena->statistics, 0, sizeof(ARENA_STATISTICS));
+   arena->region                 = region;
+   arena->statistics.sizeInBytes = (region == NULL) ? 0 : sizeInBytes;
+}
+
+void* allocateFromArena(ARENA *arena, size_t sizeInBytes) {
+   ARENA_STATISTICS *statistics  = &arena->statistics;
+   size_t requiredBytes          = alignedSize(sizeInBytes > 0 ? sizeInBytes : 1);
+   
+   if (requiredBytes < sizeInBytes || requiredBytes > statistics->sizeInBytes - statistics->usedBytes) {
+      statistics->overflows++;
+      return NULL;
+   }
+
+   void *storage            = arena->region + statistics->usedBytes;
+   statistics->usedBytes   += requiredBytes;
+   statistics->liveAllocations++;
+   statistics->allocations++;
+   
+   if (statistics->usedBytes > statistics->highWaterBytes) {
+      statistics->highWaterBytes = statistics->usedBytes;
+   }
+   return storage;
+}
+
+bool isInArena(const ARENA *arena, const void *pointer) {
+   const uint8_t *bytePointer = pointer;
+   return arena->region != NULL && bytePointer >= arena->region && bytePointer < arena->region + arena->statistics.sizeInBytes;
+}
+
+void releaseToArena(ARENA *arena, const void *pointer) {
+   if (isInArena(arena, pointer) && arena->statistics.liveAllocations > 0) {
+      arena->statistics.liveAllocations--;
+   }
+}
+
+bool resetArena(ARENA *arena) {
+   if (arena->statistics.liveAllocations > 0) {
+      arena->statistics.refusedResets++;
+      return false;
+   }
+   arena->statistics.usedBytes = 0;
+   arena->statistics.resets++;
+   return true;
+}
\ No newline at end of file
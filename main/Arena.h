@@ -0,0 +1,57 @@
+#ifndef windsensor_arena_h
+#define windsensor_arena_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_ALIGNMENT 8
+
+typedef struct {
+   size_t sizeInBytes;
+   size_t usedBytes;
+   size_t highWaterBytes;
+   uint32_t liveAllocations;
+   uint32_t allocations;
+   uint32_t overflows;
+   uint32_t resets;
+   uint32_t refusedResets;
+} ARENA_STATISTICS;
+
+/**
+ * A fixed region that hands out storage by incrementing an offset. Single allocations do not get reclaimed, the whole
+ * region gets reused after a reset.
+ **/
+typedef struct {
+   uint8_t *region;
+   ARENA_STATISTICS statistics;
+} ARENA;
+
+/**
+ * Initializes the arena with the provided region. The region must be aligned to ARENA_ALIGNMENT.
+ **/
+void initializeArena(ARENA *arena, void *region, size_t sizeInBytes);
+
+/**
+ * Returns storage of at least sizeInBytes bytes aligned to ARENA_ALIGNMENT or NULL if the remaining space of the 
+ * region is too small (overflow).
+ **/
+void* allocateFromArena(ARENA *arena, size_t sizeInBytes);
+
+/**
+ * Returns true if the pointer references storage of the region.
+ **/
+bool isInArena(const ARENA *arena, const void *pointer);
+
+/**
+ * Marks an allocation as no longer used. The storage stays occupied till the next reset.
+ **/
+void releaseToArena(ARENA *arena, const void *pointer);
+
+/**
+ * Makes the whole region available again. The reset gets refused (and false returned) if allocations are still in 
+ * use, because they would get overwritten by the next allocations.
+ **/
+bool resetArena(ARENA *arena);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "AtTrace.h"
+
+#define NO_COMMAND_KEY     "-"
+#define DATA_KEY           "<data>"
+
+static const char* KIND_NAMES[AT_TRACE_KIND_COUNT] = {
+   "command",
+   "response",
+   "timeout"
+};
+
+static void copyText(char *destination, const char *source, size_t destinationSize) {
+   size_t length = 0;
+   if (source != NULL) {
+      while (length < destinationSize - 1 && source[length] != 0) {
+         destination[length] = source[length];
+         length++;
+      }
+   }
+   destination[length] = 0;
+}
+
+void initializeAtTrace(AT_TRACE *trace, AT_TRACE_RECORD *records, uint32_t capacity) {
+   trace->records       = records;
+   trace->capacity      = capacity;
+   trace->first         = 0;
+   trace->count         = 0;
+   trace->lostRecords   = 0;
+}
+
+void recordAtTrace(AT_TRACE *trace, uint32_t timestampUs, AtTraceKind kind, const char *text, uint32_t timeoutMs) {
+   if (trace->capacity == 0) {
+      return;
+   }
+
+   if (trace->count == trace->capacity) {
+      trace->first = (trace->first + 1) % trace->capacity;
+      trace->count--;
+      trace->lostRecords++;
+   }
+
+   AT_TRACE_RECORD *record = &trace->records[(trace->first + trace->count) % trace->capacity];
+   record->timestampUs     = timestampUs;
+   record->timeoutMs       = timeoutMs;
+   record->kind            = kind;
+   
+   if (kind == AT_TRACE_COMMAND) {
+      getAtCommandKey(text, record->text, AT_TRACE_TEXT_LENGTH);
+   } else {
+      copyText(record->text, text, AT_TRACE_TEXT_LENGTH);
+   }
+   trace->count++;
+}
+
+bool takeAtTraceRecord(AT_TRACE *trace, AT_TRACE_RECORD *record) {
+   if (trace->count == 0) {
+      return false;
+   }
+   *record      = trace->records[trace->first];
+   trace->first = (trace->first + 1) % trace->capacity;
+   trace->count--;
+   return true;
+}
+
+void getAtCommandKey(const char *command, char *buffer, size_t bufferSize) {
+   if (command == NULL || strncmp(command, "AT", 2) != 0) {
+      copyText(buffer, DATA_KEY, bufferSize);
+      return;
+   }
+
+   size_t length = strcspn(command, "=?");
+   if (length > bufferSize - 1) {
+      length = bufferSize - 1;
+   }
+   memcpy(buffer, command, length);
+   buffer[length] = 0;
+}
+
+static void writeUint32(uint8_t *destination, uint32_t value) {
+   for (int i = 0; i < 4; i++) {
+      destination[i] = (value >> (8 * i)) & 0xff;
+   }
+}
+
+static uint32_t readUint32(const uint8_t *source) {
+   uint32_t value = 0;
+   for (int i = 0; i < 4; i++) {
+      value |= ((uint32_t)source[i]) << (8 * i);
+   }
+   return value;
+}
+
+static int hexValue(char character) {
+   if (character >= '0' && character <= '9') {
+      return character - '0';
+   }
+   if (character >= 'a' && character <= 'f') {
+      return character - 'a' + 10;
+   }
+   if (character >= 'A' && character <= 'F') {
+      return character - 'A' + 10;
+   }
+   return -1;
+}
+
+int encodeAtTraceRecord(const AT_TRACE_RECORD *record, char *buffer, size_t bufferSize) {
+   static const char *HEX_DIGITS = "0123456789abcdef";
+   uint8_t bytes[AT_TRACE_RECORD_SIZE];
+
+   if (bufferSize < AT_TRACE_LINE_LENGTH + 1) {
+      return -1;
+   }
+
+   memset(bytes, 0, sizeof(bytes));
+   writeUint32(bytes, record->timestampUs);
+   writeUint32(bytes + 4, record->timeoutMs);
+   bytes[8] = record->kind;
+   memcpy(bytes + 9, record->text, strnlen(record->text, AT_TRACE_TEXT_LENGTH - 1));
+
+   size_t length = strlen(AT_TRACE_LINE_PREFIX);
+   memcpy(buffer, AT_TRACE_LINE_PREFIX, length);
+   for (int i = 0; i < AT_TRACE_RECORD_SIZE; i++) {
+      buffer[length++] = HEX_DIGITS[bytes[i] >> 4];
+      buffer[length++] = HEX_DIGITS[bytes[i] & 0x0f];
+   }
+   buffer[length] = 0;
+   return (int)length;
+}
+
+bool decodeAtTraceRecord(const char *line, AT_TRACE_RECORD *record) {
+   uint8_t bytes[AT_TRACE_RECORD_SIZE];
+   const char *hex = strstr(line, AT_TRACE_LINE_PREFIX);
+
+   if (hex == NULL) {
+      return false;
+   }
+   hex += strlen(AT_TRACE_LINE_PREFIX);
+
+   for (int i = 0; i < AT_TRACE_RECORD_SIZE; i++) {
+      int high = hexValue(hex[2 * i]);
+      int low  = (high < 0) ? -1 : hexValue(hex[2 * i + 1]);
+      if (low < 0) {
+         return false;
+      }
+      bytes[i] = (uint8_t)((high << 4) | low);
+   }
+
+   if (bytes[8] >= AT_TRACE_KIND_COUNT) {
+      return false;
+   }
+
+   record->timestampUs = readUint32(bytes);
+   record->timeoutMs   = readUint32(bytes + 4);
+   record->kind        = bytes[8];
+   memcpy(record->text, bytes + 9, AT_TRACE_TEXT_LENGTH - 1);
+   record->text[AT_TRACE_TEXT_LENGTH - 1] = 0;
+   return true;
+}
+
+int extractAtTraceSamples(const AT_TRACE_RECORD *records, int recordCount, AT_TRACE_SAMPLE *samples, int maxSamples) {
+   const AT_TRACE_RECORD *command  = NULL;
+   const AT_TRACE_RECORD *previous = NULL;
+   int sampleCount                 = 0;
+
+   for (int i = 0; i < recordCount && sampleCount < maxSamples; i++) {
+      const AT_TRACE_RECORD *record = &records[i];
+
+      if (record->kind == AT_TRACE_COMMAND) {
+         command = record;
+      } else {
+         const AT_TRACE_RECORD *start = (command != NULL) ? command : previous;
+         AT_TRACE_SAMPLE *sample      = &samples[sampleCount++];
+         snprintf(sample->key, sizeof(sample->key), "%s -> %s", (command != NULL) ? command->text : NO_COMMAND_KEY, record->text);
+         // the unsigned difference is correct even if the timestamp wrapped around
+         sample->latencyUs = (start != NULL) ? record->timestampUs - start->timestampUs : 0;
+         sample->timeoutMs = record->timeoutMs;
+         sample->timedOut  = record->kind == AT_TRACE_TIMEOUT;
+      }
+      previous = record;
+   }
+   return sampleCount;
+}
+
+uint32_t getSortedPercentileUs(const uint32_t *sortedLatenciesUs, int count, int percent) {
+   if (count <= 0) {
+      return 0;
+   }
+   int rank = (count * percent + 99) / 100;
+   if (rank < 1) {
+      rank = 1;
+   }
+   return sortedLatenciesUs[rank - 1];
+}
+
+const char* getAtTraceKindName(AtTraceKind kind) {
+   return (kind >= 0 && kind < AT_TRACE_KIND_COUNT) ? KIND_NAMES[kind] : "unknown";
+}
\ No newline at end of file
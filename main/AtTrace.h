@@ -0,0 +1,98 @@
+#ifndef windsensor_at_trace_h
+#define windsensor_at_trace_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AT_TRACE_TEXT_LENGTH     24
+#define AT_TRACE_RECORD_SIZE     (4 + 4 + 1 + AT_TRACE_TEXT_LENGTH - 1)    // in bytes when encoded
+#define AT_TRACE_LINE_PREFIX     "attrace:"
+#define AT_TRACE_LINE_LENGTH     (sizeof(AT_TRACE_LINE_PREFIX) - 1 + 2 * AT_TRACE_RECORD_SIZE)
+#define AT_TRACE_KEY_LENGTH      (2 * AT_TRACE_TEXT_LENGTH + 4)
+
+typedef enum {
+   AT_TRACE_COMMAND,             // text = command (see getAtCommandKey)
+   AT_TRACE_RESPONSE,            // text = expected responses (one of them got received)
+   AT_TRACE_TIMEOUT,             // text = expected responses (none of them got received in time)
+   AT_TRACE_KIND_COUNT
+} AtTraceKind;
+
+/**
+ * The text gets truncated to AT_TRACE_TEXT_LENGTH - 1 characters. The timeout is 0 for commands.
+ **/
+typedef struct {
+   uint32_t timestampUs;
+   uint32_t timeoutMs;
+   uint8_t kind;
+   char text[AT_TRACE_TEXT_LENGTH];
+} AT_TRACE_RECORD;
+
+/**
+ * A ring of records. When it is full, the oldest record gets overwritten and counted as lost.
+ **/
+typedef struct {
+   AT_TRACE_RECORD *records;
+   uint32_t capacity;
+   uint32_t first;
+   uint32_t count;
+   uint32_t lostRecords;
+} AT_TRACE;
+
+/**
+ * One response (or timeout) and the time since the command it belongs to. The key consists of the command and the 
+ * expected responses (e.g. "AT+HTTPACTION -> +HTTPACTION:"), because some commands wait for several responses.
+ **/
+typedef struct {
+   char key[AT_TRACE_KEY_LENGTH];
+   uint32_t latencyUs;
+   uint32_t timeoutMs;
+   bool timedOut;
+} AT_TRACE_SAMPLE;
+
+void initializeAtTrace(AT_TRACE *trace, AT_TRACE_RECORD *records, uint32_t capacity);
+
+/**
+ * Appends a record. Commands get reduced to their key (see getAtCommandKey), so that the data of a request do not 
+ * fill the trace.
+ **/
+void recordAtTrace(AT_TRACE *trace, uint32_t timestampUs, AtTraceKind kind, const char *text, uint32_t timeoutMs);
+
+/**
+ * Removes the oldest record from the trace and copies it to the provided one. Returns false if the trace is empty.
+ **/
+bool takeAtTraceRecord(AT_TRACE *trace, AT_TRACE_RECORD *record);
+
+/**
+ * Writes the part of the command that identifies it (till the first "=" or "?", e.g. "AT+CREG" for "AT+CREG?") into 
+ * the buffer. Text not starting with "AT" (e.g. the body of a request) results in "<data>".
+ **/
+void getAtCommandKey(const char *command, char *buffer, size_t bufferSize);
+
+/**
+ * Writes the record as line (AT_TRACE_LINE_PREFIX followed by AT_TRACE_RECORD_SIZE bytes in hex, little endian) into 
+ * the buffer and returns its length or -1 if the buffer is too small.
+ **/
+int encodeAtTraceRecord(const AT_TRACE_RECORD *record, char *buffer, size_t bufferSize);
+
+/**
+ * Reads a record written by encodeAtTraceRecord(...). The prefix can be preceded by anything (e.g. the tag and the 
+ * timestamp of the log). Returns false if the line does not contain a valid record.
+ **/
+bool decodeAtTraceRecord(const char *line, AT_TRACE_RECORD *record);
+
+/**
+ * Pairs each response and timeout with the preceding command and writes the samples (in the order of the records) 
+ * into the provided array. A response without a preceding command (e.g. "RDY" after the power up) gets the key 
+ * "- -> <expected responses>" and the time since the previous record. Returns the number of samples written.
+ **/
+int extractAtTraceSamples(const AT_TRACE_RECORD *records, int recordCount, AT_TRACE_SAMPLE *samples, int maxSamples);
+
+/**
+ * Returns the percentile (0 - 100, nearest rank) of the ascending sorted latencies or 0 if there are none.
+ **/
+uint32_t getSortedPercentileUs(const uint32_t *sortedLatenciesUs, int count, int percent);
+
+const char* getAtTraceKindName(AtTraceKind kind);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <string.h>
+
+#include "AwakeTime.h"
+
+static AWAKE_TIME_STATISTICS statistics;
+static bool awake                = false;
+static uint32_t windowStartMs    = 0;
+static uint32_t lastUpdateMs     = 0;
+static uint32_t windowAwakeMs    = 0;
+
+static void completeWindow() {
+   statistics.lastMinuteAwakeMs  = windowAwakeMs;
+   statistics.totalAwakeMs      += windowAwakeMs;
+   statistics.completedMinutes++;
+   if (windowAwakeMs > statistics.maxMinuteAwakeMs) {
+      statistics.maxMinuteAwakeMs = windowAwakeMs;
+   }
+   windowAwakeMs = 0;
+}
+
+static void update(uint32_t nowMs) {
+   while (nowMs - windowStartMs >= AWAKE_TIME_WINDOW_MS) {
+      uint32_t windowEndMs = windowStartMs + AWAKE_TIME_WINDOW_MS;
+      if (awake) {
+         windowAwakeMs += windowEndMs - lastUpdateMs;
+      }
+      completeWindow();
+      windowStartMs = windowEndMs;
+      lastUpdateMs  = windowEndMs;
+   }
+
+   if (awake) {
+      windowAwakeMs += nowMs - lastUpdateMs;
+   }
+   lastUpdateMs = nowMs;
+}
+
+void markAwake(uint32_t nowMs) {
+   update(nowMs);
+   if (!awake) {
+      statistics.wakeUps++;
+   }
+   awake = true;
+}
+
+void markAsleep(uint32_t nowMs) {
+   update(nowMs);
+   awake = false;
+}
+
+void recordReconnectLatency(uint32_t latencyMs) {
+   statistics.smoothedReconnectMs = (statistics.reconnects == 0) ? latencyMs : ((3 * statistics.smoothedReconnectMs) + latencyMs) / 4;
+   statistics.lastReconnectMs     = latencyMs;
+   statistics.reconnects++;
+   if (latencyMs > statistics.maxReconnectMs) {
+      statistics.maxReconnectMs = latencyMs;
+   }
+}
+
+const AWAKE_TIME_STATISTICS* getAwakeTimeStatistics(uint32_t nowMs) {
+   update(nowMs);
+   return &statistics;
+}
+
+void resetAwakeTimeStatistics(uint32_t nowMs) {
+   memset(&statistics, 0, sizeof(statistics));
+   awake          = false;
+   windowStartMs  = nowMs;
+   lastUpdateMs   = nowMs;
+   windowAwakeMs  = 0;
+}
\ No newline at end of file
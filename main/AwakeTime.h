@@ -0,0 +1,50 @@
+#ifndef windsensor_awake_time_h
+#define windsensor_awake_time_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AWAKE_TIME_WINDOW_MS           60000
+
+typedef struct {
+   uint32_t lastMinuteAwakeMs;      // awake time in the last complete minute
+   uint32_t maxMinuteAwakeMs;
+   uint32_t completedMinutes;
+   uint32_t totalAwakeMs;           // awake time of all completed minutes
+   uint32_t wakeUps;
+   uint32_t lastReconnectMs;
+   uint32_t smoothedReconnectMs;
+   uint32_t maxReconnectMs;
+   uint32_t reconnects;
+} AWAKE_TIME_STATISTICS;
+
+/**
+ * Marks the radio as awake (it does not use its power save mode). Calling it while the radio is already awake has no
+ * effect.
+ **/
+void markAwake(uint32_t nowMs);
+
+/**
+ * Marks the radio as asleep (it uses its power save mode between the beacons). Calling it while the radio is already 
+ * asleep has no effect.
+ **/
+void markAsleep(uint32_t nowMs);
+
+/**
+ * Records the time it took after a wake up till the connection was usable again. It is 0 if the connection survived
+ * the sleep.
+ **/
+void recordReconnectLatency(uint32_t latencyMs);
+
+/**
+ * Returns the statistics. The awake time gets accounted in windows of one minute and the windows passed till nowMs get
+ * completed before the statistics get returned.
+ **/
+const AWAKE_TIME_STATISTICS* getAwakeTimeStatistics(uint32_t nowMs);
+
+/**
+ * Resets all statistics. The first window starts at nowMs and the radio is asleep.
+ **/
+void resetAwakeTimeStatistics(uint32_t nowMs);
+
+#endif
\ No newline at end of file
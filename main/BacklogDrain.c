@@ -0,0 +1,47 @@
+#include <string.h>
+
+#include "BacklogDrain.h"
+
+static BACKLOG_DRAIN_STATISTICS statistics;
+
+void startBacklogDrain(uint32_t nowMs) {
+   uint32_t drains         = statistics.drains;
+   memset(&statistics, 0, sizeof(statistics));
+   statistics.active       = true;
+   statistics.drains       = drains + 1;
+   statistics.startedAtMs  = nowMs;
+}
+
+bool isBacklogDrainActive() {
+   return statistics.active;
+}
+
+void recordDrainedEnvelope(uint32_t records, uint32_t bytes) {
+   if (!statistics.active) {
+      return;
+   }
+   statistics.envelopes++;
+   statistics.records  += records;
+   statistics.bytes    += bytes;
+}
+
+void stopBacklogDrain(uint32_t nowMs, bool completed) {
+   if (!statistics.active) {
+      return;
+   }
+   statistics.active     = false;
+   statistics.completed  = completed;
+   statistics.durationMs = nowMs - statistics.startedAtMs;
+}
+
+uint32_t getBacklogDrainThroughput(uint32_t nowMs) {
+   uint32_t durationMs = statistics.active ? nowMs - statistics.startedAtMs : statistics.durationMs;
+   if (durationMs == 0) {
+      return 0;
+   }
+   return (uint32_t)(((uint64_t)statistics.records * 1000000) / durationMs);
+}
+
+const BACKLOG_DRAIN_STATISTICS* getBacklogDrainStatistics() {
+   return &statistics;
+}
\ No newline at end of file
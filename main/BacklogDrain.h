@@ -0,0 +1,49 @@
+#ifndef windsensor_backlog_drain_h
+#define windsensor_backlog_drain_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+   bool active;
+   bool completed;
+   uint32_t drains;
+   uint32_t startedAtMs;
+   uint32_t durationMs;
+   uint32_t envelopes;
+   uint32_t records;
+   uint32_t bytes;
+} BACKLOG_DRAIN_STATISTICS;
+
+/**
+ * Starts a drain of the backlog (envelopes sent back to back) and resets the counters of the previous one.
+ **/
+void startBacklogDrain(uint32_t nowMs);
+
+/**
+ * Returns true between startBacklogDrain(...) and stopBacklogDrain(...).
+ **/
+bool isBacklogDrainActive();
+
+/**
+ * Adds a delivered envelope of the drain. 
+ **/
+void recordDrainedEnvelope(uint32_t records, uint32_t bytes);
+
+/**
+ * Ends the drain. completed is true if the whole backlog got delivered and false if an envelope failed.
+ **/
+void stopBacklogDrain(uint32_t nowMs, bool completed);
+
+/**
+ * Returns the delivered records per second of the current or the last drain in thousandths (1500 = 1.5 records/s). 
+ * The duration of an active drain lasts till nowMs.
+ **/
+uint32_t getBacklogDrainThroughput(uint32_t nowMs);
+
+/**
+ * Returns the counters of the current or the last drain.
+ **/
+const BACKLOG_DRAIN_STATISTICS* getBacklogDrainStatistics();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <string.h>
+
+#include "BootTimings.h"
+
+static const char* PHASE_NAMES[BOOT_PHASE_COUNT] = {
+   "samplingStarted",
+   "firstSample",
+   "transportsInitialized",
+   "uplinkReady",
+   "firstPublishment"
+};
+
+static uint32_t phaseMs[BOOT_PHASE_COUNT];
+static bool phaseReached[BOOT_PHASE_COUNT];
+
+void recordBootPhase(BootPhase phase, uint32_t msSinceBoot) {
+   if (phase >= 0 && phase < BOOT_PHASE_COUNT && !phaseReached[phase]) {
+      phaseMs[phase]      = msSinceBoot;
+      phaseReached[phase] = true;
+   }
+}
+
+bool isBootPhaseReached(BootPhase phase) {
+   return phase >= 0 && phase < BOOT_PHASE_COUNT && phaseReached[phase];
+}
+
+uint32_t getBootPhaseMs(BootPhase phase) {
+   return isBootPhaseReached(phase) ? phaseMs[phase] : 0;
+}
+
+const char* getBootPhaseName(BootPhase phase) {
+   return (phase >= 0 && phase < BOOT_PHASE_COUNT) ? PHASE_NAMES[phase] : "unknown";
+}
+
+void resetBootTimings() {
+   memset(phaseMs, 0, sizeof(phaseMs));
+   memset(phaseReached, 0, sizeof(phaseReached));
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef windsensor_boot_timings_h
+#define windsensor_boot_timings_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+   BOOT_PHASE_SAMPLING_STARTED,
+   BOOT_PHASE_FIRST_SAMPLE,
+   BOOT_PHASE_TRANSPORTS_INITIALIZED,
+   BOOT_PHASE_UPLINK_READY,
+   BOOT_PHASE_FIRST_PUBLISHMENT,
+   BOOT_PHASE_COUNT
+} BootPhase;
+
+/**
+ * Records the time (milliseconds since the start of the application) when the phase got reached. Only the first
+ * invocation per phase gets recorded.
+ **/
+void recordBootPhase(BootPhase phase, uint32_t msSinceBoot);
+
+/**
+ * Returns true if the phase got reached.
+ **/
+bool isBootPhaseReached(BootPhase phase);
+
+/**
+ * Returns the time when the phase got reached or 0 if it did not get reached yet.
+ **/
+uint32_t getBootPhaseMs(BootPhase phase);
+
+/**
+ * Returns a human readable name of the phase.
+ **/
+const char* getBootPhaseName(BootPhase phase);
+
+/**
+ * Forgets all recorded phases.
+ **/
+void resetBootTimings();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp32/clk.h"
+#include "esp32/rom/rtc.h"
+#include "soc/rtc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_io_reg.h"
+#include "soc/sens_reg.h"
+#include "driver/adc.h"
+#include "driver/gpio.h"
+#include "driver/rtc_io.h"
+#include "sdkconfig.h"
+
+#include "DeepSleep.h"
+#include "ErrorMessages.h"
+#include "GsmModule.h"
+#include "MessageFormatter.h"
+#include "Telemetry.h"
+
+#define RETAINED_STATE_MAGIC           0x57534431     // "WSD1"
+#define SAMPLE_INTERVAL_US             1000000
+#define MIN_SLEEP_US                   10000
+
+// outputs controlling the pulse counter (74HC590), numbers of the RTC GPIOs (see ulp/ulp_code.S)
+#define COUNTER_RESET_RTC_GPIO         10             // D4
+#define COUNTER_OUTPUT_RTC_GPIO        13             // D15
+#define COUNTER_INPUTS_RTC_GPIO_SHIFT  6              // D25 (LSB), D26, D33, D32, D13, D12, D14, D27 (MSB)
+
+#define DIRECTION_VANE_ADC_CHANNEL     ADC1_CHANNEL_6
+#define XPD_SAR_POWER_DOWN             2
+#define XPD_SAR_POWER_UP               3
+
+typedef struct {
+   uint32_t magic;
+   uint32_t samplesPerPublishment;
+   uint32_t sampleCount;
+   uint16_t anemometerPulses[MAX_RETAINED_SAMPLES];
+   uint16_t directionVaneValues[MAX_RETAINED_SAMPLES];
+   uint64_t sampleIntervalTicks;
+   uint64_t nextSampleAtTicks;
+   uint64_t wokeUpAtTicks;
+   int nextSequenceId;
+   uint32_t nextRecordNumber;
+   uint32_t telemetryEnvelopeCount;
+   time_t timeOfPreviousMessage;
+   char errorMessages[MAX_ERROR_MESSAGES_LENGTH + 1];
+   GSM_MODULE_STATE gsmModule;
+   DEEP_SLEEP_STATISTICS statistics;
+} RETAINED_STATE;
+
+static const char* TAG = "deepSleep";
+
+static RTC_DATA_ATTR RETAINED_STATE retained;
+static bool retainedStateValid     = false;
+static bool bootToSampleRecorded   = false;
+static bool bootToPublishRecorded  = false;
+
+static const gpio_num_t COUNTER_INPUTS[] = { GPIO_NUM_25, GPIO_NUM_26, GPIO_NUM_33, GPIO_NUM_32, GPIO_NUM_13, GPIO_NUM_12, GPIO_NUM_14, GPIO_NUM_27 };
+
+/*
+ * The following functions run in the wake stub. They must not use flash (code, constants or strings) and they can
+ * only access RTC memory.
+ */
+
+static inline void RTC_IRAM_ATTR setRtcOutput(int rtcGpio, bool high) {
+   if (high) {
+      REG_WRITE(RTC_GPIO_OUT_W1TS_REG, BIT(RTC_GPIO_OUT_DATA_W1TS_S + rtcGpio));
+   } else {
+      REG_WRITE(RTC_GPIO_OUT_W1TC_REG, BIT(RTC_GPIO_OUT_DATA_W1TC_S + rtcGpio));
+   }
+}
+
+static inline uint64_t RTC_IRAM_ATTR readRtcTicks() {
+   SET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE_M);
+   while (GET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_VALID_M) == 0) {
+   }
+   SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_TIME_VALID_INT_CLR_M);
+   return READ_PERI_REG(RTC_CNTL_TIME0_REG) | ((uint64_t)READ_PERI_REG(RTC_CNTL_TIME1_REG) << 32);
+}
+
+/*
+ * Same sequence as in ulp/ulp_code.S: latch the counter value, enable the 3-state outputs, read them and reset the 
+ * counter. The outputs keep their levels during deep sleep (hold).
+ */
+static uint16_t RTC_IRAM_ATTR readPulseCounter() {
+   setRtcOutput(COUNTER_OUTPUT_RTC_GPIO, false);
+   CLEAR_PERI_REG_MASK(RTC_IO_TOUCH_PAD3_REG, RTC_IO_TOUCH_PAD3_HOLD_M);
+   setRtcOutput(COUNTER_OUTPUT_RTC_GPIO, true);
+   setRtcOutput(COUNTER_OUTPUT_RTC_GPIO, false);
+
+   uint32_t inputs = READ_PERI_REG(RTC_GPIO_IN_REG) >> (RTC_GPIO_IN_NEXT_S + COUNTER_INPUTS_RTC_GPIO_SHIFT);
+
+   setRtcOutput(COUNTER_OUTPUT_RTC_GPIO, true);
+   SET_PERI_REG_MASK(RTC_IO_TOUCH_PAD3_REG, RTC_IO_TOUCH_PAD3_HOLD_M);
+
+   setRtcOutput(COUNTER_RESET_RTC_GPIO, false);
+   CLEAR_PERI_REG_MASK(RTC_IO_TOUCH_PAD0_REG, RTC_IO_TOUCH_PAD0_HOLD_M);
+   setRtcOutput(COUNTER_RESET_RTC_GPIO, true);
+   SET_PERI_REG_MASK(RTC_IO_TOUCH_PAD0_REG, RTC_IO_TOUCH_PAD0_HOLD_M);
+
+   return (inputs & 0x000f) | ((inputs & 0x0f00) >> 4);
+}
+
+/*
+ * Uses the RTC controller of SAR ADC1. The application configured width and attenuation before the first sleep.
+ */
+static uint16_t RTC_IRAM_ATTR readDirectionVane() {
+   SET_PERI_REG_BITS(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR, XPD_SAR_POWER_UP, SENS_FORCE_XPD_SAR_S);
+   SET_PERI_REG_BITS(SENS_SAR_MEAS_START1_REG, SENS_SAR1_EN_PAD, (1 << DIRECTION_VANE_ADC_CHANNEL), SENS_SAR1_EN_PAD_S);
+   CLEAR_PERI_REG_MASK(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_START_SAR_M);
+   SET_PERI_REG_MASK(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_START_SAR_M);
+   while (GET_PERI_REG_MASK(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_DONE_SAR_M) == 0) {
+   }
+   uint16_t value = GET_PERI_REG_BITS2(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_DATA_SAR, SENS_MEAS1_DATA_SAR_S) & 0xfff;
+   SET_PERI_REG_BITS(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR, XPD_SAR_POWER_DOWN, SENS_FORCE_XPD_SAR_S);
+   return value;
+}
+
+static void RTC_IRAM_ATTR sampleIntoRetainedState() {
+   uint32_t index = retained.sampleCount;
+   if (index < retained.samplesPerPublishment) {
+      retained.anemometerPulses[index]    = readPulseCounter();
+      retained.directionVaneValues[index] = readDirectionVane();
+      retained.sampleCount++;
+   }
+   retained.nextSampleAtTicks += retained.sampleIntervalTicks;
+}
+
+/*
+ * The timer wake up stays enabled from the deep sleep the application started.
+ */
+static void RTC_IRAM_ATTR sleepTillNextSample() {
+   uint64_t nowTicks      = readRtcTicks();
+   uint64_t wakeUpAtTicks = retained.nextSampleAtTicks;
+
+   if ((int64_t)(wakeUpAtTicks - nowTicks) <= 0) {
+      // the stub took too long -> the next sample gets delayed instead of getting skipped
+      wakeUpAtTicks              = nowTicks + (retained.sampleIntervalTicks / 100);
+      retained.nextSampleAtTicks = wakeUpAtTicks;
+   }
+
+   WRITE_PERI_REG(RTC_CNTL_SLP_TIMER0_REG, wakeUpAtTicks & UINT32_MAX);
+   WRITE_PERI_REG(RTC_CNTL_SLP_TIMER1_REG, (wakeUpAtTicks >> 32) & 0xffff);
+   SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_MAIN_TIMER_INT_CLR_M);
+   SET_PERI_REG_MASK(RTC_CNTL_SLP_TIMER1_REG, RTC_CNTL_MAIN_TIMER_ALARM_EN_M);
+
+   REG_WRITE(RTC_ENTRY_ADDR_REG, (uint32_t)&esp_wake_deep_sleep);
+   set_rtc_memory_crc();
+
+   CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+   SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+   while (true) {
+   }
+}
+
+/*
+ * Replaces the default wake stub of ESP-IDF. It takes the sample that caused the wake up and goes back to sleep unless
+ * the samples of a publishment are complete (or there is no valid state) -> only then the application boots.
+ */
+void RTC_IRAM_ATTR esp_wake_deep_sleep(void) {
+   esp_default_wake_deep_sleep();
+   retained.wokeUpAtTicks = readRtcTicks();
+
+   if (retained.magic != RETAINED_STATE_MAGIC || retained.sampleCount >= retained.samplesPerPublishment) {
+      return;
+   }
+
+   sampleIntoRetainedState();
+
+   if (retained.sampleCount >= retained.samplesPerPublishment) {
+      return;
+   }
+
+   retained.statistics.stubWakeUps++;
+   sleepTillNextSample();
+}
+
+/*
+ * The following functions run in the application.
+ */
+
+static uint32_t ticksToMs(uint64_t ticks) {
+   return rtc_time_slowclk_to_us(ticks, esp_clk_slowclk_cal_get()) / 1000;
+}
+
+static uint32_t getMsSinceWakeUp() {
+   return ticksToMs(rtc_time_get() - retained.wokeUpAtTicks);
+}
+
+static void initializeCounterPins() {
+   for (int i = 0; i < sizeof(COUNTER_INPUTS) / sizeof(COUNTER_INPUTS[0]); i++) {
+      rtc_gpio_init(COUNTER_INPUTS[i]);
+      rtc_gpio_set_direction(COUNTER_INPUTS[i], RTC_GPIO_MODE_INPUT_ONLY);
+   }
+
+   rtc_gpio_init(GPIO_NUM_4);
+   rtc_gpio_set_direction(GPIO_NUM_4, RTC_GPIO_MODE_OUTPUT_ONLY);
+   rtc_gpio_init(GPIO_NUM_15);
+   rtc_gpio_set_direction(GPIO_NUM_15, RTC_GPIO_MODE_OUTPUT_ONLY);
+
+   // reset the counter and set its 3-state outputs to high impedance (same as the initialization in ulp/ulp_code.S)
+   rtc_gpio_set_level(GPIO_NUM_4, 0);
+   rtc_gpio_set_level(GPIO_NUM_4, 1);
+   rtc_gpio_hold_en(GPIO_NUM_4);
+   rtc_gpio_set_level(GPIO_NUM_15, 1);
+   rtc_gpio_hold_en(GPIO_NUM_15);
+}
+
+static void initializeAdc() {
+   adc1_config_width(ADC_WIDTH_BIT_12);
+   adc1_config_channel_atten(DIRECTION_VANE_ADC_CHANNEL, ADC_ATTEN_DB_11);
+   // the first conversion of the driver hands ADC1 over to its RTC controller
+   adc1_get_raw(DIRECTION_VANE_ADC_CHANNEL);
+}
+
+bool isDeepSleepEnabled() {
+#ifdef CONFIG_WINDSENSOR_DEEP_SLEEP
+   return true;
+#else
+   return false;
+#endif
+}
+
+bool initializeDeepSleep(uint32_t samplesPerPublishment) {
+   retainedStateValid = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && retained.magic == RETAINED_STATE_MAGIC 
+                        && retained.samplesPerPublishment == samplesPerPublishment;
+
+   initializeAdc();
+
+   if (retainedStateValid) {
+      retained.statistics.fullBoots++;
+   } else {
+      ESP_LOGI(TAG, "no retained state -> initializing pulse counter");
+      memset(&retained, 0, sizeof(retained));
+      retained.magic                 = RETAINED_STATE_MAGIC;
+      retained.samplesPerPublishment = (samplesPerPublishment > MAX_RETAINED_SAMPLES) ? MAX_RETAINED_SAMPLES : samplesPerPublishment;
+      initializeCounterPins();
+   }
+
+   retained.sampleIntervalTicks = rtc_time_us_to_slowclk(SAMPLE_INTERVAL_US, esp_clk_slowclk_cal_get());
+
+   if (!retainedStateValid) {
+      // the application started esp_timer_get_time() microseconds after the reset
+      uint64_t nowTicks          = rtc_time_get();
+      retained.wokeUpAtTicks     = nowTicks - rtc_time_us_to_slowclk(esp_timer_get_time(), esp_clk_slowclk_cal_get());
+      retained.nextSampleAtTicks = nowTicks + retained.sampleIntervalTicks;
+   }
+   
+   return retainedStateValid;
+}
+
+bool restoreRetainedState(uint32_t *nextRecordNumber, time_t *timeOfPreviousMessage) {
+   if (!retainedStateValid) {
+      return false;
+   }
+
+   setNextSequenceId(retained.nextSequenceId);
+   setTelemetryEnvelopeCount(retained.telemetryEnvelopeCount);
+   resumeGsmModule(&retained.gsmModule);
+   clearErrorMessages();
+   if (strlen(retained.errorMessages) > 0) {
+      addErrorMessage(retained.errorMessages);
+   }
+   *nextRecordNumber      = retained.nextRecordNumber;
+   *timeOfPreviousMessage = retained.timeOfPreviousMessage;
+   return true;
+}
+
+uint32_t getMsTillNextSample() {
+   int64_t ticksTillNextSample = retained.nextSampleAtTicks - rtc_time_get();
+   return (ticksTillNextSample > 0) ? ticksToMs(ticksTillNextSample) : 0;
+}
+
+bool takeRetainedSample() {
+   sampleIntoRetainedState();
+
+   if (!bootToSampleRecorded) {
+      DEEP_SLEEP_STATISTICS *statistics = &retained.statistics;
+      statistics->bootToSampleMs        = getMsSinceWakeUp();
+      statistics->maxBootToSampleMs     = (statistics->bootToSampleMs > statistics->maxBootToSampleMs) ? statistics->bootToSampleMs : statistics->maxBootToSampleMs;
+      bootToSampleRecorded              = true;
+   }
+   return retained.sampleCount >= retained.samplesPerPublishment;
+}
+
+uint32_t getRetainedSampleCount() {
+   return retained.sampleCount;
+}
+
+void removeRetainedSamples(uint16_t *anemometerPulses, uint16_t *directionVaneValues) {
+   memcpy(anemometerPulses, retained.anemometerPulses, retained.sampleCount * sizeof(uint16_t));
+   memcpy(directionVaneValues, retained.directionVaneValues, retained.sampleCount * sizeof(uint16_t));
+   retained.sampleCount = 0;
+}
+
+void recordBootToPublish() {
+   if (bootToPublishRecorded) {
+      return;
+   }
+
+   DEEP_SLEEP_STATISTICS *statistics = &retained.statistics;
+   statistics->bootToPublishMs       = getMsSinceWakeUp();
+   statistics->maxBootToPublishMs    = (statistics->bootToPublishMs > statistics->maxBootToPublishMs) ? statistics->bootToPublishMs : statistics->maxBootToPublishMs;
+   statistics->modemBringUpMs        = getGsmModuleBringUpMs();
+   statistics->maxModemBringUpMs     = (statistics->modemBringUpMs > statistics->maxModemBringUpMs) ? statistics->modemBringUpMs : statistics->maxModemBringUpMs;
+   bootToPublishRecorded             = true;
+
+   ESP_LOGI(TAG, "boot to sample %u ms (max %u ms), boot to publish %u ms (max %u ms) including the modem bring up %u ms (max %u ms), %u full boots, %u wake ups handled by the stub",
+      statistics->bootToSampleMs, statistics->maxBootToSampleMs, statistics->bootToPublishMs, statistics->maxBootToPublishMs,
+      statistics->modemBringUpMs, statistics->maxModemBringUpMs, statistics->fullBoots, statistics->stubWakeUps);
+}
+
+void enterDeepSleep(uint32_t nextRecordNumber, time_t timeOfPreviousMessage) {
+   retained.nextSequenceId          = peekNextSequenceId();
+   retained.telemetryEnvelopeCount  = getTelemetryEnvelopeCount();
+   retained.nextRecordNumber        = nextRecordNumber;
+   retained.timeOfPreviousMessage   = timeOfPreviousMessage;
+   retained.gsmModule               = suspendGsmModule();
+   strncpy(retained.errorMessages, getErrorMessages(), MAX_ERROR_MESSAGES_LENGTH);
+   retained.errorMessages[MAX_ERROR_MESSAGES_LENGTH] = 0;
+
+   uint64_t sleepUs = getMsTillNextSample() * 1000ULL;
+   sleepUs          = (sleepUs < MIN_SLEEP_US) ? MIN_SLEEP_US : sleepUs;
+
+   ESP_LOGI(TAG, "entering deep sleep with %u of %u samples", retained.sampleCount, retained.samplesPerPublishment);
+
+   // the RTC peripherals keep the configuration of the counter pins and the ADC
+   esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+   esp_sleep_enable_timer_wakeup(sleepUs);
+   esp_deep_sleep_start();
+}
+
+const DEEP_SLEEP_STATISTICS* getDeepSleepStatistics() {
+   return &retained.statistics;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef windsensor_deep_sleep_h
+#define windsensor_deep_sleep_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define MAX_RETAINED_SAMPLES           60
+
+typedef struct {
+   uint32_t bootToSampleMs;         // wake up till the first sample taken by the application
+   uint32_t maxBootToSampleMs;
+   uint32_t bootToPublishMs;        // wake up till the first publishment finished
+   uint32_t maxBootToPublishMs;
+   uint32_t modemBringUpMs;         // part of bootToPublishMs the GSM module needed to wake up or to power on and register
+   uint32_t maxModemBringUpMs;
+   uint32_t stubWakeUps;            // wake ups handled by the wake stub only
+   uint32_t fullBoots;
+} DEEP_SLEEP_STATISTICS;
+
+/**
+ * Returns true if the sensor sleeps between the publishments (see Kconfig).
+ **/
+bool isDeepSleepEnabled();
+
+/**
+ * Configures the pins of the pulse counter and the ADC for the sampling in the wake stub. Returns true if the sensor 
+ * woke up from deep sleep and the retained state is valid.
+ **/
+bool initializeDeepSleep(uint32_t samplesPerPublishment);
+
+/**
+ * Restores the sequence ID, the error messages and the state of the GSM module and provides the retained record number
+ * and time of the previous message. Returns false (and does not touch the provided values) if there is no retained 
+ * state.
+ **/
+bool restoreRetainedState(uint32_t *nextRecordNumber, time_t *timeOfPreviousMessage);
+
+/**
+ * Returns the milliseconds till the next sample is due.
+ **/
+uint32_t getMsTillNextSample();
+
+/**
+ * Takes a sample (pulse counter and direction vane) and stores it in RTC memory. Returns true if the samples of a 
+ * publishment are complete. The task calling it has to run on the PRO CPU.
+ **/
+bool takeRetainedSample();
+
+/**
+ * Returns the number of samples taken since the last invocation of removeRetainedSamples(...).
+ **/
+uint32_t getRetainedSampleCount();
+
+/**
+ * Copies the samples into the provided arrays (they need space for samplesPerPublishment values) and removes them.
+ **/
+void removeRetainedSamples(uint16_t *anemometerPulses, uint16_t *directionVaneValues);
+
+/**
+ * Records the time since the wake up when the first publishment finished.
+ **/
+void recordBootToPublish();
+
+/**
+ * Stores the state that needs to survive the deep sleep, puts the GSM module into its low power mode (see 
+ * suspendGsmModule() in GsmModule.h), enters deep sleep and wakes up when the next sample is due.
+ * The wake stub takes the samples and the sensor boots only when the samples of a publishment are complete.
+ **/
+void enterDeepSleep(uint32_t nextRecordNumber, time_t timeOfPreviousMessage);
+
+/**
+ * Returns the statistics of the boots.
+ **/
+const DEEP_SLEEP_STATISTICS* getDeepSleepStatistics();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include "DeferredLog.h"
+#include "LogRing.h"
+
+#define LOG_TASK_STACK_SIZE      3072
+#define LOG_TASK_PRIORITY        1
+#define LOG_TASK_PERIOD_MS       100
+#define MESSAGE_LENGTH           128
+
+static const char* TAG = "log";
+
+static void printRecord(const LOG_RECORD *record) {
+   char message[MESSAGE_LENGTH];
+   formatLogRecord(record, message, MESSAGE_LENGTH);
+   const char *tag = getLogTagName(getLogFormatTag(record->format));
+
+   // the time in brackets is the time of the recording, the time printed by ESP_LOG the one of the output
+   switch (getLogFormatLevel(record->format)) {
+      case LOG_LEVEL_ERROR:   ESP_LOGE(tag, "[%u ms] %s", record->timestampUs / 1000, message); break;
+      case LOG_LEVEL_WARN:    ESP_LOGW(tag, "[%u ms] %s", record->timestampUs / 1000, message); break;
+      case LOG_LEVEL_INFO:    ESP_LOGI(tag, "[%u ms] %s", record->timestampUs / 1000, message); break;
+      default:                ESP_LOGD(tag, "[%u ms] %s", record->timestampUs / 1000, message); break;
+   }
+}
+
+#ifdef CONFIG_WINDSENSOR_DEFERRED_LOG
+static void deferredLogTask(void* arg) {
+   LOG_RECORD record;
+   uint32_t reportedDropCount = 0;
+
+   for(;;) {
+      while (takeLogRecord(&record)) {
+         printRecord(&record);
+      }
+
+      uint32_t dropCount = getDroppedLogRecordCount();
+      if (dropCount != reportedDropCount) {
+         ESP_LOGW(TAG, "%u log record(s) dropped because the ring was full", dropCount - reportedDropCount);
+         reportedDropCount = dropCount;
+      }
+      vTaskDelay(LOG_TASK_PERIOD_MS / portTICK_PERIOD_MS);
+   }
+}
+#endif
+
+void startDeferredLogTask() {
+   resetLogRing();
+#ifdef CONFIG_WINDSENSOR_DEFERRED_LOG
+   xTaskCreate(deferredLogTask, "deferredLogTask", LOG_TASK_STACK_SIZE, NULL, LOG_TASK_PRIORITY, NULL);
+#endif
+}
+
+void logDeferred(LogFormat format, const char *text, int32_t arg0, int32_t arg1, int32_t arg2) {
+   uint32_t nowUs = esp_timer_get_time();
+#ifdef CONFIG_WINDSENSOR_DEFERRED_LOG
+   appendLogRecord(nowUs, format, text, arg0, arg1, arg2);
+#else
+   if (isLogFormatEnabled(format)) {
+      LOG_RECORD record = { .timestampUs = nowUs, .format = format, .args = { arg0, arg1, arg2 } };
+      snprintf(record.text, LOG_RECORD_TEXT_LENGTH, "%s", (text == NULL) ? "" : text);
+      printRecord(&record);
+   }
+#endif
+}
+
+void setDeferredLogLevel(LogTag tag, LogLevel level) {
+   setLogLevel(tag, level);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef windsensor_deferred_log_h
+#define windsensor_deferred_log_h
+
+#include <stdint.h>
+
+#include "LogRing.h"
+
+/**
+ * Initializes the ring and starts the low priority task that formats and prints the records. Call it before any other
+ * task gets started.
+ **/
+void startDeferredLogTask();
+
+/**
+ * Records the message without formatting it (see LogRing.h for the placeholders). Without CONFIG_WINDSENSOR_DEFERRED_LOG
+ * the message gets formatted and printed immediately.
+ **/
+void logDeferred(LogFormat format, const char *text, int32_t arg0, int32_t arg1, int32_t arg2);
+
+/**
+ * Changes the level of a tag at runtime.
+ **/
+void setDeferredLogLevel(LogTag tag, LogLevel level);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include <string.h>
+
+#include "DutyCycle.h"
+
+static const char* STATE_NAMES[DUTY_STATE_COUNT] = {
+   "idle",
+   "sampling",
+   "uplink"
+};
+
+static DUTY_CYCLE_REPORT report;
+static uint32_t activeCounts[DUTY_STATE_COUNT];
+static uint32_t lastUpdateMs = 0;
+
+static DutyState getCurrentState() {
+   for (int state = DUTY_STATE_COUNT - 1; state > DUTY_STATE_IDLE; state--) {
+      if (activeCounts[state] > 0) {
+         return state;
+      }
+   }
+   return DUTY_STATE_IDLE;
+}
+
+static void update(uint32_t nowMs) {
+   uint32_t elapsedMs                     = nowMs - lastUpdateMs;
+   report.durationMs[getCurrentState()]  += elapsedMs;
+   report.totalMs                        += elapsedMs;
+   lastUpdateMs                           = nowMs;
+}
+
+void enterDutyState(DutyState state, uint32_t nowMs) {
+   update(nowMs);
+   if (state > DUTY_STATE_IDLE && state < DUTY_STATE_COUNT) {
+      activeCounts[state]++;
+   }
+}
+
+void leaveDutyState(DutyState state, uint32_t nowMs) {
+   update(nowMs);
+   if (state > DUTY_STATE_IDLE && state < DUTY_STATE_COUNT && activeCounts[state] > 0) {
+      activeCounts[state]--;
+   }
+}
+
+const DUTY_CYCLE_REPORT* getDutyCycleReport(uint32_t nowMs) {
+   update(nowMs);
+   return &report;
+}
+
+uint32_t getDutyStatePerMille(DutyState state, uint32_t nowMs) {
+   update(nowMs);
+   return (report.totalMs == 0) ? 0 : (uint32_t)(((uint64_t)report.durationMs[state] * 1000) / report.totalMs);
+}
+
+const char* getDutyStateName(DutyState state) {
+   return (state >= 0 && state < DUTY_STATE_COUNT) ? STATE_NAMES[state] : "unknown";
+}
+
+void resetDutyCycle(uint32_t nowMs) {
+   memset(&report, 0, sizeof(report));
+   lastUpdateMs = nowMs;
+}
\ No newline at end of file
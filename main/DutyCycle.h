@@ -0,0 +1,53 @@
+#ifndef windsensor_duty_cycle_h
+#define windsensor_duty_cycle_h
+
+#include <stdint.h>
+
+/**
+ * The states are ordered by priority. If the states of several tasks overlap, the time gets accounted to the state 
+ * with the highest priority.
+ **/
+typedef enum {
+   DUTY_STATE_IDLE,
+   DUTY_STATE_SAMPLING,
+   DUTY_STATE_UPLINK,
+   DUTY_STATE_COUNT
+} DutyState;
+
+typedef struct {
+   uint32_t durationMs[DUTY_STATE_COUNT];
+   uint32_t totalMs;
+} DUTY_CYCLE_REPORT;
+
+/**
+ * Enters the provided state. The state stays active till leaveDutyState(...) got called as often as 
+ * enterDutyState(...). Entering DUTY_STATE_IDLE has no effect.
+ **/
+void enterDutyState(DutyState state, uint32_t nowMs);
+
+/**
+ * Leaves the provided state.
+ **/
+void leaveDutyState(DutyState state, uint32_t nowMs);
+
+/**
+ * Returns the durations of the states since the last reset.
+ **/
+const DUTY_CYCLE_REPORT* getDutyCycleReport(uint32_t nowMs);
+
+/**
+ * Returns the share of the provided state in per mille (0 if no time passed since the last reset).
+ **/
+uint32_t getDutyStatePerMille(DutyState state, uint32_t nowMs);
+
+/**
+ * Returns a human readable name of the state.
+ **/
+const char* getDutyStateName(DutyState state);
+
+/**
+ * Resets the durations but keeps the active states. The next report starts at nowMs.
+ **/
+void resetDutyCycle(uint32_t nowMs);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "EnvelopePacker.h"
+#include "MessageFormatter.h"
+
+size_t getEnvelopeByteBudget(size_t maxDataLength, size_t largestFreeBlock, size_t arenaSize, size_t arenaUsedBytes) {
+   size_t memoryBudget = (largestFreeBlock > ENVELOPE_MEMORY_RESERVE_BYTES) ? (largestFreeBlock - ENVELOPE_MEMORY_RESERVE_BYTES) / ENVELOPE_MEMORY_FACTOR : 0;
+   size_t arenaFree    = (arenaSize > arenaUsedBytes) ? arenaSize - arenaUsedBytes : 0;
+   size_t arenaBudget  = (arenaFree > ENVELOPE_ARENA_RESERVE_BYTES) ? (arenaFree - ENVELOPE_ARENA_RESERVE_BYTES) / ENVELOPE_ARENA_FACTOR : 0;
+   size_t budget       = (arenaSize > 0 && arenaBudget < memoryBudget) ? arenaBudget : memoryBudget;
+   return (maxDataLength > 0 && maxDataLength < budget) ? maxDataLength : budget;
+}
+
+static size_t getEnvelopeLength(const PENDING_MESSAGES *pendingMessages, int first, int count, time_t now) {
+   uint32_t secondsSinceLastMessage = now - pendingMessages->recordedAt[first + count - 1];
+   return getJsonEnvelopeLength(pendingMessages, first, count, secondsSinceLastMessage);
+}
+
+MESSAGE_RANGE packEnvelope(const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE candidates, size_t budgetInBytes, time_t now) {
+   MESSAGE_RANGE range = { candidates.first, 0 };
+   int fittingCount    = 0;
+   int tooManyCount    = candidates.count + 1;
+
+   if (candidates.first < 0 || candidates.count <= 0 || candidates.first + candidates.count > pendingMessages->count) {
+      return range;
+   }
+
+   // each message makes the envelope longer, therefore the count that fits can get searched by bisection
+   while (tooManyCount - fittingCount > 1) {
+      int count = fittingCount + (tooManyCount - fittingCount) / 2;
+      if (getEnvelopeLength(pendingMessages, candidates.first, count, now) <= budgetInBytes) {
+         fittingCount = count;
+      } else {
+         tooManyCount = count;
+      }
+   }
+
+   range.count = fittingCount;
+   return range;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef windsensor_envelope_packer_h
+#define windsensor_envelope_packer_h
+
+#include <stddef.h>
+#include <time.h>
+
+#include "Messages.h"
+#include "PublishPolicy.h"
+
+#define ENVELOPE_MEMORY_FACTOR         2        // the envelope and its messages (or the HTTP request) exist at the same time
+#define ENVELOPE_MEMORY_RESERVE_BYTES  8192     // stays free for the other tasks and the request headers
+#define ENVELOPE_ARENA_FACTOR          3        // the arena keeps the released messages when the HTTP request gets allocated
+#define ENVELOPE_ARENA_RESERVE_BYTES   1024     // errors, request headers and the AT commands of an attempt
+
+/**
+ * Returns the maximum length of an envelope in bytes. It fits into the data of a request (maxDataLength, 0 if there is 
+ * no limit, see getMaxTransportDataLength() in Transport.h) and building and sending it needs at most 
+ * ENVELOPE_MEMORY_FACTOR times its length out of the largest free block of the heap without touching the reserve. 
+ * If there is an arena (arenaSize greater than 0, see Memory.h), the buffers of building the envelope and of its 
+ * request (ENVELOPE_ARENA_FACTOR times its length) also fit into the part of the arena that is still free 
+ * (arenaUsedBytes got taken since its last reset, e.g. by the preparation of the connection) without touching the 
+ * reserve. AT commands beyond the reserve (e.g. of many retries) overflow to the heap.
+ **/
+size_t getEnvelopeByteBudget(size_t maxDataLength, size_t largestFreeBlock, size_t arenaSize, size_t arenaUsedBytes);
+
+/**
+ * Returns the longest run of messages at the start of the candidates whose envelope (see getJsonEnvelopeLength(...) 
+ * in MessageFormatter.h) is not longer than budgetInBytes. The age of the last message gets calculated with now. The 
+ * remaining candidates need to get sent in further envelopes. The count is 0 if not even the first candidate fits.
+ **/
+MESSAGE_RANGE packEnvelope(const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE candidates, size_t budgetInBytes, time_t now);
+
+#endif
\ No newline at end of file
@@ -1,12 +1,24 @@
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
+#include "driver/rtc_io.h"
 #include "driver/uart.h"
+#include "sdkconfig.h"
 
+#include "AtTrace.h"
+#include "DeferredLog.h"
 #include "ErrorMessages.h"
 #include "GsmModule.h"
+#include "Http.h"
+#include "Memory.h"
+#include "NonVolatileStorage.h"
+#include "PhaseTimings.h"
+#include "RetryPolicy.h"
+#include "SignalQuality.h"
 #include "Utils.h"
 
 #define UART_PORT                                     UART_NUM_2
@@ -30,8 +42,33 @@
 #define MAX_INPUT_TIME_MS                             3000
 #define HTTP_RESPONSE_OK                              200
 #define HTTP_RESPONSE_ERROR                           0
-#define FAILED_SEND_ATTEMPTS_TO_RESTART_GSM_MODULE    4
 #define ONE_DAY_IN_SECONDS                            (24 * 60 * 60)
+#define MAX_CIPSEND_CHUNK_SIZE                        1460
+#define MAX_HTTP_DATA_LENGTH                          319488   // maximum size of AT+HTTPDATA
+#define PROMPT_CHAR                                   '>'
+#define GSM_MODULE_BAUDRATE                           19200
+#define BAUDRATE_CONFIGURED_KEY                       "gsmBaudrate"
+
+#ifdef CONFIG_WINDSENSOR_GSM_TCP_TRANSPORT
+#define USE_TCP_TRANSPORT                             true
+#define TCP_KEEP_ALIVE_SECONDS                        CONFIG_WINDSENSOR_GSM_TCP_KEEP_ALIVE_SECONDS
+#define MAX_DATA_LENGTH                               0        // AT+CIPSEND gets used in chunks
+#else
+#define USE_TCP_TRANSPORT                             false
+#define TCP_KEEP_ALIVE_SECONDS                        0
+#define MAX_DATA_LENGTH                               MAX_HTTP_DATA_LENGTH
+#endif
+
+#if defined(CONFIG_WINDSENSOR_GSM_IDLE_MODE_SLEEP)
+#define IDLE_MODE                                     IDLE_MODE_SLEEP
+#elif defined(CONFIG_WINDSENSOR_GSM_IDLE_MODE_MINIMUM_FUNCTIONALITY)
+#define IDLE_MODE                                     IDLE_MODE_MINIMUM_FUNCTIONALITY
+#elif defined(CONFIG_WINDSENSOR_DEEP_SLEEP)
+// an active module would draw its full current during the whole deep sleep
+#define IDLE_MODE                                     IDLE_MODE_SLEEP
+#else
+#define IDLE_MODE                                     IDLE_MODE_ACTIVE
+#endif
 
 typedef struct {
    int count;
@@ -45,15 +82,38 @@ typedef enum stat {
    GSM_NOTHING_RECEIVED
 } GsmStatus;
 
+typedef enum {
+   IDLE_MODE_ACTIVE,
+   IDLE_MODE_SLEEP,
+   IDLE_MODE_MINIMUM_FUNCTIONALITY
+} IdleMode;
+
 static char responseBuffer[RESPONSE_BUFFER_SIZE];
+static char responseBody[MAX_RESPONSE_BODY_LENGTH + NULL_BYTE_LENGTH];
 static bool uartAndGpioInitialized = false;
 static bool baudrateConfigured     = false;
 static bool gsmModuleReady         = false;
-static int failedSendAttempts      = 0;
+static FailureClass failureClass   = FAILURE_NONE;
 static time_t moduleReadyTime      = 0;
+static bool tcpConnectionOpen      = false;
+static time_t tcpConnectionUsedAt  = 0;
+static bool gsmModuleIdle          = false;
+static bool bearerOpen             = false;
+static bool httpServiceInitialized = false;
+static uint32_t sendStartedAt      = 0;
+static uint32_t timeToRequestMs    = 0;
+static uint32_t bringUpMs          = 0;
+static bool deadlineActive         = false;
+static TickType_t deadline         = 0;
 
 static const char* GSM_MODULE_TAG = "GSM-module";
 
+#ifdef CONFIG_WINDSENSOR_AT_TRACE
+static AT_TRACE_RECORD atTraceRecords[CONFIG_WINDSENSOR_AT_TRACE_CAPACITY];
+static AT_TRACE atTrace            = { atTraceRecords, CONFIG_WINDSENSOR_AT_TRACE_CAPACITY, 0, 0, 0 };
+static portMUX_TYPE atTraceMux     = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
 static const AT_COMMANDS initBearerCommands = { 3, (const char*[]) {       
    "AT+SAPBR=3,1,\"Contype\", \"GPRS\"",
    "AT+SAPBR=3,1,\"APN\",\"CMNET\"",
@@ -69,10 +129,45 @@ const AT_COMMANDS terminateHttpCommands = { 1, (const char*[]) {"AT+HTTPTERM"}};
 
 const AT_COMMANDS terminateBearerCommands = { 1, (const char*[]) {"AT+SAPBR=0,1"}};
 
+static const AT_COMMANDS initTcpCommands = { 2, (const char*[]) {
+   "AT+CIPMUX=0",
+   "AT+CSTT=\"CMNET\""
+   }};
+
 static void sleep(TickType_t durationInMs) {
    vTaskDelay( durationInMs / portTICK_PERIOD_MS);
 }
 
+static uint32_t millis() {
+   // same clock as the uplink task uses for the phase timings
+   return esp_timer_get_time() / 1000;
+}
+
+static void traceAt(AtTraceKind kind, const char *text, uint32_t timeoutMs) {
+#ifdef CONFIG_WINDSENSOR_AT_TRACE
+   uint32_t timestampUs = (uint32_t)esp_timer_get_time();
+   portENTER_CRITICAL(&atTraceMux);
+   recordAtTrace(&atTrace, timestampUs, kind, text, timeoutMs);
+   portEXIT_CRITICAL(&atTraceMux);
+#endif
+}
+
+static bool deadlinePassed() {
+   return deadlineActive && (int32_t)(deadline - xTaskGetTickCount()) <= 0;
+}
+
+/*
+ * Shortens the provided timeout to the time left till the deadline (if one is set).
+ */
+static TickType_t limitToDeadline(TickType_t timeoutInMs) {
+   if (!deadlineActive) {
+      return timeoutInMs;
+   }
+   int32_t ticksLeft = (int32_t)(deadline - xTaskGetTickCount());
+   TickType_t millisLeft = (ticksLeft > 0) ? ticksLeft * portTICK_PERIOD_MS : 0;
+   return (millisLeft < timeoutInMs) ? millisLeft : timeoutInMs;
+}
+
 static void initUart() {
    ESP_LOGI(GSM_MODULE_TAG, "initializing UART %d ...", UART_PORT);
    uart_config_t uart_config = {
@@ -94,12 +189,12 @@ static void initUart() {
 
 static void sendCommand(const char* message) {
    int messageLength = strlen(message);
-   ESP_LOGI(GSM_MODULE_TAG, "out: \"%s\"", message);
-   char *messageWithCr = malloc(messageLength + 1);
-   strcpy(messageWithCr, message); 
-   messageWithCr[messageLength] = CR;
-   uart_write_bytes(UART_PORT, messageWithCr, messageLength + 1);
-   free(messageWithCr);
+   const char carriageReturn = CR;
+   logDeferred(LOG_FORMAT_AT_COMMAND, message, 0, 0, 0);
+   traceAt(AT_TRACE_COMMAND, message, 0);
+   // writing the CR separately avoids copying the message (it can be a whole envelope)
+   uart_write_bytes(UART_PORT, message, messageLength);
+   uart_write_bytes(UART_PORT, &carriageReturn, 1);
 }
 
 static bool readNextByte(uint8_t *data, TickType_t timeoutInMs) {
@@ -113,6 +208,7 @@ static bool responseBufferFull() {
 }
 
 static GsmStatus readNextLine(char *outputBuffer, int outputBufferSize, TickType_t timeoutInMs) {
+   timeoutInMs = limitToDeadline(timeoutInMs);
    uint8_t nextByte;
    int responseBufferIndex       = strlen(responseBuffer);
    bool lineCopiedToOutputBuffer = false;
@@ -201,6 +297,7 @@ static int countExpectedResponses(const char *expectedResponses) {
  * timeoutInMs           timeout in milliseconds
  */
 static GsmStatus assertResponse(const char *expectedResponses, TickType_t timeoutInMs) {
+   timeoutInMs = limitToDeadline(timeoutInMs);
    char buffer[RESPONSE_BUFFER_SIZE];
    TickType_t ticksAtStart       = xTaskGetTickCount();
    TickType_t passedMilliseconds = 0;
@@ -208,8 +305,8 @@ static GsmStatus assertResponse(const char *expectedResponses, TickType_t timeou
    bool expectedResponseReceived = false;
    bool atLeastOneLineReceived   = false;
    int responseCount             = countExpectedResponses(expectedResponses);
-   char **allowedResponses       = malloc(responseCount * sizeof(char*));
-   char *copyOfExpectedResponses = malloc((responseCount > 0 ? strlen(expectedResponses) : 0) + NULL_BYTE_LENGTH);
+   char **allowedResponses       = allocate(responseCount * sizeof(char*), ALLOCATION_TAG_AT_COMMAND);
+   char *copyOfExpectedResponses = allocate((responseCount > 0 ? strlen(expectedResponses) : 0) + NULL_BYTE_LENGTH, ALLOCATION_TAG_AT_COMMAND);
          
    if (responseCount > 0) {
       strcpy(copyOfExpectedResponses, expectedResponses);
@@ -222,7 +319,7 @@ static GsmStatus assertResponse(const char *expectedResponses, TickType_t timeou
 
    while (!timedOut && !expectedResponseReceived) {
       if (readNextLine(buffer, RESPONSE_BUFFER_SIZE, timeoutInMs - passedMilliseconds) == GSM_OK && strlen(buffer) > 0) {
-         ESP_LOGI(GSM_MODULE_TAG, "in:  \"%s\"", buffer);
+         logDeferred(LOG_FORMAT_AT_RESPONSE, buffer, 0, 0, 0);
          atLeastOneLineReceived = true;
          for (int i = 0; i < responseCount && !expectedResponseReceived; i++) {
                expectedResponseReceived = strcmp(buffer, allowedResponses[i]) == 0;
@@ -238,13 +335,40 @@ static GsmStatus assertResponse(const char *expectedResponses, TickType_t timeou
    if (atLeastOneLineReceived) {
       status = expectedResponseReceived ? GSM_OK : GSM_TIMEOUT;
    }
+   traceAt(expectedResponseReceived ? AT_TRACE_RESPONSE : AT_TRACE_TIMEOUT, expectedResponses, timeoutInMs);
 
-   free(allowedResponses);
-   free(copyOfExpectedResponses);
+   release(allowedResponses);
+   release(copyOfExpectedResponses);
 
    return status;
 }
 
+/*
+ * Waits for a line starting with the provided prefix (e.g. "+CSQ:") and copies it to outputBuffer. Returns the same 
+ * status values as assertResponse(...).
+ */
+static GsmStatus assertResponseStartingWith(const char *prefix, char *outputBuffer, int outputBufferSize, TickType_t timeoutInMs) {
+   timeoutInMs = limitToDeadline(timeoutInMs);
+   TickType_t ticksAtStart       = xTaskGetTickCount();
+   TickType_t passedMilliseconds = 0;
+   bool atLeastOneLineReceived   = false;
+
+   while (passedMilliseconds < timeoutInMs) {
+      if (readNextLine(outputBuffer, outputBufferSize, timeoutInMs - passedMilliseconds) == GSM_OK && strlen(outputBuffer) > 0) {
+         logDeferred(LOG_FORMAT_AT_RESPONSE, outputBuffer, 0, 0, 0);
+         atLeastOneLineReceived = true;
+         if (strncmp(outputBuffer, prefix, strlen(prefix)) == 0) {
+            traceAt(AT_TRACE_RESPONSE, prefix, timeoutInMs);
+            return GSM_OK;
+         }
+      }
+      passedMilliseconds = (xTaskGetTickCount() - ticksAtStart) * portTICK_PERIOD_MS;
+   }
+
+   traceAt(AT_TRACE_TIMEOUT, prefix, timeoutInMs);
+   return atLeastOneLineReceived ? GSM_TIMEOUT : GSM_NOTHING_RECEIVED;
+}
+
 static GsmStatus assertOkResponse() {
    return assertResponse("OK", SECONDS(5));
 }
@@ -258,7 +382,7 @@ static void logRedirectionLocation(int statusCode) {
       char buffer[RESPONSE_BUFFER_SIZE];
       bool timedOut                 = false;
       bool okReceived               = false;
-      TickType_t timeoutInMs        = SECONDS(10);
+      TickType_t timeoutInMs        = limitToDeadline(SECONDS(10));
       TickType_t ticksAtStart       = xTaskGetTickCount();
       TickType_t passedMilliseconds = 0;
       
@@ -266,7 +390,7 @@ static void logRedirectionLocation(int statusCode) {
       
       while (!timedOut && !okReceived) {
          if ((readNextLine(buffer, RESPONSE_BUFFER_SIZE, timeoutInMs - passedMilliseconds) == GSM_OK) && (strlen(buffer) > 0)) {
-            ESP_LOGI(GSM_MODULE_TAG, "in:  \"%s\"", buffer);
+            logDeferred(LOG_FORMAT_AT_RESPONSE, buffer, 0, 0, 0);
             okReceived = (strstr(buffer, "OK") == buffer);
             if ((strstr(buffer, "location") != NULL) || (strstr(buffer, "Location") != NULL)) {
                char *start = buffer;
@@ -293,20 +417,21 @@ static void logRedirectionLocation(int statusCode) {
 
 
 /**
- * Returns the HTTP status code or -1 if no response received.
+ * Returns the HTTP status code or -1 if no response received. The length of the response body gets stored in 
+ * dataLength (0 if unknown).
  */
-static int waitForHttpStatusCode() {
+static int waitForHttpStatusCode(int *dataLength) {
    char buffer[RESPONSE_BUFFER_SIZE];
    int statusCode                = -1;
    bool timedOut                 = false;
    bool statusCodeReceived       = false;
-   TickType_t timeoutInMs        = SECONDS(10);
+   TickType_t timeoutInMs        = limitToDeadline(SECONDS(10));
    TickType_t ticksAtStart       = xTaskGetTickCount();
    TickType_t passedMilliseconds = 0;
    
    while (!timedOut && !statusCodeReceived) {
       if ((readNextLine(buffer, RESPONSE_BUFFER_SIZE, timeoutInMs - passedMilliseconds) == GSM_OK) && (strlen(buffer) > 0)) {
-         ESP_LOGI(GSM_MODULE_TAG, "in:  \"%s\"", buffer);
+         logDeferred(LOG_FORMAT_AT_RESPONSE, buffer, 0, 0, 0);
       
          if (strstr(buffer, "+HTTPACTION:") == buffer) {
             const char* separators[3] = {":", ",", ","};
@@ -324,6 +449,8 @@ static int waitForHttpStatusCode() {
             if (token != NULL) {
                statusCode         = atoi(token);
                statusCodeReceived = true;
+               token              = strtok(NULL, ",");
+               *dataLength        = (token == NULL) ? 0 : atoi(token);
                ESP_LOGI(GSM_MODULE_TAG, "status code: %d", statusCode);
                logRedirectionLocation(statusCode);
             }       
@@ -333,6 +460,7 @@ static int waitForHttpStatusCode() {
       passedMilliseconds = (xTaskGetTickCount() - ticksAtStart) * portTICK_PERIOD_MS;
       timedOut = passedMilliseconds >= timeoutInMs;
    }
+   traceAt(statusCodeReceived ? AT_TRACE_RESPONSE : AT_TRACE_TIMEOUT, "+HTTPACTION:", timeoutInMs);
 
    return statusCode;
 }
@@ -354,6 +482,8 @@ static bool executeCommands(const AT_COMMANDS *commands) {
 }
 
 static void initPwrKeyPin() {
+   // the pin was held low during the deep sleep (see suspendGsmModule())
+   rtc_gpio_hold_dis(IO_PIN_FOR_PWRKEY);
    gpio_config_t pinConfig;
    pinConfig.intr_type    = GPIO_INTR_DISABLE;
    pinConfig.mode         = GPIO_MODE_OUTPUT;
@@ -427,8 +557,9 @@ static bool waitForGsmModuleToGetAvailable() {
 }
 
 static bool waitForNetworkRegistration() {
+   char buffer[RESPONSE_BUFFER_SIZE];
    bool timedOut               = false;
-   TickType_t timeoutInMs      = SECONDS(20);
+   TickType_t timeoutInMs      = limitToDeadline(SECONDS(20));
    TickType_t passedMillis     = 0;
    TickType_t ticksAtStart     = xTaskGetTickCount();
    int nothingReceivedCount    = 0;
@@ -439,9 +570,14 @@ static bool waitForNetworkRegistration() {
 
    while(!timedOut && !registeredSuccessfully && nothingReceivedCount < maxNothingReceivedCount) {
       sendCommand("AT+CREG?");
-      GsmStatus status = assertResponse("+CREG: 0,1|+CREG: 0,5", min(SECONDS(1), timeoutInMs - passedMillis));
+      GsmStatus status = assertResponseStartingWith("+CREG:", buffer, RESPONSE_BUFFER_SIZE, min(SECONDS(1), timeoutInMs - passedMillis));
       if (status == GSM_OK) {
-            status = assertOkResponse();
+         int registrationStatus = parseRegistrationStatus(buffer);
+         recordRegistrationStatus(registrationStatus, time(NULL));
+         status = assertOkResponse();
+         if (status == GSM_OK && registrationStatus != REGISTRATION_HOME && registrationStatus != REGISTRATION_ROAMING) {
+            status = GSM_TIMEOUT;
+         }
       }
       registeredSuccessfully = (status == GSM_OK);
       nothingReceivedCount   = (status == GSM_NOTHING_RECEIVED) ? nothingReceivedCount + 1 : 0;
@@ -462,6 +598,20 @@ static bool waitForNetworkRegistration() {
    return registeredSuccessfully;
 }
 
+static void sampleSignalQuality() {
+   char buffer[RESPONSE_BUFFER_SIZE];
+
+   sendCommand("AT+CSQ");
+   if (assertResponseStartingWith("+CSQ:", buffer, RESPONSE_BUFFER_SIZE, SECONDS(1)) == GSM_OK) {
+      int rssi = parseSignalQuality(buffer);
+      if (rssi >= 0) {
+         recordSignalQuality(rssi, time(NULL));
+         ESP_LOGI(GSM_MODULE_TAG, "signal quality: rssi = %d (smoothed: %d)", rssi, getSmoothedRssi());
+      }
+      assertOkResponse();
+   }
+}
+
 static void powerDownGsmModule() {
    ESP_LOGI(GSM_MODULE_TAG, "--- power down via command ...");
    sendCommand("AT+CPOWD=1");
@@ -477,7 +627,7 @@ static void powerDownGsmModule() {
 bool sendHttpPostRequest(const char* url, const char* data) {
    bool sentSuccessfully = false;
    int urlCommandLength  = strlen(url) + strlen("AT+HTTPPARA=\"URL\",\"\"") + NULL_BYTE_LENGTH;
-   char *urlCommand      = malloc(urlCommandLength);
+   char *urlCommand      = allocate(urlCommandLength, ALLOCATION_TAG_AT_COMMAND);
    sprintf(urlCommand, "AT+HTTPPARA=\"URL\",\"%s\"", url);
    
    const AT_COMMANDS configureHttpCommands = { 3, (const char*[]) {        
@@ -491,11 +641,11 @@ bool sendHttpPostRequest(const char* url, const char* data) {
    ESP_LOGI(GSM_MODULE_TAG, "--- triggering HTTP POST action ...");
    if(executeCommands(&configureHttpCommands)) {
       int dataLength        = strlen(data);
-      int dataCommandLength = dataLength + strlen("AT+HTTPDATA=,") + charCountOf(dataLength) + charCountOf(MAX_INPUT_TIME_MS) + NULL_BYTE_LENGTH;
-      char *dataCommand     = malloc(dataCommandLength);
+      int dataCommandLength = strlen("AT+HTTPDATA=,") + charCountOf(dataLength) + charCountOf(MAX_INPUT_TIME_MS) + NULL_BYTE_LENGTH;
+      char *dataCommand     = allocate(dataCommandLength, ALLOCATION_TAG_AT_COMMAND);
       sprintf(dataCommand, "AT+HTTPDATA=%d,%d", dataLength, MAX_INPUT_TIME_MS);
       sendCommand(dataCommand);
-      free(dataCommand);
+      release(dataCommand);
 
       if(assertResponse("DOWNLOAD", SECONDS(1)) == GSM_OK) {
          sendCommand(data);
@@ -504,7 +654,7 @@ bool sendHttpPostRequest(const char* url, const char* data) {
          }
       }
    }
-   free(urlCommand);
+   release(urlCommand);
 
    if (!sentSuccessfully) {
       addErrorMessage("GSM_MODULE_FAILED_TO_SEND_HTTP_POST_REQUEST");
@@ -513,27 +663,344 @@ bool sendHttpPostRequest(const char* url, const char* data) {
    return sentSuccessfully;
 }
 
-static void activateGsmModule() {
-   if (!baudrateConfigured) {
+/*
+ * Initializes the bearer and the HTTP service of the GSM module unless this was already done (e.g. by prepareGsmModule()).
+ */
+static bool openHttpService() {
+   if (!bearerOpen || !httpServiceInitialized) {
+      enterPublishPhase(PHASE_CONNECTION_SETUP, millis());
+   }
+
+   if (!bearerOpen) {
+      ESP_LOGI(GSM_MODULE_TAG, "--- initializing bearer ...");
+      bearerOpen = executeCommands(&initBearerCommands);
+      if (!bearerOpen) {
+         addErrorMessage("GSM_MODULE_FAILED_TO_INIT_BEARER");
+         return false;
+      }
+   }
+
+   if (!httpServiceInitialized) {
+      ESP_LOGI(GSM_MODULE_TAG, "--- initializing HTTP ...");
+      httpServiceInitialized = executeCommands(&initHttpCommands);
+      if (!httpServiceInitialized) {
+         addErrorMessage("GSM_MODULE_FAILED_TO_INIT_HTTP");
+      }
+   }
+
+   return httpServiceInitialized;
+}
+
+static void closeHttpService() {
+   if (httpServiceInitialized) {
+      enterPublishPhase(PHASE_TEARDOWN, millis());
+      ESP_LOGI(GSM_MODULE_TAG, "--- terminating HTTP ...");
+      executeCommands(&terminateHttpCommands);
+   }
+   if (bearerOpen) {
+      enterPublishPhase(PHASE_TEARDOWN, millis());
+      ESP_LOGI(GSM_MODULE_TAG, "--- terminating bearer ...");
+      executeCommands(&terminateBearerCommands);
+   }
+   httpServiceInitialized = false;
+   bearerOpen             = false;
+}
+
+/*
+ * Reads lines till a non empty one was received or the timeout elapsed.
+ */
+static GsmStatus readNonEmptyLine(char *outputBuffer, int outputBufferSize, TickType_t timeoutInMs) {
+   timeoutInMs = limitToDeadline(timeoutInMs);
+   TickType_t ticksAtStart       = xTaskGetTickCount();
+   TickType_t passedMilliseconds = 0;
+
+   while (passedMilliseconds < timeoutInMs) {
+      if (readNextLine(outputBuffer, outputBufferSize, timeoutInMs - passedMilliseconds) == GSM_OK && strlen(outputBuffer) > 0) {
+         logDeferred(LOG_FORMAT_AT_RESPONSE, outputBuffer, 0, 0, 0);
+         return GSM_OK;
+      }
+      passedMilliseconds = (xTaskGetTickCount() - ticksAtStart) * portTICK_PERIOD_MS;
+   }
+
+   return GSM_TIMEOUT;
+}
+
+/*
+ * Reads the body of the response (AT+HTTPREAD) into responseBody. The service responds with a short JSON object in a 
+ * single line, therefore only the first line gets kept.
+ */
+static void readHttpResponseBody(int dataLength) {
+   char buffer[RESPONSE_BUFFER_SIZE];
+
+   if (dataLength <= 0) {
       return;
    }
 
-   bool isReady = false;
+   sendCommand("AT+HTTPREAD");
+   if (assertResponseStartingWith("+HTTPREAD:", buffer, RESPONSE_BUFFER_SIZE, SECONDS(5)) == GSM_OK 
+         && readNonEmptyLine(buffer, RESPONSE_BUFFER_SIZE, SECONDS(5)) == GSM_OK) {
+      strncpy(responseBody, buffer, MAX_RESPONSE_BODY_LENGTH);
+      responseBody[MAX_RESPONSE_BODY_LENGTH] = 0;
+      assertOkResponse();
+   }
+}
 
-   size_t maxRetries = 2;
-   for (size_t retry = 0; retry < maxRetries && !isReady; retry++) {
-      isReady = waitForGsmModuleToGetAvailable();
-      if (!isReady && (retry < (maxRetries - 1))) {
-         ESP_LOGI(GSM_MODULE_TAG, "interrupting power supply of GSM module for %d ms ...", RELAIS_ACTIVE_DURATION);
-         addErrorMessage("GSM_MODULE_INTERRUPT_POWER");
-         activateRelaisFor(RELAIS_ACTIVE_DURATION);
-         waitTillGsmModuleAcceptsPowerKey();
+static int sendViaHttpApplicationLayer(const char* url, const char* data) {
+   int httpStatusCode = HTTP_RESPONSE_ERROR;
+   int dataLength     = 0;
+
+   if (openHttpService()) {
+      enterPublishPhase(PHASE_REQUEST_TRANSFER, millis());
+      timeToRequestMs = millis() - sendStartedAt;
+      sendHttpPostRequest(url, data);
+      enterPublishPhase(PHASE_RESPONSE_WAIT, millis());
+      ESP_LOGI(GSM_MODULE_TAG, "--- waiting for HTTP response ...");
+      httpStatusCode = waitForHttpStatusCode(&dataLength);
+      if (httpStatusCode > 0) {
+         readHttpResponseBody(dataLength);
+      }
+   }
+   closeHttpService();
+
+   return httpStatusCode;
+}
+
+/*
+ * The GSM module requests the data of AT+CIPSEND with a "> " prompt that does not get terminated by a line feed.
+ */
+static GsmStatus waitForPrompt(TickType_t timeoutInMs) {
+   timeoutInMs = limitToDeadline(timeoutInMs);
+   uint8_t nextByte;
+   TickType_t ticksAtStart       = xTaskGetTickCount();
+   TickType_t passedMilliseconds = 0;
+
+   responseBuffer[0] = 0;
+
+   while (passedMilliseconds < timeoutInMs) {
+      if (readNextByte(&nextByte, timeoutInMs - passedMilliseconds) && nextByte == PROMPT_CHAR) {
+         traceAt(AT_TRACE_RESPONSE, "> ", timeoutInMs);
+         return GSM_OK;
+      }
+      passedMilliseconds = (xTaskGetTickCount() - ticksAtStart) * portTICK_PERIOD_MS;
+   }
+
+   traceAt(AT_TRACE_TIMEOUT, "> ", timeoutInMs);
+   return GSM_TIMEOUT;
+}
+
+/*
+ * Reads count bytes of a response body and keeps the first MAX_RESPONSE_BODY_LENGTH of them in responseBody.
+ */
+static bool readBodyBytes(int count, TickType_t timeoutInMs) {
+   timeoutInMs = limitToDeadline(timeoutInMs);
+   uint8_t nextByte;
+   int bodyLength                = 0;
+   TickType_t ticksAtStart       = xTaskGetTickCount();
+   TickType_t passedMilliseconds = 0;
+
+   while (count > 0 && passedMilliseconds < timeoutInMs) {
+      if (readNextByte(&nextByte, timeoutInMs - passedMilliseconds)) {
+         if (bodyLength < MAX_RESPONSE_BODY_LENGTH) {
+            responseBody[bodyLength++] = nextByte;
+         }
+         count--;
+      }
+      passedMilliseconds = (xTaskGetTickCount() - ticksAtStart) * portTICK_PERIOD_MS;
+   }
+   responseBody[bodyLength] = 0;
+
+   return count == 0;
+}
+
+static void closeTcpConnection() {
+   if (tcpConnectionOpen) {
+      ESP_LOGI(GSM_MODULE_TAG, "--- closing TCP connection ...");
+      sendCommand("AT+CIPCLOSE");
+      assertResponse("CLOSE OK|ERROR", SECONDS(2));
+   }
+   tcpConnectionOpen = false;
+}
+
+static void closeIdleTcpConnection() {
+   if (tcpConnectionOpen && (time(NULL) - tcpConnectionUsedAt) > TCP_KEEP_ALIVE_SECONDS) {
+      ESP_LOGI(GSM_MODULE_TAG, "TCP connection was idle for too long");
+      closeTcpConnection();
+   }
+}
+
+static bool openTcpConnection(const HTTP_URL *url) {
+   char buffer[RESPONSE_BUFFER_SIZE];
+
+   enterPublishPhase(PHASE_CONNECTION_SETUP, millis());
+   ESP_LOGI(GSM_MODULE_TAG, "--- opening TCP connection to %s:%d ...", url->host, url->port);
+   sendCommand("AT+CIPSHUT");
+   bool success = assertResponse("SHUT OK", SECONDS(5)) == GSM_OK;
+
+   success = success && executeCommands(&initTcpCommands);
+
+   if (success) {
+      // bringing up the wireless connection can take several seconds
+      sendCommand("AT+CIICR");
+      success = assertResponse(OK_RESPONSE, SECONDS(10)) == GSM_OK;
+   }
+
+   if (success) {
+      // the GSM module replies with the local IP address only (without any "OK")
+      sendCommand("AT+CIFSR");
+      success = readNonEmptyLine(buffer, RESPONSE_BUFFER_SIZE, SECONDS(5)) == GSM_OK;
+   }
+
+   if (success) {
+      sprintf(buffer, "AT+CIPSTART=\"TCP\",\"%s\",%d", url->host, url->port);
+      sendCommand(buffer);
+      success = assertResponse("CONNECT OK|ALREADY CONNECT", SECONDS(20)) == GSM_OK;
+   }
+
+   tcpConnectionOpen   = success;
+   tcpConnectionUsedAt = time(NULL);
+
+   if (!success) {
+      addErrorMessage("GSM_MODULE_FAILED_TO_OPEN_TCP_CONNECTION");
+   }
+
+   return success;
+}
+
+static bool writeTcpData(const char *data) {
+   char command[30];
+   int length = strlen(data);
+
+   enterPublishPhase(PHASE_REQUEST_TRANSFER, millis());
+   timeToRequestMs = millis() - sendStartedAt;
+
+   for (int offset = 0; offset < length; offset += MAX_CIPSEND_CHUNK_SIZE) {
+      int chunkSize = min(MAX_CIPSEND_CHUNK_SIZE, length - offset);
+      sprintf(command, "AT+CIPSEND=%d", chunkSize);
+      sendCommand(command);
+
+      if (waitForPrompt(SECONDS(5)) != GSM_OK) {
+         ESP_LOGE(GSM_MODULE_TAG, "did not receive prompt for sending %d bytes", chunkSize);
+         return false;
+      }
+
+      uart_write_bytes(UART_PORT, data + offset, chunkSize);
+
+      if (assertResponse("SEND OK", SECONDS(10)) != GSM_OK) {
+         ESP_LOGE(GSM_MODULE_TAG, "sending %d bytes at offset %d failed", chunkSize, offset);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+/*
+ * Reads the HTTP response from the TCP connection and returns its status code or -1 if no status line was received.
+ * The beginning of the body gets kept in responseBody. The connection gets closed if the server does not allow to 
+ * reuse it.
+ */
+static int readHttpResponse() {
+   char buffer[RESPONSE_BUFFER_SIZE];
+   int statusCode            = -1;
+   int contentLength         = -1;
+   bool keepAlive            = true;
+   bool endOfHeaderReceived  = false;
+
+   while (statusCode < 0 && readNonEmptyLine(buffer, RESPONSE_BUFFER_SIZE, SECONDS(10)) == GSM_OK) {
+      if (strcmp(buffer, "CLOSED") == 0) {
+         ESP_LOGW(GSM_MODULE_TAG, "server closed TCP connection");
+         traceAt(AT_TRACE_RESPONSE, "CLOSED", SECONDS(10));
+         tcpConnectionOpen = false;
+         return -1;
       }
-      if(isReady) {
-         isReady = waitForNetworkRegistration();
+      statusCode = parseHttpStatusLine(buffer);
+   }
+   traceAt((statusCode >= 0) ? AT_TRACE_RESPONSE : AT_TRACE_TIMEOUT, "HTTP/1.1", SECONDS(10));
+
+   ESP_LOGI(GSM_MODULE_TAG, "status code: %d", statusCode);
+
+   while (statusCode >= 0 && !endOfHeaderReceived && readNextLine(buffer, RESPONSE_BUFFER_SIZE, SECONDS(5)) == GSM_OK) {
+      const char *value;
+      endOfHeaderReceived = strlen(buffer) == 0;
+
+      if ((value = getHttpHeaderValue(buffer, "Content-Length")) != NULL) {
+         contentLength = atoi(value);
+      } else if ((value = getHttpHeaderValue(buffer, "Connection")) != NULL) {
+         keepAlive = strcasecmp(value, "close") != 0;
+      } else if (isRedirection(statusCode) && (value = getHttpHeaderValue(buffer, "Location")) != NULL) {
+         addErrorMessage(value);
       }
    }
 
+   // without a content length the end of the body is unknown -> the connection cannot get reused
+   keepAlive = keepAlive && endOfHeaderReceived && contentLength >= 0 && readBodyBytes(contentLength, SECONDS(5));
+
+   if (!keepAlive) {
+      closeTcpConnection();
+   }
+
+   return statusCode;
+}
+
+static int sendViaTcpConnection(const char* url, const char* data) {
+   HTTP_URL parsedUrl;
+
+   if (!parseUrl(url, &parsedUrl)) {
+      ESP_LOGE(GSM_MODULE_TAG, "failed to parse URL \"%s\"", url);
+      addErrorMessage("GSM_MODULE_INVALID_URL");
+      return HTTP_RESPONSE_ERROR;
+   }
+
+   closeIdleTcpConnection();
+
+   char *request    = createHttpPostRequest(&parsedUrl, data);
+   bool reused      = tcpConnectionOpen;
+   bool sent        = (tcpConnectionOpen || openTcpConnection(&parsedUrl)) && writeTcpData(request);
+
+   if (!sent && reused) {
+      // the server or the network may have dropped the idle connection -> retry once with a new one
+      ESP_LOGW(GSM_MODULE_TAG, "failed to reuse TCP connection -> reconnecting ...");
+      tcpConnectionOpen = false;
+      sent = openTcpConnection(&parsedUrl) && writeTcpData(request);
+   }
+
+   release(request);
+
+   if (!sent) {
+      addErrorMessage("GSM_MODULE_FAILED_TO_SEND_TCP_DATA");
+      closeTcpConnection();
+      return HTTP_RESPONSE_ERROR;
+   }
+
+   enterPublishPhase(PHASE_RESPONSE_WAIT, millis());
+   ESP_LOGI(GSM_MODULE_TAG, "--- waiting for HTTP response ...");
+   int httpStatusCode  = readHttpResponse();
+   tcpConnectionUsedAt = time(NULL);
+
+   return httpStatusCode;
+}
+
+/*
+ * Powers on the GSM module and waits for the network registration. Recovering from failures is up to the caller (see 
+ * recoverGsmModule(...)).
+ */
+static void activateGsmModule() {
+   if (!baudrateConfigured) {
+      failureClass = FAILURE_MODEM_UNRESPONSIVE;
+      return;
+   }
+
+   enterPublishPhase(PHASE_MODEM_ACTIVATION, millis());
+   bool isReady = waitForGsmModuleToGetAvailable();
+   
+   if (isReady) {
+      enterPublishPhase(PHASE_NETWORK_REGISTRATION, millis());
+      isReady = waitForNetworkRegistration();
+      failureClass = isReady ? FAILURE_NONE : FAILURE_REGISTRATION;
+   } else {
+      failureClass = FAILURE_MODEM_UNRESPONSIVE;
+   }
+
    moduleReadyTime = isReady ? time(NULL) : 0;
    gsmModuleReady  = isReady;
 }
@@ -547,7 +1014,7 @@ static void configureBaudrateOfGsmModule() {
    GsmStatus status = GSM_ERROR;
 
    ESP_LOGI(GSM_MODULE_TAG, "checking if gsm modules replies with 19200 ...");
-   ESP_ERROR_CHECK(uart_set_baudrate(UART_PORT, 19200));
+   ESP_ERROR_CHECK(uart_set_baudrate(UART_PORT, GSM_MODULE_BAUDRATE));
    // it is necessary to repeat it twice because the GSM module could already be available -> then it needs to be restarted to be in a defined state
    for(int i = 0; (i < 2) && (status != GSM_OK); i++) {
       setPwrPinHighFor(PWR_PIN_HIGH_DURATION);
@@ -578,7 +1045,7 @@ static void configureBaudrateOfGsmModule() {
          status = assertOkResponse();
       }
 
-      ESP_ERROR_CHECK(uart_set_baudrate(UART_PORT, 19200));
+      ESP_ERROR_CHECK(uart_set_baudrate(UART_PORT, GSM_MODULE_BAUDRATE));
       
       if (status == GSM_OK) {
          sendCommand("AT+IPR?");
@@ -593,6 +1060,7 @@ static void configureBaudrateOfGsmModule() {
    baudrateConfigured = (status == GSM_OK);
    if (baudrateConfigured) {
       ESP_LOGI(GSM_MODULE_TAG, "successfully set baudrate of gsm module");
+      storeFlag(BAUDRATE_CONFIGURED_KEY, true);
       powerDownGsmModule();
    } else {
       addErrorMessage("GSM_MODULE_FAILED_TO_SET_BAUDRATE");
@@ -600,14 +1068,127 @@ static void configureBaudrateOfGsmModule() {
    }   
 }
 
+/*
+ * Puts the GSM module into the configured low power mode till the next publishment. In sleep mode the module stays 
+ * registered and wakes up when it receives data on the serial port. In minimum functionality mode the RF part gets 
+ * switched off and the module needs to register again after waking up.
+ */
+static void enterIdleMode() {
+   if (IDLE_MODE == IDLE_MODE_SLEEP) {
+      ESP_LOGI(GSM_MODULE_TAG, "--- enabling sleep mode ...");
+      sendCommand("AT+CSCLK=2");
+      gsmModuleIdle = assertOkResponse() == GSM_OK;
+   } else if (IDLE_MODE == IDLE_MODE_MINIMUM_FUNCTIONALITY) {
+      ESP_LOGI(GSM_MODULE_TAG, "--- switching to minimum functionality ...");
+      sendCommand("AT+CFUN=0");
+      gsmModuleIdle     = assertResponse(OK_RESPONSE, SECONDS(10)) == GSM_OK;
+      tcpConnectionOpen = false;
+   }
+}
+
+static bool wakeUpGsmModule() {
+   if (!gsmModuleIdle) {
+      return true;
+   }
+
+   enterPublishPhase(PHASE_MODEM_WAKE_UP, millis());
+   bool awake = false;
+
+   if (IDLE_MODE == IDLE_MODE_SLEEP) {
+      ESP_LOGI(GSM_MODULE_TAG, "--- waking up GSM module ...");
+      // the first characters wake up the module and get lost -> repeat till it answers
+      for (int i = 0; i < 5 && !awake; i++) {
+         sendCommand("AT");
+         awake = assertResponse(OK_RESPONSE, 200) == GSM_OK;
+      }
+      if (awake) {
+         sendCommand("AT+CSCLK=0");
+         awake = assertOkResponse() == GSM_OK;
+      }
+   } else if (IDLE_MODE == IDLE_MODE_MINIMUM_FUNCTIONALITY) {
+      ESP_LOGI(GSM_MODULE_TAG, "--- switching to full functionality ...");
+      sendCommand("AT+CFUN=1");
+      awake = assertResponse(OK_RESPONSE, SECONDS(10)) == GSM_OK;
+      if (awake) {
+         enterPublishPhase(PHASE_NETWORK_REGISTRATION, millis());
+         awake = waitForNetworkRegistration();
+      }
+   }
+
+   gsmModuleIdle = false;
+   ESP_LOGI(GSM_MODULE_TAG, "wake up %s after %u ms", awake ? "succeeded" : "failed", millis() - sendStartedAt);
+   return awake;
+}
+
 static void interruptPowerSupply() {
    if (gsmModuleReady) {
       powerDownGsmModule();
    }
    activateRelaisFor(MODULE_POWER_SUPPLY_OFF_DURATION);
-   failedSendAttempts = 0;
-   baudrateConfigured = false;
-   gsmModuleReady     = false;
+   // the module might not answer because its baudrate got lost -> configure it again
+   storeFlag(BAUDRATE_CONFIGURED_KEY, false);
+   baudrateConfigured     = false;
+   gsmModuleReady         = false;
+   tcpConnectionOpen      = false;
+   gsmModuleIdle          = false;
+   bearerOpen             = false;
+   httpServiceInitialized = false;
+}
+
+/*
+ * Closes all connections and the bearer. The registration in the network stays untouched.
+ */
+static void softReset() {
+   closeTcpConnection();
+   closeHttpService();
+   sendCommand("AT+CIPSHUT");
+   assertResponse("SHUT OK|ERROR", SECONDS(5));
+}
+
+/*
+ * Switches the RF part off and on again. This forces the GSM module to register again in the network.
+ */
+static void functionalityReset() {
+   sendCommand("AT+CFUN=0");
+   bool success = assertResponse(OK_RESPONSE, SECONDS(10)) == GSM_OK;
+   
+   if (success) {
+      sendCommand("AT+CFUN=1");
+      success = assertResponse(OK_RESPONSE, SECONDS(10)) == GSM_OK;
+   }
+
+   tcpConnectionOpen      = false;
+   bearerOpen             = false;
+   httpServiceInitialized = false;
+   gsmModuleReady         = success && waitForNetworkRegistration();
+   moduleReadyTime        = gsmModuleReady ? time(NULL) : 0;
+}
+
+/*
+ * Wakes up the GSM module or activates it if it is not ready.
+ */
+static void bringUpGsmModule() {
+   uint32_t startedAt = millis();
+
+   if (gsmModuleReady && !wakeUpGsmModule()) {
+      ESP_LOGE(GSM_MODULE_TAG, "gsm module did not wake up -> activating it again ...");
+      addErrorMessage("GSM_MODULE_DID_NOT_WAKE_UP");
+      gsmModuleReady         = false;
+      tcpConnectionOpen      = false;
+      bearerOpen             = false;
+      httpServiceInitialized = false;
+   }
+
+   if (!gsmModuleReady) {
+      enterPublishPhase(PHASE_MODEM_ACTIVATION, millis());
+      initializeGsmModule();
+      activateGsmModule();
+   }
+
+   if (gsmModuleReady) {
+      sampleSignalQuality();
+   }
+   bringUpMs += millis() - startedAt;
 }
 
 void initializeGsmModule() {
@@ -619,63 +1200,227 @@ void initializeGsmModule() {
       uartAndGpioInitialized = true;
    }
 
+   if (!baudrateConfigured && readStoredFlag(BAUDRATE_CONFIGURED_KEY)) {
+      // AT&W stored the baudrate in the GSM module during a previous boot -> it does not need to get powered up now
+      ESP_LOGI(GSM_MODULE_TAG, "baudrate of gsm module already configured");
+      ESP_ERROR_CHECK(uart_set_baudrate(UART_PORT, GSM_MODULE_BAUDRATE));
+      baudrateConfigured = true;
+   }
+
    if (!baudrateConfigured) {
       configureBaudrateOfGsmModule();
    }
 }
 
-int send(const char* url, const char* data)
+int sendViaGsmModule(const char* url, const char* data)
 {        
    int httpStatusCode = HTTP_RESPONSE_ERROR;
    responseBuffer[0] = 0;
+   responseBody[0]   = 0;
+   sendStartedAt     = millis();
+   timeToRequestMs   = 0;
+   failureClass      = FAILURE_NONE;
 
-   if (!gsmModuleReady) {
-      initializeGsmModule();
-      activateGsmModule();
-   }
+   bringUpGsmModule();
    
    if (!gsmModuleReady) {
-      ESP_LOGE(GSM_MODULE_TAG, "gsm module not ready -> interrupting power supply of gsm module ...");
+      ESP_LOGE(GSM_MODULE_TAG, "gsm module not ready");
       addErrorMessage("GSM_MODULE_NOT_READY");
-      interruptPowerSupply();
-   } else { 
-      ESP_LOGI(GSM_MODULE_TAG, "--- initializing bearer ...");
-      if (!executeCommands(&initBearerCommands)) {
-         addErrorMessage("GSM_MODULE_FAILED_TO_INIT_BEARER");
-      } else {
-         ESP_LOGI(GSM_MODULE_TAG, "--- initializing HTTP ...");
-         if (!executeCommands(&initHttpCommands)) {
-            addErrorMessage("GSM_MODULE_FAILED_TO_INIT_HTTP");
-         } else {
-            sendHttpPostRequest(url, data);
-            ESP_LOGI(GSM_MODULE_TAG, "--- waiting for HTTP response ...");
-            httpStatusCode = waitForHttpStatusCode();
-            ESP_LOGI(GSM_MODULE_TAG, "--- terminating HTTP ...");
-            executeCommands(&terminateHttpCommands);
-         }
-         ESP_LOGI(GSM_MODULE_TAG, "--- terminating bearer ...");
-         executeCommands(&terminateBearerCommands);
-      }
+   } else if (deadlinePassed()) {
+      ESP_LOGW(GSM_MODULE_TAG, "deadline passed before data could get sent");
+      failureClass = FAILURE_NETWORK;
+   } else if (USE_TCP_TRANSPORT) {
+      httpStatusCode = sendViaTcpConnection(url, data);
+   } else {
+      httpStatusCode = sendViaHttpApplicationLayer(url, data);
    }
 
-   if (httpStatusCode == HTTP_RESPONSE_OK) {
-      failedSendAttempts = 0;
-   } else {
-      failedSendAttempts++;
+   if (gsmModuleReady && httpStatusCode != HTTP_RESPONSE_OK) {
+      if (httpStatusCode > 0) {
+         failureClass = FAILURE_SERVER;
+      } else if (isCoverageProblem(time(NULL))) {
+         // restarting the GSM module does not help if there is no network coverage
+         addErrorMessage("GSM_MODULE_NO_COVERAGE");
+         failureClass = FAILURE_REGISTRATION;
+      } else {
+         failureClass = FAILURE_NETWORK;
+      }
+      if (getSmoothedRssi() >= 0) {
+         // enables the correlation of failures with the signal quality
+         char rssiMessage[30];
+         sprintf(rssiMessage, "GSM_SIGNAL_RSSI_%d", getSmoothedRssi());
+         addErrorMessage(rssiMessage);
+      }
    }
  
    time_t moduleReadyDurationInSeconds = time(NULL) - moduleReadyTime;
 
    if (gsmModuleReady && moduleReadyDurationInSeconds >= ONE_DAY_IN_SECONDS) {
+      enterPublishPhase(PHASE_RECOVERY, millis());
       ESP_LOGI(GSM_MODULE_TAG, "performing daily restart of gsm module ...");
       interruptPowerSupply();
    }
+
+   if (timeToRequestMs > 0) {
+      ESP_LOGI(GSM_MODULE_TAG, "time till request got sent: %u ms", timeToRequestMs);
+   }
    
-   if (failedSendAttempts >= FAILED_SEND_ATTEMPTS_TO_RESTART_GSM_MODULE) {
-      ESP_LOGI(GSM_MODULE_TAG, "number (%d) of maximum failed send attempts reached -> interrupting power supply of gsm module ...", FAILED_SEND_ATTEMPTS_TO_RESTART_GSM_MODULE);
+   return httpStatusCode;
+}
+
+bool prepareGsmModule(const char* url) {
+   HTTP_URL parsedUrl;
+   responseBuffer[0] = 0;
+
+   bringUpGsmModule();
+
+   if (!gsmModuleReady || deadlinePassed()) {
+      return false;
+   }
+
+   if (USE_TCP_TRANSPORT) {
+      closeIdleTcpConnection();
+      return tcpConnectionOpen || (parseUrl(url, &parsedUrl) && openTcpConnection(&parsedUrl));
+   }
+
+   return openHttpService();
+}
+
+FailureClass getGsmModuleFailureClass() {
+   return failureClass;
+}
+
+void recoverGsmModule(RecoveryAction action) {
+   if (action == RECOVERY_NONE) {
+      return;
+   }
+
+   enterPublishPhase(PHASE_RECOVERY, millis());
+   ESP_LOGW(GSM_MODULE_TAG, "--- recovering gsm module (%s) ...", getRecoveryActionName(action));
+   responseBuffer[0] = 0;
+
+   if (action == RECOVERY_POWER_CYCLE || !baudrateConfigured || !wakeUpGsmModule()) {
       addErrorMessage("GSM_MODULE_RESET_POWER");
       interruptPowerSupply();
+      return;
    }
-   
-   return httpStatusCode;
+
+   if (action == RECOVERY_SOFT_RESET) {
+      addErrorMessage("GSM_MODULE_SOFT_RESET");
+      softReset();
+   } else {
+      addErrorMessage("GSM_MODULE_FUNCTIONALITY_RESET");
+      functionalityReset();
+   }
+}
+
+void sleepGsmModule() {
+   if (gsmModuleReady && !gsmModuleIdle) {
+      responseBuffer[0] = 0;
+      enterIdleMode();
+   }
+}
+
+GSM_MODULE_STATE suspendGsmModule() {
+   sleepGsmModule();
+
+   if (gsmModuleReady && !gsmModuleIdle && IDLE_MODE != IDLE_MODE_ACTIVE) {
+      ESP_LOGW(GSM_MODULE_TAG, "gsm module did not enter its low power mode -> powering it down");
+      powerDownGsmModule();
+      gsmModuleReady = false;
+   }
+   if (uartAndGpioInitialized) {
+      // a floating power key would switch the module off during the deep sleep
+      rtc_gpio_hold_en(IO_PIN_FOR_PWRKEY);
+   }
+
+   GSM_MODULE_STATE state = {
+      .ready                  = gsmModuleReady,
+      .idle                   = gsmModuleIdle,
+      .bearerOpen             = bearerOpen,
+      .httpServiceInitialized = httpServiceInitialized,
+      .tcpConnectionOpen      = tcpConnectionOpen,
+      .readyTime              = moduleReadyTime,
+      .tcpConnectionUsedAt    = tcpConnectionUsedAt
+   };
+   return state;
+}
+
+void resumeGsmModule(const GSM_MODULE_STATE *state) {
+   gsmModuleReady         = state->ready;
+   gsmModuleIdle          = state->idle;
+   bearerOpen             = state->bearerOpen;
+   httpServiceInitialized = state->httpServiceInitialized;
+   tcpConnectionOpen      = state->tcpConnectionOpen;
+   moduleReadyTime        = state->readyTime;
+   tcpConnectionUsedAt    = state->tcpConnectionUsedAt;
+   ESP_LOGI(GSM_MODULE_TAG, "gsm module %s", gsmModuleReady ? (gsmModuleIdle ? "sleeps" : "stays active") : "is off");
+}
+
+uint32_t getGsmModuleBringUpMs() {
+   return bringUpMs;
+}
+
+void dumpGsmModuleAtTrace() {
+#ifdef CONFIG_WINDSENSOR_AT_TRACE
+   AT_TRACE_RECORD record;
+   char line[AT_TRACE_LINE_LENGTH + 1];
+   uint32_t lostRecords;
+
+   portENTER_CRITICAL(&atTraceMux);
+   lostRecords          = atTrace.lostRecords;
+   atTrace.lostRecords  = 0;
+   portEXIT_CRITICAL(&atTraceMux);
+
+   if (lostRecords > 0) {
+      ESP_LOGW(GSM_MODULE_TAG, "%u records of the AT trace got overwritten", lostRecords);
+   }
+
+   // one record per lock, because printing is slow and the uplink task keeps recording
+   for (;;) {
+      portENTER_CRITICAL(&atTraceMux);
+      bool taken = takeAtTraceRecord(&atTrace, &record);
+      portEXIT_CRITICAL(&atTraceMux);
+      if (!taken) {
+         break;
+      }
+      encodeAtTraceRecord(&record, line, sizeof(line));
+      ESP_LOGI(GSM_MODULE_TAG, "%s", line);
+   }
+#endif
+}
+
+uint32_t getGsmModuleTimeToRequestMs() {
+   return timeToRequestMs;
+}
+
+const char* getGsmModuleResponseBody() {
+   return responseBody;
+}
+
+void setGsmModuleDeadline(TickType_t deadlineInTicks) {
+   deadline       = deadlineInTicks;
+   deadlineActive = true;
+}
+
+void clearGsmModuleDeadline() {
+   deadlineActive = false;
+}
+
+static TRANSPORT gsmTransport = {
+   .name             = "gsm",
+   .maxDataLength    = MAX_DATA_LENGTH,
+   .initialize       = initializeGsmModule,
+   .connect          = prepareGsmModule,
+   .send             = sendViaGsmModule,
+   .getResponseBody  = getGsmModuleResponseBody,
+   .sleep            = sleepGsmModule,
+   .getFailureClass  = getGsmModuleFailureClass,
+   .recover          = recoverGsmModule,
+   .setDeadline      = setGsmModuleDeadline,
+   .clearDeadline    = clearGsmModuleDeadline
+};
+
+TRANSPORT* getGsmTransport() {
+   return &gsmTransport;
 }
\ No newline at end of file
@@ -1,15 +1,110 @@
 #ifndef windsensor_gsm_module_h
 #define windsensor_gsm_module_h
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "RetryPolicy.h"
+#include "Transport.h"
+
+typedef struct {
+   bool ready;                      // powered on and registered, no PWRKEY pulse needed
+   bool idle;                       // in its low power mode, needs a wake up
+   bool bearerOpen;
+   bool httpServiceInitialized;
+   bool tcpConnectionOpen;
+   time_t readyTime;                // for the daily restart
+   time_t tcpConnectionUsedAt;
+} GSM_MODULE_STATE;
+
 /**
- * Sends data to the URL and returns the HTTP status code. In case of problems the returned status code is 0.
+ * Returns the GSM module as transport (see Transport.h).
  **/
-int send(const char* url, const char* data);
+TRANSPORT* getGsmTransport();
+
+/**
+ * Sends data to the URL and returns the HTTP status code. In case of problems the returned status code is 0. The GSM
+ * module stays awake till sleepGsmModule() gets called.
+ **/
+int sendViaGsmModule(const char* url, const char* data);
+
+/**
+ * Returns the beginning of the response body received by the last invocation of sendViaGsmModule(...) (AT+HTTPREAD or
+ * the TCP connection) or an empty string.
+ **/
+const char* getGsmModuleResponseBody();
 
 /**
  * Initializes the serial connection to the GSM module and also the GSM module itself. This method gets called
- * automatically when you call send(...).
+ * automatically when you call sendViaGsmModule(...). The fixed baudrate gets configured only once and the module does 
+ * not get powered up in subsequent boots (the configuration is stored in NVS till the next power cycle of the module).
  */
 void initializeGsmModule();
 
+/**
+ * Wakes up (or activates) the GSM module, waits for the network registration and sets up the connection to the URL, so 
+ * that a following sendViaGsmModule(...) can transfer its data immediately. Returns true if the connection is ready.
+ */
+bool prepareGsmModule(const char* url);
+
+/**
+ * Limits all following waits for responses of the GSM module to the provided point in time (in ticks). When the deadline
+ * passed, sendViaGsmModule(...) skips its remaining steps and returns an error status code.
+ */
+void setGsmModuleDeadline(TickType_t deadlineInTicks);
+
+/**
+ * Removes the deadline set by setGsmModuleDeadline(...).
+ */
+void clearGsmModuleDeadline();
+
+/**
+ * Returns the class of the failure that happened in the last invocation of sendViaGsmModule(...) or FAILURE_NONE if it succeeded.
+ */
+FailureClass getGsmModuleFailureClass();
+
+/**
+ * Executes the recovery action (e.g. returned by the circuit breaker, see RetryPolicy.h). A module that does not wake up
+ * gets power cycled.
+ */
+void recoverGsmModule(RecoveryAction action);
+
+/**
+ * Puts the GSM module into the configured low power mode till the next publishment (see Kconfig).
+ */
+void sleepGsmModule();
+
+/**
+ * Puts the GSM module into its low power mode (see sleepGsmModule()) before the ESP32 enters deep sleep and returns its 
+ * state, which has to survive the deep sleep. A module that does not enter the low power mode gets powered down. The 
+ * power key stays low during the deep sleep.
+ */
+GSM_MODULE_STATE suspendGsmModule();
+
+/**
+ * Restores the state returned by suspendGsmModule() after the deep sleep, so that the next publishment wakes up the 
+ * module instead of pulsing the power key of a module that is already on (which would switch it off).
+ */
+void resumeGsmModule(const GSM_MODULE_STATE *state);
+
+/**
+ * Returns the milliseconds the GSM module needed since the boot to wake up or to power on and register.
+ */
+uint32_t getGsmModuleBringUpMs();
+
+/**
+ * Logs the records of the AT trace (if enabled, see Kconfig) as lines starting with "attrace:" and removes them. The 
+ * tool test/AtTraceAnalyzer.c turns the lines of a log into latency statistics per command.
+ **/
+void dumpGsmModuleAtTrace();
+
+/**
+ * Returns the milliseconds the last invocation of sendViaGsmModule(...) needed to wake up (or activate) the GSM module and to set up
+ * the connection till it started transferring the request. Returns 0 if no request got transferred.
+ */
+uint32_t getGsmModuleTimeToRequestMs();
+
 #endif
\ No newline at end of file
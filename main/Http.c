@@ -0,0 +1,151 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "Http.h"
+#include "Memory.h"
+
+#define NULL_BYTE_LENGTH               1
+#define HTTP_PROTOCOL_PREFIX           "http://"
+#define HTTP_VERSION_PREFIX            "HTTP/1."
+#define MAX_PORT                       65535
+
+static const char* POST_REQUEST_FORMAT = "POST %s HTTP/1.1\r\n"
+                                         "Host: %s%s\r\n"
+                                         "Content-Type: application/json\r\n"
+                                         "Content-Length: %d\r\n"
+                                         "Connection: keep-alive\r\n"
+                                         "\r\n"
+                                         "%s";
+
+bool parseUrl(const char *url, HTTP_URL *result) {
+   const char *start = url;
+
+   if (strncmp(start, HTTP_PROTOCOL_PREFIX, strlen(HTTP_PROTOCOL_PREFIX)) == 0) {
+      start += strlen(HTTP_PROTOCOL_PREFIX);
+   }
+
+   const char *hostEnd = start;
+   while (*hostEnd != 0 && *hostEnd != ':' && *hostEnd != '/') {
+      hostEnd++;
+   }
+
+   size_t hostLength = hostEnd - start;
+   if (hostLength == 0 || hostLength > MAX_HOST_LENGTH) {
+      return false;
+   }
+
+   strncpy(result->host, start, hostLength);
+   result->host[hostLength] = 0;
+   result->port             = DEFAULT_HTTP_PORT;
+   result->path             = "/";
+
+   const char *position = hostEnd;
+
+   if (*position == ':') {
+      position++;
+      int port = 0;
+      int digits = 0;
+      while (isdigit((unsigned char)*position)) {
+         port = (port * 10) + (*position - '0');
+         position++;
+         digits++;
+         if (port > MAX_PORT) {
+            return false;
+         }
+      }
+      if (digits == 0 || port == 0 || (*position != 0 && *position != '/')) {
+         return false;
+      }
+      result->port = port;
+   }
+
+   if (*position == '/') {
+      result->path = position;
+   }
+
+   return true;
+}
+
+char* createHttpPostRequest(const HTTP_URL *url, const char *data) {
+   char portSuffix[7] = "";
+   if (url->port != DEFAULT_HTTP_PORT) {
+      sprintf(portSuffix, ":%d", url->port);
+   }
+
+   int dataLength    = strlen(data);
+   int requestLength = snprintf(NULL, 0, POST_REQUEST_FORMAT, url->path, url->host, portSuffix, dataLength, data);
+   char *request     = allocate(requestLength + NULL_BYTE_LENGTH, ALLOCATION_TAG_HTTP_REQUEST);
+   sprintf(request, POST_REQUEST_FORMAT, url->path, url->host, portSuffix, dataLength, data);
+
+   return request;
+}
+
+int parseHttpStatusLine(const char *line) {
+   if (strncmp(line, HTTP_VERSION_PREFIX, strlen(HTTP_VERSION_PREFIX)) != 0) {
+      return -1;
+   }
+
+   const char *position = strchr(line, ' ');
+   if (position == NULL) {
+      return -1;
+   }
+   position++;
+
+   int statusCode = 0;
+   for (int i = 0; i < 3; i++) {
+      if (!isdigit((unsigned char)position[i])) {
+         return -1;
+      }
+      statusCode = (statusCode * 10) + (position[i] - '0');
+   }
+
+   return (position[3] == 0 || position[3] == ' ') ? statusCode : -1;
+}
+
+const char* getHttpHeaderValue(const char *headerLine, const char *headerName) {
+   size_t nameLength = strlen(headerName);
+
+   if (strncasecmp(headerLine, headerName, nameLength) != 0 || headerLine[nameLength] != ':') {
+      return NULL;
+   }
+
+   const char *value = headerLine + nameLength + 1;
+   while (*value == ' ') {
+      value++;
+   }
+   return value;
+}
+
+
+bool parseAcknowledgement(const char *body, uint32_t *recordId) {
+   const char *position = (body == NULL) ? NULL : strstr(body, "\"ack\"");
+   if (position == NULL) {
+      return false;
+   }
+
+   position += strlen("\"ack\"");
+   while (*position == ' ') {
+      position++;
+   }
+   if (*position != ':') {
+      return false;
+   }
+   position++;
+   while (*position == ' ') {
+      position++;
+   }
+   if (!isdigit((unsigned char)*position)) {
+      return false;
+   }
+
+   uint32_t value = 0;
+   while (isdigit((unsigned char)*position)) {
+      value = value * 10 + (*position - '0');
+      position++;
+   }
+   *recordId = value;
+   return true;
+}
\ No newline at end of file
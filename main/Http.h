@@ -0,0 +1,49 @@
+#ifndef windsensor_http_h
+#define windsensor_http_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAX_HOST_LENGTH          100
+#define DEFAULT_HTTP_PORT        80
+
+typedef struct {
+   char host[MAX_HOST_LENGTH + 1];
+   int port;
+   const char *path;
+} HTTP_URL;
+
+/**
+ * Splits the provided URL (host, optional port and optional path without protocol) into its parts. The path of the
+ * result points into the provided url and is "/" if the URL does not contain a path. Returns false if the URL is
+ * invalid (e.g. host too long or port not a number).
+ **/
+bool parseUrl(const char *url, HTTP_URL *result);
+
+/**
+ * Creates a complete HTTP/1.1 POST request (header and body) that asks the server to keep the connection alive.
+ *
+ * The caller has to release the returned pointer (see Memory.h)!!!
+ **/
+char* createHttpPostRequest(const HTTP_URL *url, const char *data);
+
+/**
+ * Returns the status code contained in a HTTP status line (e.g. "HTTP/1.1 200 OK") or -1 if the line is not a status line.
+ **/
+int parseHttpStatusLine(const char *line);
+
+/**
+ * Returns the value of the provided header line if its name is equal to headerName (case insensitive), otherwise NULL.
+ * The returned pointer points into headerLine.
+ **/
+const char* getHttpHeaderValue(const char *headerLine, const char *headerName);
+
+/**
+ * Parses the body of a response of the service. The service acknowledges the stored messages with a body like 
+ * {"ack":1234} containing the highest record id up to which it stored all records from the oldestRecordId of the 
+ * envelope on, including the ones of previous envelopes. Returns true and sets recordId if the body contains such an 
+ * acknowledgement.
+ **/
+bool parseAcknowledgement(const char *body, uint32_t *recordId);
+
+#endif
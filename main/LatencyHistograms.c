@@ -0,0 +1,137 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "LatencyHistograms.h"
+
+static const char* VALUE_NAMES[PROFILED_VALUE_COUNT] = {
+   "pulse",
+   "adc",
+   "queued",
+   "wakeUp",
+   "activation",
+   "registration",
+   "setup",
+   "transfer",
+   "response",
+   "teardown",
+   "recovery",
+   "waiting"
+};
+
+static HISTOGRAM windows[HISTOGRAM_WINDOW_COUNT][PROFILED_VALUE_COUNT];
+static int currentWindow      = 0;
+static int completedWindows   = 0;
+
+static bool isValid(ProfiledValue value) {
+   return value >= 0 && value < PROFILED_VALUE_COUNT;
+}
+
+int getHistogramBucket(uint32_t durationUs) {
+   int bucket = 0;
+   while (durationUs > 0 && bucket < HISTOGRAM_BUCKET_COUNT - 1) {
+      durationUs >>= 1;
+      bucket++;
+   }
+   return bucket;
+}
+
+void recordDuration(ProfiledValue value, uint32_t durationUs) {
+   if (!isValid(value)) {
+      return;
+   }
+   HISTOGRAM *histogram = &windows[currentWindow][value];
+   int bucket           = getHistogramBucket(durationUs);
+   
+   if (histogram->counts[bucket] < UINT16_MAX) {
+      histogram->counts[bucket]++;
+   }
+   histogram->count++;
+   if (durationUs > histogram->maxUs) {
+      histogram->maxUs = durationUs;
+   }
+}
+
+void rotateHistogramWindow() {
+   currentWindow = (currentWindow + 1) % HISTOGRAM_WINDOW_COUNT;
+   memset(windows[currentWindow], 0, sizeof(windows[currentWindow]));
+   if (completedWindows < HISTOGRAM_WINDOW_COUNT - 1) {
+      completedWindows++;
+   }
+}
+
+const HISTOGRAM* getHistogram(ProfiledValue value, int windowsAgo) {
+   if (!isValid(value) || windowsAgo < 0 || windowsAgo > completedWindows) {
+      return NULL;
+   }
+   return &windows[(currentWindow + HISTOGRAM_WINDOW_COUNT - windowsAgo) % HISTOGRAM_WINDOW_COUNT][value];
+}
+
+void mergeHistograms(ProfiledValue value, HISTOGRAM *result) {
+   memset(result, 0, sizeof(HISTOGRAM));
+   for (int windowsAgo = 0; windowsAgo <= completedWindows; windowsAgo++) {
+      const HISTOGRAM *histogram = getHistogram(value, windowsAgo);
+      if (histogram == NULL) {
+         continue;
+      }
+      for (int bucket = 0; bucket < HISTOGRAM_BUCKET_COUNT; bucket++) {
+         uint32_t sum           = result->counts[bucket] + histogram->counts[bucket];
+         result->counts[bucket] = (sum < UINT16_MAX) ? sum : UINT16_MAX;
+      }
+      result->count += histogram->count;
+      if (histogram->maxUs > result->maxUs) {
+         result->maxUs = histogram->maxUs;
+      }
+   }
+}
+
+uint32_t getPercentileUs(const HISTOGRAM *histogram, int percent) {
+   uint32_t total = 0;
+   for (int bucket = 0; bucket < HISTOGRAM_BUCKET_COUNT; bucket++) {
+      total += histogram->counts[bucket];
+   }
+   if (total == 0) {
+      return 0;
+   }
+
+   uint32_t threshold   = (total * percent + 99) / 100;
+   uint32_t accumulated = 0;
+   for (int bucket = 0; bucket < HISTOGRAM_BUCKET_COUNT - 1; bucket++) {
+      accumulated += histogram->counts[bucket];
+      if (accumulated >= threshold && accumulated > 0) {
+         uint32_t upperBound = 1u << bucket;
+         return (upperBound < histogram->maxUs) ? upperBound : histogram->maxUs;
+      }
+   }
+   return histogram->maxUs;
+}
+
+const char* getProfiledValueName(ProfiledValue value) {
+   return isValid(value) ? VALUE_NAMES[value] : "unknown";
+}
+
+int formatHistograms(char *buffer, size_t bufferSize) {
+   size_t length = snprintf(buffer, bufferSize, "{");
+   bool first    = true;
+
+   for (int value = 0; value < PROFILED_VALUE_COUNT && length < bufferSize; value++) {
+      HISTOGRAM histogram;
+      mergeHistograms(value, &histogram);
+      if (histogram.count > 0) {
+         length += snprintf(buffer + length, bufferSize - length, "%s\"%s\":[%u,%u,%u,%u]", first ? "" : ",", VALUE_NAMES[value], 
+            histogram.count, getPercentileUs(&histogram, 50), getPercentileUs(&histogram, 99), histogram.maxUs);
+         first = false;
+      }
+   }
+
+   if (length < bufferSize) {
+      length += snprintf(buffer + length, bufferSize - length, "}");
+   }
+   return (length < bufferSize) ? (int)length : -1;
+}
+
+void resetHistograms() {
+   memset(windows, 0, sizeof(windows));
+   currentWindow    = 0;
+   completedWindows = 0;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef windsensor_latency_histograms_h
+#define windsensor_latency_histograms_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PhaseTimings.h"
+
+#define HISTOGRAM_BUCKET_COUNT   24
+#define HISTOGRAM_WINDOW_COUNT   4
+
+/**
+ * The publish phases follow the ADC read (one histogram per phase).
+ **/
+typedef enum {
+   PROFILED_PULSE_LATENCY,       // from the interrupt of the anemometer pulse till it got counted
+   PROFILED_ADC_READ,
+   PROFILED_FIRST_PHASE,
+   PROFILED_VALUE_COUNT = PROFILED_FIRST_PHASE + PHASE_COUNT
+} ProfiledValue;
+
+#define MAX_VALUE_NAME_LENGTH             12
+#define MAX_FORMATTED_VALUE_LENGTH        (MAX_VALUE_NAME_LENGTH + 49)    // ,"name":[] and 4 values of up to 10 digits
+#define MAX_FORMATTED_HISTOGRAMS_LENGTH   (2 + (PROFILED_VALUE_COUNT * MAX_FORMATTED_VALUE_LENGTH))
+
+/**
+ * Bucket 0 counts the durations below 1 us, bucket i (i > 0) those from 2^(i-1) till 2^i - 1 us and the last bucket 
+ * all longer ones.
+ **/
+typedef struct {
+   uint16_t counts[HISTOGRAM_BUCKET_COUNT];
+   uint32_t count;
+   uint32_t maxUs;
+} HISTOGRAM;
+
+/**
+ * Adds the duration to the histogram of the current window.
+ **/
+void recordDuration(ProfiledValue value, uint32_t durationUs);
+
+/**
+ * Starts a new window. The oldest window gets dropped.
+ **/
+void rotateHistogramWindow();
+
+/**
+ * Returns the histogram of the window that started windowsAgo rotations ago (0 = current window) or NULL if the window
+ * does not exist.
+ **/
+const HISTOGRAM* getHistogram(ProfiledValue value, int windowsAgo);
+
+/**
+ * Sums up the histograms of all windows.
+ **/
+void mergeHistograms(ProfiledValue value, HISTOGRAM *result);
+
+/**
+ * Returns the index of the bucket the duration belongs to.
+ **/
+int getHistogramBucket(uint32_t durationUs);
+
+/**
+ * Returns the exclusive upper bound of the bucket that contains the percentile (0 - 100) or the maximum if it is in 
+ * the last bucket. Returns 0 for an empty histogram.
+ **/
+uint32_t getPercentileUs(const HISTOGRAM *histogram, int percent);
+
+/**
+ * Returns a short name of the value.
+ **/
+const char* getProfiledValueName(ProfiledValue value);
+
+/**
+ * Writes count, median, 99th percentile and maximum (in us) of all windows for each value as compact JSON object into 
+ * the buffer and returns the number of characters written (without the null byte) or -1 if the buffer is too small. 
+ * Values without samples get skipped. A buffer of MAX_FORMATTED_HISTOGRAMS_LENGTH + 1 bytes is always big enough.
+ *
+ * Example: {"pulse":[120,16,64,80],"adc":[60,32,64,41]}
+ **/
+int formatHistograms(char *buffer, size_t bufferSize);
+
+/**
+ * Clears all windows.
+ **/
+void resetHistograms();
+
+#endif
\ No newline at end of file
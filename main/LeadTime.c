@@ -0,0 +1,65 @@
+#include <string.h>
+
+#include "LeadTime.h"
+
+static LEAD_TIME_STATISTICS statistics;
+static uint32_t minimumLeadTime = 0;
+static uint32_t maximumLeadTime = 0;
+
+static uint32_t limit(uint32_t value) {
+   if (value < minimumLeadTime) {
+      return minimumLeadTime;
+   }
+   return (value > maximumLeadTime) ? maximumLeadTime : value;
+}
+
+void initializeLeadTime(uint32_t minimumLeadTimeMs, uint32_t maximumLeadTimeMs) {
+   memset(&statistics, 0, sizeof(statistics));
+   minimumLeadTime       = minimumLeadTimeMs;
+   maximumLeadTime       = (maximumLeadTimeMs < minimumLeadTimeMs) ? minimumLeadTimeMs : maximumLeadTimeMs;
+   statistics.leadTimeMs = minimumLeadTime;
+}
+
+void recordBringUpDuration(uint32_t durationMs, bool successful) {
+   statistics.preparations++;
+   statistics.lastBringUpMs = durationMs;
+
+   if (!successful) {
+      statistics.failedPreparations++;
+      return;
+   }
+
+   if (durationMs > statistics.maxBringUpMs) {
+      statistics.maxBringUpMs = durationMs;
+   }
+
+   uint32_t successfulPreparations = statistics.preparations - statistics.failedPreparations;
+
+   // same smoothing as used for the retransmission timeout of TCP (RFC 6298)
+   if (successfulPreparations == 1) {
+      statistics.smoothedBringUpMs  = durationMs;
+      statistics.bringUpDeviationMs = durationMs / 2;
+   } else {
+      uint32_t difference = (durationMs > statistics.smoothedBringUpMs) ? durationMs - statistics.smoothedBringUpMs : statistics.smoothedBringUpMs - durationMs;
+      statistics.bringUpDeviationMs = ((3 * statistics.bringUpDeviationMs) + difference) / 4;
+      statistics.smoothedBringUpMs  = ((7 * statistics.smoothedBringUpMs) + durationMs) / 8;
+   }
+
+   statistics.leadTimeMs = limit(statistics.smoothedBringUpMs + (4 * statistics.bringUpDeviationMs));
+}
+
+void recordPreparationOutcome(bool readyInTime) {
+   if (readyInTime) {
+      statistics.preparedInTime++;
+   } else {
+      statistics.preparedTooLate++;
+   }
+}
+
+uint32_t getLeadTimeMs() {
+   return statistics.leadTimeMs;
+}
+
+const LEAD_TIME_STATISTICS* getLeadTimeStatistics() {
+   return &statistics;
+}
\ No newline at end of file
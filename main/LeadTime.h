@@ -0,0 +1,46 @@
+#ifndef windsensor_lead_time_h
+#define windsensor_lead_time_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+   uint32_t leadTimeMs;
+   uint32_t lastBringUpMs;
+   uint32_t smoothedBringUpMs;
+   uint32_t bringUpDeviationMs;
+   uint32_t maxBringUpMs;
+   uint32_t preparations;
+   uint32_t failedPreparations;
+   uint32_t preparedInTime;
+   uint32_t preparedTooLate;
+} LEAD_TIME_STATISTICS;
+
+/**
+ * Resets the statistics and sets the limits of the lead time. The lead time starts with the minimum.
+ **/
+void initializeLeadTime(uint32_t minimumLeadTimeMs, uint32_t maximumLeadTimeMs);
+
+/**
+ * Adds the duration it took to bring up the connection to the estimation of the lead time. Durations of failed 
+ * preparations get counted but do not influence the estimation.
+ **/
+void recordBringUpDuration(uint32_t durationMs, bool successful);
+
+/**
+ * Records whether the preparation finished before the data to send were available.
+ **/
+void recordPreparationOutcome(bool readyInTime);
+
+/**
+ * Returns how long before the data are available the preparation should start. It is the smoothed bring up duration 
+ * plus four times its mean deviation, limited to the range provided to initializeLeadTime(...).
+ **/
+uint32_t getLeadTimeMs();
+
+/**
+ * Returns the statistics of the lead time estimation.
+ **/
+const LEAD_TIME_STATISTICS* getLeadTimeStatistics();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "LiveLatency.h"
+
+#define SMOOTHING_FACTOR   8
+
+static const uint32_t BUCKET_LIMITS_MS[LIVE_LATENCY_BUCKET_COUNT - 1] = { 10000, 20000, 30000, 60000 };
+
+static LIVE_LATENCY_STATISTICS statistics;
+static bool livePending           = false;
+static bool liveDelivered         = false;
+static uint32_t liveRecordNumber;
+static uint32_t liveCompletedAtMs;
+static uint32_t deliveredCompletedAtMs;
+
+static int getBucket(uint32_t latencyMs) {
+   int bucket = 0;
+   while (bucket < LIVE_LATENCY_BUCKET_COUNT - 1 && latencyMs >= BUCKET_LIMITS_MS[bucket]) {
+      bucket++;
+   }
+   return bucket;
+}
+
+void recordLiveMessage(uint32_t recordNumber, uint32_t completedAtMs) {
+   if (livePending) {
+      statistics.superseded++;
+   }
+   livePending       = true;
+   liveRecordNumber  = recordNumber;
+   liveCompletedAtMs = completedAtMs;
+}
+
+void recordDeliveredMessages(uint32_t firstRecordNumber, int count, uint32_t nowMs) {
+   bool containsLiveMessage = livePending && count > 0 && liveRecordNumber - firstRecordNumber < (uint32_t)count;
+   if (!containsLiveMessage) {
+      return;
+   }
+
+   uint32_t latencyMs      = nowMs - liveCompletedAtMs;
+   bool first              = statistics.deliveries == 0;
+   statistics.deliveries++;
+   statistics.lastMs       = latencyMs;
+   statistics.maxMs        = (latencyMs > statistics.maxMs) ? latencyMs : statistics.maxMs;
+   statistics.smoothedMs   = first ? latencyMs : (int32_t)statistics.smoothedMs + ((int32_t)latencyMs - (int32_t)statistics.smoothedMs) / SMOOTHING_FACTOR;
+   statistics.histogram[getBucket(latencyMs)]++;
+
+   livePending             = false;
+   liveDelivered           = true;
+   deliveredCompletedAtMs  = liveCompletedAtMs;
+}
+
+uint32_t getLiveDataAgeMs(uint32_t nowMs) {
+   return liveDelivered ? nowMs - deliveredCompletedAtMs : 0;
+}
+
+const LIVE_LATENCY_STATISTICS* getLiveLatencyStatistics() {
+   return &statistics;
+}
+
+void resetLiveLatency() {
+   memset(&statistics, 0, sizeof(statistics));
+   livePending    = false;
+   liveDelivered  = false;
+}
\ No newline at end of file
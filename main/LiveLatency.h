@@ -0,0 +1,49 @@
+#ifndef windsensor_live_latency_h
+#define windsensor_live_latency_h
+
+#include <stdint.h>
+
+#define LIVE_LATENCY_BUCKET_COUNT   5
+
+/**
+ * The latency of the live data is the time from the completion of a measurement cycle till its message got delivered.
+ * The histogram counts the latencies below 10 s, 20 s, 30 s, 60 s and the longer ones.
+ **/
+typedef struct {
+   uint32_t deliveries;
+   uint32_t superseded;
+   uint32_t lastMs;
+   uint32_t smoothedMs;
+   uint32_t maxMs;
+   uint32_t histogram[LIVE_LATENCY_BUCKET_COUNT];
+} LIVE_LATENCY_STATISTICS;
+
+/**
+ * Records that the message with the provided record number contains the newest measured values. A previous live message
+ * that did not get delivered till now counts as superseded.
+ **/
+void recordLiveMessage(uint32_t recordNumber, uint32_t completedAtMs);
+
+/**
+ * Records the delivery of count messages with consecutive record numbers starting at firstRecordNumber. If they contain
+ * the live message, its latency gets added to the statistics.
+ **/
+void recordDeliveredMessages(uint32_t firstRecordNumber, int count, uint32_t nowMs);
+
+/**
+ * Returns how old the newest delivered live data are (the time since the completion of their measurement cycle) or 0 if 
+ * no live message got delivered yet.
+ **/
+uint32_t getLiveDataAgeMs(uint32_t nowMs);
+
+/**
+ * Returns the statistics since the last reset.
+ **/
+const LIVE_LATENCY_STATISTICS* getLiveLatencyStatistics();
+
+/**
+ * Clears the statistics and forgets the live message.
+ **/
+void resetLiveLatency();
+
+#endif
\ No newline at end of file
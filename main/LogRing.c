@@ -0,0 +1,192 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "LogRing.h"
+
+#define SLOT_INDEX_MASK    (LOG_RING_CAPACITY - 1)
+
+typedef struct {
+   LogTag tag;
+   LogLevel level;
+   const char *format;
+} LOG_FORMAT_DEFINITION;
+
+/*
+ * Each slot carries a sequence number that tells producers and the consumer whose turn it is (bounded queue of 
+ * D. Vyukov). A producer reserves a slot by incrementing the head with compare and swap.
+ */
+typedef struct {
+   atomic_uint sequence;
+   LOG_RECORD record;
+} LOG_SLOT;
+
+static const LOG_FORMAT_DEFINITION LOG_FORMATS[LOG_FORMAT_COUNT] = {
+   { LOG_TAG_GSM_MODULE,   LOG_LEVEL_INFO,   "out: \"%s\"" },
+   { LOG_TAG_GSM_MODULE,   LOG_LEVEL_INFO,   "in:  \"%s\"" },
+   { LOG_TAG_WIFI,         LOG_LEVEL_ERROR,  "failed to send %d bytes to %s (error 0x%x)" },
+   { LOG_TAG_MAIN,         LOG_LEVEL_INFO,   "json message length = %d" },
+   { LOG_TAG_MAIN,         LOG_LEVEL_INFO,   "total message length = %d" }
+};
+
+static const char* TAG_NAMES[LOG_TAG_COUNT] = {
+   "GSM-module",
+   "wifi",
+   "main"
+};
+
+static LOG_SLOT slots[LOG_RING_CAPACITY];
+static atomic_uint head;
+static atomic_uint droppedCount;
+static atomic_int levels[LOG_TAG_COUNT];
+static unsigned int tail      = 0;
+static bool initialized       = false;
+
+static bool isValid(LogFormat format) {
+   return format >= 0 && format < LOG_FORMAT_COUNT;
+}
+
+/*
+ * Gets invoked by the first append or take. All tasks start after the application initialized the module (see 
+ * startDeferredLogTask()), therefore the initialization does not need to be atomic.
+ */
+static void initializeIfNecessary() {
+   if (!initialized) {
+      resetLogRing();
+   }
+}
+
+bool appendLogRecord(uint32_t timestampUs, LogFormat format, const char *text, int32_t arg0, int32_t arg1, int32_t arg2) {
+   initializeIfNecessary();
+   if (!isLogFormatEnabled(format)) {
+      return false;
+   }
+
+   LOG_SLOT *slot         = NULL;
+   unsigned int position  = atomic_load_explicit(&head, memory_order_relaxed);
+   
+   while (slot == NULL) {
+      LOG_SLOT *candidate  = &slots[position & SLOT_INDEX_MASK];
+      unsigned int sequence = atomic_load_explicit(&candidate->sequence, memory_order_acquire);
+      int difference       = (int)(sequence - position);
+
+      if (difference == 0) {
+         if (atomic_compare_exchange_weak_explicit(&head, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+            slot = candidate;
+         }
+      } else if (difference < 0) {
+         atomic_fetch_add_explicit(&droppedCount, 1, memory_order_relaxed);
+         return false;
+      } else {
+         position = atomic_load_explicit(&head, memory_order_relaxed);
+      }
+   }
+
+   LOG_RECORD *record   = &slot->record;
+   record->timestampUs  = timestampUs;
+   record->format       = format;
+   record->args[0]      = arg0;
+   record->args[1]      = arg1;
+   record->args[2]      = arg2;
+   record->text[0]      = 0;
+   if (text != NULL) {
+      strncpy(record->text, text, LOG_RECORD_TEXT_LENGTH - 1);
+      record->text[LOG_RECORD_TEXT_LENGTH - 1] = 0;
+   }
+   atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+   return true;
+}
+
+bool takeLogRecord(LOG_RECORD *record) {
+   initializeIfNecessary();
+   LOG_SLOT *slot          = &slots[tail & SLOT_INDEX_MASK];
+   unsigned int sequence   = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+   if (sequence != tail + 1) {
+      return false;
+   }
+   *record = slot->record;
+   atomic_store_explicit(&slot->sequence, tail + LOG_RING_CAPACITY, memory_order_release);
+   tail++;
+   return true;
+}
+
+uint32_t getDroppedLogRecordCount() {
+   return atomic_load_explicit(&droppedCount, memory_order_relaxed);
+}
+
+int formatLogRecord(const LOG_RECORD *record, char *buffer, size_t bufferSize) {
+   if (bufferSize == 0) {
+      return 0;
+   }
+
+   const char *format   = isValid(record->format) ? LOG_FORMATS[record->format].format : "unknown format %d";
+   int32_t unknownArg[] = { record->format };
+   const int32_t *args  = isValid(record->format) ? record->args : unknownArg;
+   int argIndex         = 0;
+   size_t length        = 0;
+
+   for (const char *position = format; *position != 0 && length < bufferSize - 1; position++) {
+      char placeholder = (*position == '%') ? position[1] : 0;
+      int32_t arg      = (argIndex < LOG_RECORD_ARG_COUNT) ? args[argIndex] : 0;
+      
+      if (placeholder == 's') {
+         length += snprintf(buffer + length, bufferSize - length, "%s", record->text);
+      } else if (placeholder == 'd') {
+         length += snprintf(buffer + length, bufferSize - length, "%d", arg);
+         argIndex++;
+      } else if (placeholder == 'u') {
+         length += snprintf(buffer + length, bufferSize - length, "%u", (uint32_t)arg);
+         argIndex++;
+      } else if (placeholder == 'x') {
+         length += snprintf(buffer + length, bufferSize - length, "%x", (uint32_t)arg);
+         argIndex++;
+      } else {
+         buffer[length++] = *position;
+         buffer[length]   = 0;
+         continue;
+      }
+      position++;
+   }
+
+   length         = (length < bufferSize) ? length : bufferSize - 1;
+   buffer[length] = 0;
+   return length;
+}
+
+LogLevel getLogFormatLevel(LogFormat format) {
+   return isValid(format) ? LOG_FORMATS[format].level : LOG_LEVEL_NONE;
+}
+
+LogTag getLogFormatTag(LogFormat format) {
+   return isValid(format) ? LOG_FORMATS[format].tag : LOG_TAG_MAIN;
+}
+
+const char* getLogTagName(LogTag tag) {
+   return (tag >= 0 && tag < LOG_TAG_COUNT) ? TAG_NAMES[tag] : "unknown";
+}
+
+void setLogLevel(LogTag tag, LogLevel level) {
+   initializeIfNecessary();
+   if (tag >= 0 && tag < LOG_TAG_COUNT) {
+      atomic_store_explicit(&levels[tag], level, memory_order_relaxed);
+   }
+}
+
+bool isLogFormatEnabled(LogFormat format) {
+   initializeIfNecessary();
+   return isValid(format) && LOG_FORMATS[format].level <= atomic_load_explicit(&levels[LOG_FORMATS[format].tag], memory_order_relaxed);
+}
+
+void resetLogRing() {
+   for (unsigned int i = 0; i < LOG_RING_CAPACITY; i++) {
+      atomic_store(&slots[i].sequence, i);
+   }
+   for (int tag = 0; tag < LOG_TAG_COUNT; tag++) {
+      atomic_store(&levels[tag], LOG_LEVEL_INFO);
+   }
+   atomic_store(&head, 0);
+   atomic_store(&droppedCount, 0);
+   tail        = 0;
+   initialized = true;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef windsensor_log_ring_h
+#define windsensor_log_ring_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_RING_CAPACITY        64       // power of two
+#define LOG_RECORD_ARG_COUNT     3
+#define LOG_RECORD_TEXT_LENGTH   48
+
+/**
+ * Same values as esp_log_level_t.
+ **/
+typedef enum {
+   LOG_LEVEL_NONE,
+   LOG_LEVEL_ERROR,
+   LOG_LEVEL_WARN,
+   LOG_LEVEL_INFO,
+   LOG_LEVEL_DEBUG,
+   LOG_LEVEL_VERBOSE
+} LogLevel;
+
+typedef enum {
+   LOG_TAG_GSM_MODULE,
+   LOG_TAG_WIFI,
+   LOG_TAG_MAIN,
+   LOG_TAG_COUNT
+} LogTag;
+
+/**
+ * Each format belongs to a tag and has a level (see LOG_FORMATS in LogRing.c).
+ **/
+typedef enum {
+   LOG_FORMAT_AT_COMMAND,
+   LOG_FORMAT_AT_RESPONSE,
+   LOG_FORMAT_SEND_FAILED,
+   LOG_FORMAT_MESSAGE_LENGTH,
+   LOG_FORMAT_ENVELOPE_LENGTH,
+   LOG_FORMAT_COUNT
+} LogFormat;
+
+/**
+ * The text gets truncated to LOG_RECORD_TEXT_LENGTH - 1 characters.
+ **/
+typedef struct {
+   uint32_t timestampUs;
+   uint16_t format;
+   int32_t args[LOG_RECORD_ARG_COUNT];
+   char text[LOG_RECORD_TEXT_LENGTH];
+} LOG_RECORD;
+
+/**
+ * Appends a record to the ring without locking. Any number of tasks can append concurrently. Returns false if the 
+ * format is disabled by the level of its tag or if the ring is full (the record gets dropped and counted).
+ **/
+bool appendLogRecord(uint32_t timestampUs, LogFormat format, const char *text, int32_t arg0, int32_t arg1, int32_t arg2);
+
+/**
+ * Removes the oldest record from the ring and copies it to the provided one. Returns false if the ring is empty. Only
+ * one task may take records.
+ **/
+bool takeLogRecord(LOG_RECORD *record);
+
+/**
+ * Returns the number of records that got dropped because the ring was full.
+ **/
+uint32_t getDroppedLogRecordCount();
+
+/**
+ * Writes the message of the record into the buffer (truncated if the buffer is too small) and returns its length. The 
+ * placeholders %d, %u and %x of the format take the args in order, %s takes the text.
+ **/
+int formatLogRecord(const LOG_RECORD *record, char *buffer, size_t bufferSize);
+
+LogLevel getLogFormatLevel(LogFormat format);
+
+LogTag getLogFormatTag(LogFormat format);
+
+const char* getLogTagName(LogTag tag);
+
+/**
+ * Records with a level above the provided one get ignored. The default level of all tags is LOG_LEVEL_INFO.
+ **/
+void setLogLevel(LogTag tag, LogLevel level);
+
+/**
+ * Returns true if records of the format get appended.
+ **/
+bool isLogFormatEnabled(LogFormat format);
+
+/**
+ * Clears the ring, the dropped count and the levels. Must not be invoked concurrently with any other function.
+ **/
+void resetLogRing();
+
+#endif
\ No newline at end of file
@@ -1,8 +1,110 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+#include "AllocationStatistics.h"
+#include "Arena.h"
+#include "ErrorMessages.h"
 #include "Memory.h"
 
-void* allocate( size_t sizeInBytes ) {
-   return malloc(sizeInBytes);
+#define ARENA_SIZE_IN_BYTES CONFIG_WINDSENSOR_ARENA_SIZE
+
+static const char* TAG = "memory";
+
+static uint8_t region[ARENA_SIZE_IN_BYTES] __attribute__((aligned(ARENA_ALIGNMENT)));
+static ARENA arena;
+static bool initialized          = false;
+static bool overflowReported     = false;
+static portMUX_TYPE arenaMux     = portMUX_INITIALIZER_UNLOCKED;
+
+/*
+ * The main task and the uplink task allocate concurrently (e.g. while the connection gets prepared).
+ */
+void* allocate( size_t sizeInBytes, AllocationTag tag ) {
+   int64_t startedAtUs  = esp_timer_get_time();
+   size_t requiredBytes = sizeInBytes + ALLOCATION_HEADER_SIZE;
+
+   portENTER_CRITICAL(&arenaMux);
+   if (!initialized) {
+      initializeArena(&arena, region, ARENA_SIZE_IN_BYTES);
+      initialized = true;
+   }
+   void *storage     = allocateFromArena(&arena, requiredBytes);
+   bool reportNeeded = storage == NULL && !overflowReported;
+   overflowReported |= reportNeeded;
+   portEXIT_CRITICAL(&arenaMux);
+
+   if (storage == NULL) {
+      // falling back to the heap keeps the sensor working, the high water mark tells how big the arena should be
+      if (reportNeeded) {
+         ESP_LOGW(TAG, "arena exhausted -> allocating %u bytes on the heap", requiredBytes);
+         addErrorMessage("MEMORY_ARENA_OVERFLOW");
+      }
+      storage = malloc(requiredBytes);
+      if (storage == NULL) {
+         return NULL;
+      }
+   }
+
+   uint32_t latencyUs = esp_timer_get_time() - startedAtUs;
+   portENTER_CRITICAL(&arenaMux);
+   recordAllocation(tag, sizeInBytes, latencyUs);
+   portEXIT_CRITICAL(&arenaMux);
+   return writeAllocationHeader(storage, tag, sizeInBytes);
+}
+
+void release( void *pointer ) {
+   if (pointer == NULL) {
+      return;
+   }
+
+   AllocationTag tag;
+   size_t sizeInBytes;
+   void *storage = readAllocationHeader(pointer, &tag, &sizeInBytes);
+
+   portENTER_CRITICAL(&arenaMux);
+   recordRelease(tag, sizeInBytes);
+   bool inArena = isInArena(&arena, storage);
+   if (inArena) {
+      releaseToArena(&arena, storage);
+   }
+   portEXIT_CRITICAL(&arenaMux);
+
+   if (!inArena) {
+      free(storage);
+   }
+}
+
+bool finishAllocationCycle() {
+   portENTER_CRITICAL(&arenaMux);
+   bool reset        = resetArena(&arena);
+   overflowReported  = false;
+   uint32_t inUse    = arena.statistics.liveAllocations;
+   portEXIT_CRITICAL(&arenaMux);
+
+   if (!reset) {
+      ESP_LOGW(TAG, "%u allocation(s) still in use -> arena not reset", inUse);
+   }
+   return reset;
+}
+
+ARENA_STATISTICS getMemoryStatistics() {
+   portENTER_CRITICAL(&arenaMux);
+   ARENA_STATISTICS statistics = arena.statistics;
+   portEXIT_CRITICAL(&arenaMux);
+   return statistics;
+}
+
+HEAP_STATISTICS getHeapStatistics() {
+   HEAP_STATISTICS statistics = {
+      .freeBytes        = heap_caps_get_free_size(MALLOC_CAP_8BIT),
+      .largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+      .minimumFreeBytes = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT)
+   };
+   return statistics;
 }
\ No newline at end of file
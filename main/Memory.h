@@ -1,9 +1,37 @@
 #ifndef windsensor_memory_h
 #define windsensor_memory_h
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "AllocationStatistics.h"
+#include "Arena.h"
+
+/**
+ * Allocates size bytes of uninitialized storage. The storage gets taken from the arena of the current publish cycle 
+ * and from the heap if the arena is exhausted. The tag identifies the purpose of the allocation in the statistics.
+ **/
+void* allocate( size_t sizeInBytes, AllocationTag tag );
+
+/**
+ * Releases storage returned by allocate(...). Heap storage gets freed immediately, storage of the arena gets reused 
+ * after finishAllocationCycle().
+ **/
+void release( void *pointer );
+
+/**
+ * Makes the whole arena available for the next publish cycle. Returns false if storage of the arena is still in use.
+ **/
+bool finishAllocationCycle();
+
+/**
+ * Returns the usage of the arena.
+ **/
+ARENA_STATISTICS getMemoryStatistics();
+
 /**
- * Allocates size bytes of uninitialized storage.
+ * Returns the current state of the heap.
  **/
-void* allocate( size_t sizeInBytes );
+HEAP_STATISTICS getHeapStatistics();
 
 #endif
\ No newline at end of file
@@ -11,13 +11,24 @@
 #define MESSAGE_VERSION                "2.0.0"
 
 #define NULL_BYTE_LENGTH               1
+#define MAX_ENVELOPE_ATTACHMENTS       4
+#define RECORD_ID_TEXT_LENGTH          60
+#define RECORD_IDS_FORMAT              "\"firstRecordId\":%u,\"oldestRecordId\":%u,"
+
+typedef struct {
+   const char *name;
+   const char *json;
+} ENVELOPE_ATTACHMENT;
 
 static int nextSequenceId = 0;
+static ENVELOPE_ATTACHMENT attachments[MAX_ENVELOPE_ATTACHMENTS];
+static int attachmentCount = 0;
 
 static int getNumberOfDigits(int value);
 static int getNextSequenceId();
 static size_t countSubstrings(const char *text, const char *substring);
 static size_t lengthWithoutPlaceholders(const char *text);
+static char* createAttachmentsData();
 
 char* createJsonPayload(const uint16_t *anemometerPulses, const uint16_t *directionVaneValues, size_t measurementCount, const uint16_t secondsSincePreviousMessage) {
    char *format                          = "{\"anemometerPulses\":[%s],\"directionVaneValues\":[%s],\"secondsSincePreviousMessage\":%d}";
@@ -26,8 +37,8 @@ char* createJsonPayload(const uint16_t *anemometerPulses, const uint16_t *direct
    int separatorCount                    = (measurementCount > 0) ? measurementCount - 1 : 0;
    int maxDataLengthInDigits             = (measurementCount * maxDecimalDigitsPerValue) + separatorCount;
    int maxDataLengthInBytes              = (maxDataLengthInDigits * sizeof(char)) + NULL_BYTE_LENGTH;
-   char *anemometerData                  = allocate(maxDataLengthInBytes);
-   char *directionVaneData               = allocate(maxDataLengthInBytes);
+   char *anemometerData                  = allocate(maxDataLengthInBytes, ALLOCATION_TAG_PAYLOAD);
+   char *directionVaneData               = allocate(maxDataLengthInBytes, ALLOCATION_TAG_PAYLOAD);
    char *anemometerDataPosition          = anemometerData;
    char *directionVaneDataPosition       = directionVaneData;
 
@@ -41,16 +52,22 @@ char* createJsonPayload(const uint16_t *anemometerPulses, const uint16_t *direct
    }
    
    int maxPayloadLength = lengthWithoutPlaceholders(format) + strlen(anemometerData) + strlen(directionVaneData) + secondsSincePreviousMessageDigits;
-   char *payload = allocate((maxPayloadLength * sizeof(char)) + NULL_BYTE_LENGTH);
+   char *payload = allocate((maxPayloadLength * sizeof(char)) + NULL_BYTE_LENGTH, ALLOCATION_TAG_PAYLOAD);
    sprintf(payload, format, anemometerData, directionVaneData, secondsSincePreviousMessage);
-   free(directionVaneData);
-   free(anemometerData);
+   release(directionVaneData);
+   release(anemometerData);
    
    return payload;
 }
 
 char* createJsonEnvelope(PENDING_MESSAGES *pendingMessages) {
-   char *format                     = "{\"version\":\"%s\",\"sequenceId\":%d,\"messages\":[%s],\"errors\":[%s]}";
+   return createJsonEnvelopeForRange(pendingMessages, 0, pendingMessages->count, 0);
+}
+
+char* createJsonEnvelopeForRange(PENDING_MESSAGES *pendingMessages, int first, int count, uint32_t secondsSinceLastMessage) {
+   bool withAge                     = secondsSinceLastMessage > 0;
+   char *format                     = withAge ? "{\"version\":\"%s\",\"sequenceId\":%d,%s\"messages\":[%s],\"secondsSinceLastMessage\":%d,%s\"errors\":[%s]}"
+                                              : "{\"version\":\"%s\",\"sequenceId\":%d,%s\"messages\":[%s],%s\"errors\":[%s]}";
    int maxSequenceIdDigits          = getNumberOfDigits(MAX_MESSAGE_SEQUENCE_ID);
    const char* errors               = getErrorMessages();
    char errorSeparatorAsString[2];
@@ -60,21 +77,21 @@ char* createJsonEnvelope(PENDING_MESSAGES *pendingMessages) {
    int errorCount                   = noErrors ? 0: countSubstrings(errors, errorSeparatorAsString) + 1;
    int doubleQuotesCount            = 2 * errorCount;
    int errorsDataLengthInBytes      = (noErrors ? 0 : strlen(errors) + doubleQuotesCount) + NULL_BYTE_LENGTH;
-   char *errorsData                 = allocate(errorsDataLengthInBytes);
+   char *errorsData                 = allocate(errorsDataLengthInBytes, ALLOCATION_TAG_ENVELOPE);
    
-   int messageSeparatorCount        = (pendingMessages->count < 2) ? 0 : pendingMessages->count - 1;
+   int messageSeparatorCount        = (count < 2) ? 0 : count - 1;
    int messagesLength               = strlen("[]") + messageSeparatorCount;
 
-   for (int i = 0; i < pendingMessages->count; i++) {
+   for (int i = first; i < first + count; i++) {
       messagesLength += strlen(pendingMessages->message[i]);
    }
 
-   char *messagesData               = allocate(messagesLength * sizeof(char) + NULL_BYTE_LENGTH);
+   char *messagesData               = allocate(messagesLength * sizeof(char) + NULL_BYTE_LENGTH, ALLOCATION_TAG_ENVELOPE);
    char *messagesPosition           = messagesData;
    *messagesPosition                = 0;
 
-   for (int i = 0; i < pendingMessages->count; i++) {
-      char* separator = (i == 0) ? "" : ",";
+   for (int i = first; i < first + count; i++) {
+      char* separator = (i == first) ? "" : ",";
       char *msg = pendingMessages->message[i];
       sprintf(messagesPosition, "%s%s", separator, msg);
       messagesPosition += strlen(msg) + strlen(separator);
@@ -83,7 +100,7 @@ char* createJsonEnvelope(PENDING_MESSAGES *pendingMessages) {
    
    *errorsData = 0;
    int offset  = 0;
-   char *copyOfErrors = allocate(strlen(errors) + 1); // this copy is needed because strtok inserts null characters at the end of each token
+   char *copyOfErrors = allocate(strlen(errors) + 1, ALLOCATION_TAG_ENVELOPE); // this copy is needed because strtok inserts null characters at the end of each token
    strcpy(copyOfErrors, errors);
    
    char* token = strtok(copyOfErrors, errorSeparatorAsString);
@@ -94,23 +111,118 @@ char* createJsonEnvelope(PENDING_MESSAGES *pendingMessages) {
       offset += strlen(token) + 2 + strlen(separator);
       token = strtok(NULL, errorSeparatorAsString);
    }
-   int payloadLength = lengthWithoutPlaceholders(format) + strlen(MESSAGE_VERSION) + maxSequenceIdDigits + strlen(messagesData) + strlen(errorsData);
+   char *attachmentsData = createAttachmentsData();
+   const char *attachmentsText = (attachmentsData == NULL) ? "" : attachmentsData;
+   // the messages of an envelope got recorded one after the other -> the record id of the n-th message is firstRecordId + n
+   // the sensor never sends records older than the oldest pending one -> the service does not wait for them
+   char recordIdText[RECORD_ID_TEXT_LENGTH];
+   recordIdText[0] = 0;
+   if (count > 0) {
+      sprintf(recordIdText, RECORD_IDS_FORMAT, pendingMessages->recordNumber[first], pendingMessages->recordNumber[0]);
+   }
+   int ageDigits = withAge ? getNumberOfDigits(secondsSinceLastMessage) : 0;
+   int payloadLength = lengthWithoutPlaceholders(format) + strlen(MESSAGE_VERSION) + maxSequenceIdDigits + strlen(recordIdText) + strlen(messagesData) + ageDigits + strlen(attachmentsText) + strlen(errorsData);
    int payloadSizeInBytes = (payloadLength * sizeof(char)) + NULL_BYTE_LENGTH;
-   char *payload = allocate(payloadSizeInBytes);
-   sprintf(payload, format, MESSAGE_VERSION, getNextSequenceId(), messagesData, errorsData);
-   free(copyOfErrors);
-   free(messagesData);
-   free(errorsData);
+   char *payload = allocate(payloadSizeInBytes, ALLOCATION_TAG_ENVELOPE);
+   if (withAge) {
+      sprintf(payload, format, MESSAGE_VERSION, getNextSequenceId(), recordIdText, messagesData, secondsSinceLastMessage, attachmentsText, errorsData);
+   } else {
+      sprintf(payload, format, MESSAGE_VERSION, getNextSequenceId(), recordIdText, messagesData, attachmentsText, errorsData);
+   }
+   release(attachmentsData);
+   release(copyOfErrors);
+   release(messagesData);
+   release(errorsData);
    
    return payload;
 }
 
+size_t getJsonEnvelopeLength(const PENDING_MESSAGES *pendingMessages, int first, int count, uint32_t secondsSinceLastMessage) {
+   bool withAge           = secondsSinceLastMessage > 0;
+   char *format           = withAge ? "{\"version\":\"%s\",\"sequenceId\":%d,%s\"messages\":[%s],\"secondsSinceLastMessage\":%d,%s\"errors\":[%s]}"
+                                    : "{\"version\":\"%s\",\"sequenceId\":%d,%s\"messages\":[%s],%s\"errors\":[%s]}";
+   const char* errors     = getErrorMessages();
+   char errorSeparatorAsString[2];
+   errorSeparatorAsString[0] = getErrorMessageSeparator();
+   errorSeparatorAsString[1] = 0;
+   bool noErrors          = strlen(errors) == 0;
+   int errorCount         = noErrors ? 0 : countSubstrings(errors, errorSeparatorAsString) + 1;
+
+   // each error gets quoted and the separators get replaced by commas
+   size_t length = lengthWithoutPlaceholders(format) + strlen(MESSAGE_VERSION) + getNumberOfDigits(peekNextSequenceId());
+   length       += noErrors ? 0 : strlen(errors) + (2 * errorCount);
+   length       += withAge ? getNumberOfDigits(secondsSinceLastMessage) : 0;
+
+   if (count > 0) {
+      char recordIdText[RECORD_ID_TEXT_LENGTH];
+      length += sprintf(recordIdText, RECORD_IDS_FORMAT, pendingMessages->recordNumber[first], pendingMessages->recordNumber[0]);
+      length += count - 1;
+   }
+   for (int i = first; i < first + count; i++) {
+      length += strlen(pendingMessages->message[i]);
+   }
+   for (int i = 0; i < attachmentCount; i++) {
+      length += strlen("\"\":,") + strlen(attachments[i].name) + strlen(attachments[i].json);
+   }
+
+   return length;
+}
+
 static int getNextSequenceId() {
    int result = nextSequenceId;
    nextSequenceId = (nextSequenceId + 1) % (MAX_MESSAGE_SEQUENCE_ID + 1);
    return result;
 }
 
+int peekNextSequenceId() {
+   return nextSequenceId;
+}
+
+void setNextSequenceId(int sequenceId) {
+   nextSequenceId = (sequenceId >= 0 && sequenceId <= MAX_MESSAGE_SEQUENCE_ID) ? sequenceId : 0;
+}
+
+void setEnvelopeAttachment(const char *name, const char *json) {
+   int index = 0;
+   while (index < attachmentCount && strcmp(attachments[index].name, name) != 0) {
+      index++;
+   }
+
+   if (json == NULL) {
+      if (index < attachmentCount) {
+         attachmentCount--;
+         memmove(&attachments[index], &attachments[index + 1], (attachmentCount - index) * sizeof(ENVELOPE_ATTACHMENT));
+      }
+   } else if (index < MAX_ENVELOPE_ATTACHMENTS) {
+      attachments[index].name = name;
+      attachments[index].json = json;
+      if (index == attachmentCount) {
+         attachmentCount++;
+      }
+   }
+}
+
+/*
+ * Returns the attachments as properties followed by a comma (e.g. "memory":{...},) or NULL if there are none.
+ */
+static char* createAttachmentsData() {
+   if (attachmentCount == 0) {
+      return NULL;
+   }
+
+   size_t length = 0;
+   for (int i = 0; i < attachmentCount; i++) {
+      length += strlen("\"\":,") + strlen(attachments[i].name) + strlen(attachments[i].json);
+   }
+
+   char *attachmentsData = allocate(length + NULL_BYTE_LENGTH, ALLOCATION_TAG_ENVELOPE);
+   char *position        = attachmentsData;
+   for (int i = 0; i < attachmentCount; i++) {
+      position += sprintf(position, "\"%s\":%s,", attachments[i].name, attachments[i].json);
+   }
+   return attachmentsData;
+}
+
 static size_t countSubstrings(const char *text, const char *substring) {
    size_t count = 0;
    const char *position = text;
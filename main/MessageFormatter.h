@@ -9,14 +9,47 @@
 /**
  * Creates a JSON message containing the provided measurements. 
  *
- * The caller has to free the returned pointer!!!
+ * The caller has to release the returned pointer (see Memory.h)!!!
  **/
 char* createJsonPayload(const uint16_t *anemometerPulses, const uint16_t *directionVaneValues, size_t measurementCount, const uint16_t secondsSincePreviousMessage);
 
 /**
  * Creates a JSON message containing the pending messages and some meta data (e.g. version, sequence number, ...)
  *
- * The caller has to free the returned pointer!!!
+ * The caller has to release the returned pointer (see Memory.h)!!!
  **/
 char* createJsonEnvelope(PENDING_MESSAGES *pendingMessages);
+
+/**
+ * Same as createJsonEnvelope(...) but it contains only count pending messages starting at index first. If 
+ * secondsSinceLastMessage is greater than 0, the envelope tells the receiver how long ago the last message was recorded
+ * (needed when it is not the newest one).
+ *
+ * The caller has to release the returned pointer (see Memory.h)!!!
+ **/
+char* createJsonEnvelopeForRange(PENDING_MESSAGES *pendingMessages, int first, int count, uint32_t secondsSinceLastMessage);
+
+/**
+ * Returns the length (without the terminating null byte) of the envelope createJsonEnvelopeForRange(...) would create 
+ * now with the same arguments, including the current error messages and attachments. Nothing gets allocated.
+ **/
+size_t getJsonEnvelopeLength(const PENDING_MESSAGES *pendingMessages, int first, int count, uint32_t secondsSinceLastMessage);
+
+/**
+ * Returns the sequence ID the next envelope will get.
+ **/
+int peekNextSequenceId();
+
+/**
+ * Sets the sequence ID of the next envelope (e.g. to continue the sequence after a deep sleep). IDs out of range get
+ * replaced by 0.
+ **/
+void setNextSequenceId(int sequenceId);
+
+/**
+ * Adds the provided JSON value as property with the provided name to the subsequent envelopes (in front of the errors). 
+ * An attachment with the same name gets replaced and NULL removes it. Both strings must stay valid till the attachment 
+ * gets removed.
+ **/
+void setEnvelopeAttachment(const char *name, const char *json);
 #endif
\ No newline at end of file
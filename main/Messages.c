@@ -9,9 +9,14 @@ static void clear(PENDING_MESSAGES *pendingMessages, bool freeMemory);
 
 void initializePendingMessages(PENDING_MESSAGES *pendingMessages) {
    clear(pendingMessages, false);
+   pendingMessages->nextRecordNumber = 0;
 }
 
 void addToPendingMessages(PENDING_MESSAGES *pendingMessages, const char* messageToAdd) {
+   addToPendingMessagesWithTime(pendingMessages, messageToAdd, 0);
+}
+
+void addToPendingMessagesWithTime(PENDING_MESSAGES *pendingMessages, const char* messageToAdd, time_t recordedAt) {
    if (pendingMessages->count >= MAX_NUMBER_OF_MESSAGES_TO_KEEP) {
       removeOldestMessage(pendingMessages);
    }
@@ -19,7 +24,9 @@ void addToPendingMessages(PENDING_MESSAGES *pendingMessages, const char* message
    char *copyOfMessageToAdd = malloc(strlen(messageToAdd) * sizeof(char) + 1);
    strcpy(copyOfMessageToAdd, messageToAdd); 
     
-   pendingMessages->message[pendingMessages->count] = copyOfMessageToAdd;
+   pendingMessages->message[pendingMessages->count]      = copyOfMessageToAdd;
+   pendingMessages->recordedAt[pendingMessages->count]   = recordedAt;
+   pendingMessages->recordNumber[pendingMessages->count] = pendingMessages->nextRecordNumber++;
    pendingMessages->count++;
 }
 
@@ -27,6 +34,40 @@ void clearPendingMessages(PENDING_MESSAGES *pendingMessages) {
    clear(pendingMessages, true);
 }
 
+void removePendingMessages(PENDING_MESSAGES *pendingMessages, int first, int count) {
+   if (first < 0 || count <= 0 || first >= pendingMessages->count) {
+      return;
+   }
+   if (first + count > pendingMessages->count) {
+      count = pendingMessages->count - first;
+   }
+
+   for (int i = first; i < first + count; i++) {
+      free(pendingMessages->message[i]);
+   }
+
+   for (int i = first; i < pendingMessages->count; i++) {
+      int source = i + count;
+      bool sourceExists = source < pendingMessages->count;
+      pendingMessages->message[i]      = sourceExists ? pendingMessages->message[source] : NULL;
+      pendingMessages->recordedAt[i]   = sourceExists ? pendingMessages->recordedAt[source] : 0;
+      pendingMessages->recordNumber[i] = sourceExists ? pendingMessages->recordNumber[source] : 0;
+   }
+   pendingMessages->count -= count;
+}
+
+int getContiguousMessageCount(const PENDING_MESSAGES *pendingMessages, int first) {
+   if (first < 0 || first >= pendingMessages->count) {
+      return 0;
+   }
+
+   int count = 1;
+   while ((first + count) < pendingMessages->count && pendingMessages->recordNumber[first + count] == pendingMessages->recordNumber[first + count - 1] + 1) {
+      count++;
+   }
+   return count;
+}
+
 static void clear(PENDING_MESSAGES *pendingMessages, bool freeMemory) {
    for (int i = 0; i < MAX_NUMBER_OF_MESSAGES_TO_KEEP; i++) {
       if (pendingMessages->message[i] != NULL) {
@@ -35,16 +76,12 @@ static void clear(PENDING_MESSAGES *pendingMessages, bool freeMemory) {
          }
          pendingMessages->message[i] = NULL;
       }
+      pendingMessages->recordedAt[i]   = 0;
+      pendingMessages->recordNumber[i] = 0;
    }
    pendingMessages->count = 0;
 }
 
 static void removeOldestMessage(PENDING_MESSAGES *pendingMessages) {
-   if (pendingMessages->count > 0) {
-      free(pendingMessages->message[0]);
-      for(int i = 0; i < pendingMessages->count; i++) {
-         pendingMessages->message[i] = (i == (pendingMessages->count - 1)) ? NULL : pendingMessages->message[i + 1];
-      }
-      pendingMessages->count--;
-   }
+   removePendingMessages(pendingMessages, 0, 1);
 }
\ No newline at end of file
@@ -1,11 +1,17 @@
 #ifndef windsensor_messages_h
 #define windsensor_messages_h
 
+#include <stdint.h>
+#include <time.h>
+
 #define MAX_NUMBER_OF_MESSAGES_TO_KEEP 5
 
 typedef struct {
    int count;
    char *message[MAX_NUMBER_OF_MESSAGES_TO_KEEP];
+   time_t recordedAt[MAX_NUMBER_OF_MESSAGES_TO_KEEP];
+   uint32_t recordNumber[MAX_NUMBER_OF_MESSAGES_TO_KEEP];
+   uint32_t nextRecordNumber;
 } PENDING_MESSAGES;
 
 /**
@@ -18,9 +24,26 @@ void initializePendingMessages(PENDING_MESSAGES *pendingMessages);
  **/
 void addToPendingMessages(PENDING_MESSAGES *pendingMessages, const char* messageToAdd);
 
+/**
+ * Same as addToPendingMessages(...) but also stores the time the message got recorded. Each added message gets the next 
+ * record number.
+ **/
+void addToPendingMessagesWithTime(PENDING_MESSAGES *pendingMessages, const char* messageToAdd, time_t recordedAt);
+
 /**
  * Frees the memory occupied by the messages, sets their pointers to NULL and sets count to 0.
  **/
 void clearPendingMessages(PENDING_MESSAGES *pendingMessages);
 
+/**
+ * Frees and removes count messages starting at index first. The following messages move forward.
+ **/
+void removePendingMessages(PENDING_MESSAGES *pendingMessages, int first, int count);
+
+/**
+ * Returns the number of messages starting at index first that got recorded directly one after the other (consecutive
+ * record numbers). Such messages can get delivered together because their secondsSincePreviousMessage refer to each other.
+ **/
+int getContiguousMessageCount(const PENDING_MESSAGES *pendingMessages, int first);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <stdint.h>
+
+#include "esp_log.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include "NonVolatileStorage.h"
+
+#define NAMESPACE                      "windsensor"
+
+static const char* TAG = "nvs";
+static bool initialized = false;
+
+void initializeNonVolatileStorage() {
+   if (initialized) {
+      return;
+   }
+
+   ESP_LOGI(TAG, "initializing non-volatile storage");
+   esp_err_t ret = nvs_flash_init();
+   if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+      ESP_ERROR_CHECK(nvs_flash_erase());
+      ret = nvs_flash_init();
+   }
+   ESP_ERROR_CHECK(ret);
+   initialized = true;
+}
+
+bool readStoredFlag(const char *key) {
+   nvs_handle_t handle;
+   uint8_t value = 0;
+
+   initializeNonVolatileStorage();
+   if (nvs_open(NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+      // the namespace does not exist before the first write
+      return false;
+   }
+   nvs_get_u8(handle, key, &value);
+   nvs_close(handle);
+   return value != 0;
+}
+
+void storeFlag(const char *key, bool value) {
+   nvs_handle_t handle;
+
+   initializeNonVolatileStorage();
+   if (nvs_open(NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+      ESP_LOGE(TAG, "failed to open namespace %s", NAMESPACE);
+      return;
+   }
+   esp_err_t result = value ? nvs_set_u8(handle, key, 1) : nvs_erase_key(handle, key);
+   if (result == ESP_OK) {
+      result = nvs_commit(handle);
+   }
+   if (result != ESP_OK && !(result == ESP_ERR_NVS_NOT_FOUND && !value)) {
+      ESP_LOGE(TAG, "failed to store %s (%s)", key, esp_err_to_name(result));
+   }
+   nvs_close(handle);
+}
+
+uint32_t readStoredNumber(const char *key, uint32_t defaultValue) {
+   nvs_handle_t handle;
+   uint32_t value = defaultValue;
+
+   initializeNonVolatileStorage();
+   if (nvs_open(NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+      return defaultValue;
+   }
+   if (nvs_get_u32(handle, key, &value) != ESP_OK) {
+      value = defaultValue;
+   }
+   nvs_close(handle);
+   return value;
+}
+
+bool storeNumber(const char *key, uint32_t value) {
+   nvs_handle_t handle;
+
+   initializeNonVolatileStorage();
+   if (nvs_open(NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+      ESP_LOGE(TAG, "failed to open namespace %s", NAMESPACE);
+      return false;
+   }
+   esp_err_t result = nvs_set_u32(handle, key, value);
+   if (result == ESP_OK) {
+      result = nvs_commit(handle);
+   }
+   if (result != ESP_OK) {
+      ESP_LOGE(TAG, "failed to store %s (%s)", key, esp_err_to_name(result));
+   }
+   nvs_close(handle);
+   return result == ESP_OK;
+}
\ No newline at end of file
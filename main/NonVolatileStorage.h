@@ -0,0 +1,33 @@
+#ifndef windsensor_non_volatile_storage_h
+#define windsensor_non_volatile_storage_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Initializes the NVS partition (it gets erased if it is full or has an incompatible version). Calling it more than 
+ * once has no effect.
+ **/
+void initializeNonVolatileStorage();
+
+/**
+ * Returns the stored flag or false if it does not exist.
+ **/
+bool readStoredFlag(const char *key);
+
+/**
+ * Stores the flag. Storing false removes it.
+ **/
+void storeFlag(const char *key, bool value);
+
+/**
+ * Returns the stored number or defaultValue if it does not exist.
+ **/
+uint32_t readStoredNumber(const char *key, uint32_t defaultValue);
+
+/**
+ * Stores the number. Returns false if it could not get stored.
+ **/
+bool storeNumber(const char *key, uint32_t value);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "PhaseTimings.h"
+
+static const char* PHASE_NAMES[PHASE_COUNT] = {
+   "queued",
+   "modemWakeUp",
+   "modemActivation",
+   "networkRegistration",
+   "connectionSetup",
+   "requestTransfer",
+   "responseWait",
+   "teardown",
+   "recovery",
+   "waitingForData"
+};
+
+static PHASE_STATISTICS statistics[PHASE_COUNT];
+static uint32_t currentDurations[PHASE_COUNT];
+static bool currentPhaseOccurred[PHASE_COUNT];
+static int currentPhase             = -1;
+static uint32_t currentPhaseStart   = 0;
+static uint32_t publishStart        = 0;
+static uint32_t lastPublishDuration = 0;
+
+static void endCurrentPhase(uint32_t nowMs) {
+   if (currentPhase >= 0) {
+      currentDurations[currentPhase]     += nowMs - currentPhaseStart;
+      currentPhaseOccurred[currentPhase]  = true;
+   }
+   currentPhase = -1;
+}
+
+void startPublishPhases(uint32_t nowMs) {
+   for (int i = 0; i < PHASE_COUNT; i++) {
+      currentDurations[i]     = 0;
+      currentPhaseOccurred[i] = false;
+   }
+   currentPhase = -1;
+   publishStart = nowMs;
+}
+
+void enterPublishPhase(PublishPhase phase, uint32_t nowMs) {
+   endCurrentPhase(nowMs);
+   currentPhase      = phase;
+   currentPhaseStart = nowMs;
+}
+
+void finishPublishPhases(uint32_t nowMs) {
+   endCurrentPhase(nowMs);
+
+   for (int i = 0; i < PHASE_COUNT; i++) {
+      statistics[i].lastDurationMs = currentDurations[i];
+      if (currentPhaseOccurred[i]) {
+         statistics[i].totalDurationMs += currentDurations[i];
+         statistics[i].count++;
+         if (currentDurations[i] > statistics[i].maxDurationMs) {
+            statistics[i].maxDurationMs = currentDurations[i];
+         }
+      }
+   }
+
+   lastPublishDuration = nowMs - publishStart;
+}
+
+const PHASE_STATISTICS* getPublishPhaseStatistics(PublishPhase phase) {
+   return &statistics[phase];
+}
+
+uint32_t getLastPublishDurationMs() {
+   return lastPublishDuration;
+}
+
+const char* getPublishPhaseName(PublishPhase phase) {
+   return (phase >= 0 && phase < PHASE_COUNT) ? PHASE_NAMES[phase] : "unknown";
+}
+
+void resetPublishPhaseStatistics() {
+   memset(statistics, 0, sizeof(statistics));
+   startPublishPhases(0);
+   lastPublishDuration = 0;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef windsensor_phase_timings_h
+#define windsensor_phase_timings_h
+
+#include <stdint.h>
+
+typedef enum {
+   PHASE_QUEUED,
+   PHASE_MODEM_WAKE_UP,
+   PHASE_MODEM_ACTIVATION,
+   PHASE_NETWORK_REGISTRATION,
+   PHASE_CONNECTION_SETUP,
+   PHASE_REQUEST_TRANSFER,
+   PHASE_RESPONSE_WAIT,
+   PHASE_TEARDOWN,
+   PHASE_RECOVERY,
+   PHASE_WAITING_FOR_DATA,
+   PHASE_COUNT
+} PublishPhase;
+
+typedef struct {
+   uint32_t lastDurationMs;
+   uint32_t maxDurationMs;
+   uint32_t totalDurationMs;
+   uint32_t count;
+} PHASE_STATISTICS;
+
+/**
+ * Starts the time accounting of a new publishment. The durations of the previous publishment get reset.
+ **/
+void startPublishPhases(uint32_t nowMs);
+
+/**
+ * Ends the currently active phase (if there is one) and starts the provided phase. Entering the same phase twice
+ * within a publishment accumulates its duration.
+ **/
+void enterPublishPhase(PublishPhase phase, uint32_t nowMs);
+
+/**
+ * Ends the currently active phase and adds the durations of the publishment to the statistics.
+ **/
+void finishPublishPhases(uint32_t nowMs);
+
+/**
+ * Returns the statistics of the provided phase. lastDurationMs refers to the last finished publishment and is 0 if the
+ * phase did not occur in it.
+ **/
+const PHASE_STATISTICS* getPublishPhaseStatistics(PublishPhase phase);
+
+/**
+ * Returns the total duration of the last finished publishment.
+ **/
+uint32_t getLastPublishDurationMs();
+
+/**
+ * Returns a human readable name of the phase.
+ **/
+const char* getPublishPhaseName(PublishPhase phase);
+
+/**
+ * Resets all statistics.
+ **/
+void resetPublishPhaseStatistics();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+#include "DutyCycle.h"
+#include "PowerManagement.h"
+
+#ifdef CONFIG_WINDSENSOR_POWER_MANAGEMENT
+#define LOCKS_PER_POWER_LOCK        2
+#endif
+
+static const char* TAG = "power";
+static portMUX_TYPE dutyCycleMux = portMUX_INITIALIZER_UNLOCKED;
+static const DutyState DUTY_STATES[POWER_LOCK_COUNT] = { DUTY_STATE_SAMPLING, DUTY_STATE_UPLINK };
+
+#ifdef CONFIG_WINDSENSOR_POWER_MANAGEMENT
+static esp_pm_lock_handle_t locks[POWER_LOCK_COUNT][LOCKS_PER_POWER_LOCK];
+#endif
+
+static uint32_t millis() {
+   // esp_timer keeps counting during light sleep
+   return esp_timer_get_time() / 1000;
+}
+
+#ifdef CONFIG_WINDSENSOR_POWER_MANAGEMENT
+static void createLock(PowerLock lock, int index, esp_pm_lock_type_t type, const char *name) {
+   if (esp_pm_lock_create(type, 0, name, &locks[lock][index]) != ESP_OK) {
+      ESP_LOGE(TAG, "failed to create lock %s", name);
+      locks[lock][index] = NULL;
+   }
+}
+#endif
+
+void initializePowerManagement() {
+   resetDutyCycle(millis());
+
+#ifdef CONFIG_WINDSENSOR_POWER_MANAGEMENT
+   createLock(POWER_LOCK_SAMPLING, 0, ESP_PM_APB_FREQ_MAX, "sampling");
+   createLock(POWER_LOCK_SAMPLING, 1, ESP_PM_NO_LIGHT_SLEEP, "samplingAwake");
+   createLock(POWER_LOCK_UPLINK, 0, ESP_PM_CPU_FREQ_MAX, "uplink");
+   createLock(POWER_LOCK_UPLINK, 1, ESP_PM_NO_LIGHT_SLEEP, "uplinkAwake");
+
+   esp_pm_config_esp32_t config = {
+      .max_freq_mhz        = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+      .min_freq_mhz        = CONFIG_WINDSENSOR_MIN_CPU_FREQ_MHZ,
+      .light_sleep_enable  = isLightSleepEnabled()
+   };
+
+   ESP_LOGI(TAG, "frequency scaling %d - %d MHz, light sleep %s", config.min_freq_mhz, config.max_freq_mhz, config.light_sleep_enable ? "enabled" : "disabled");
+   if (esp_pm_configure(&config) != ESP_OK) {
+      ESP_LOGE(TAG, "failed to configure power management");
+   }
+#endif
+}
+
+void acquirePowerLock(PowerLock lock) {
+#ifdef CONFIG_WINDSENSOR_POWER_MANAGEMENT
+   for (int i = 0; i < LOCKS_PER_POWER_LOCK; i++) {
+      if (locks[lock][i] != NULL) {
+         esp_pm_lock_acquire(locks[lock][i]);
+      }
+   }
+#endif
+   portENTER_CRITICAL(&dutyCycleMux);
+   enterDutyState(DUTY_STATES[lock], millis());
+   portEXIT_CRITICAL(&dutyCycleMux);
+}
+
+void releasePowerLock(PowerLock lock) {
+   portENTER_CRITICAL(&dutyCycleMux);
+   leaveDutyState(DUTY_STATES[lock], millis());
+   portEXIT_CRITICAL(&dutyCycleMux);
+#ifdef CONFIG_WINDSENSOR_POWER_MANAGEMENT
+   for (int i = LOCKS_PER_POWER_LOCK - 1; i >= 0; i--) {
+      if (locks[lock][i] != NULL) {
+         esp_pm_lock_release(locks[lock][i]);
+      }
+   }
+#endif
+}
+
+bool isLightSleepEnabled() {
+#ifdef CONFIG_WINDSENSOR_LIGHT_SLEEP
+   return true;
+#else
+   return false;
+#endif
+}
+
+void logPowerStatistics() {
+   DUTY_CYCLE_REPORT report;
+   uint32_t perMille[DUTY_STATE_COUNT];
+   uint32_t nowMs = millis();
+
+   portENTER_CRITICAL(&dutyCycleMux);
+   report = *getDutyCycleReport(nowMs);
+   for (int state = 0; state < DUTY_STATE_COUNT; state++) {
+      perMille[state] = getDutyStatePerMille(state, nowMs);
+   }
+   resetDutyCycle(nowMs);
+   portEXIT_CRITICAL(&dutyCycleMux);
+
+   ESP_LOGI(TAG, "duty cycle of the last %u ms%s:", report.totalMs, isLightSleepEnabled() ? " (light sleep while idle)" : "");
+   for (int state = 0; state < DUTY_STATE_COUNT; state++) {
+      ESP_LOGI(TAG, "   %-10s %6u ms (%u per mille)", getDutyStateName(state), report.durationMs[state], perMille[state]);
+   }
+
+#ifdef CONFIG_PM_PROFILING
+   // time spent in each power management mode (including light sleep) and the time each lock was held
+   esp_pm_dump_locks(stdout);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef windsensor_power_management_h
+#define windsensor_power_management_h
+
+#include <stdbool.h>
+
+typedef enum {
+   POWER_LOCK_SAMPLING,       // keeps the APB frequency stable for the ADC
+   POWER_LOCK_UPLINK,         // maximum CPU frequency and no light sleep (UART and radio)
+   POWER_LOCK_COUNT
+} PowerLock;
+
+/**
+ * Configures dynamic frequency scaling and automatic light sleep (if enabled in the configuration) and creates the 
+ * locks. Call it before any other function of this module.
+ **/
+void initializePowerManagement();
+
+/**
+ * Acquires the lock and accounts the time till the release to the corresponding state (see DutyCycle.h). Locks may get
+ * acquired several times and from different tasks.
+ **/
+void acquirePowerLock(PowerLock lock);
+
+/**
+ * Releases the lock.
+ **/
+void releasePowerLock(PowerLock lock);
+
+/**
+ * Returns true if the chip enters light sleep automatically while no lock is held.
+ **/
+bool isLightSleepEnabled();
+
+/**
+ * Logs the time spent in each state since the last invocation and starts a new report.
+ **/
+void logPowerStatistics();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include "LatencyHistograms.h"
+#include "PhaseTimings.h"
+#include "Profiling.h"
+
+#define MAX_PROFILED_TASKS    16
+#define US_PER_MS             1000
+
+static const char* TAG = "profiling";
+
+#ifdef CONFIG_WINDSENSOR_PROFILING
+static portMUX_TYPE histogramsMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t previousTasks[MAX_PROFILED_TASKS];
+static uint32_t previousRunTimes[MAX_PROFILED_TASKS];
+static int previousTaskCount        = 0;
+static uint32_t previousTotalRunTime = 0;
+#endif
+
+bool isProfilingEnabled() {
+#ifdef CONFIG_WINDSENSOR_PROFILING
+   return true;
+#else
+   return false;
+#endif
+}
+
+void profileDuration(ProfiledValue value, uint32_t durationUs) {
+#ifdef CONFIG_WINDSENSOR_PROFILING
+   portENTER_CRITICAL(&histogramsMux);
+   recordDuration(value, durationUs);
+   portEXIT_CRITICAL(&histogramsMux);
+#endif
+}
+
+void profilePublishPhases() {
+   for (int phase = 0; phase < PHASE_COUNT; phase++) {
+      uint32_t durationMs = getPublishPhaseStatistics(phase)->lastDurationMs;
+      if (durationMs > 0) {
+         profileDuration(PROFILED_FIRST_PHASE + phase, durationMs * US_PER_MS);
+      }
+   }
+}
+
+#ifdef CONFIG_WINDSENSOR_PROFILING
+static uint32_t getPreviousRunTime(TaskHandle_t task) {
+   for (int i = 0; i < previousTaskCount; i++) {
+      if (previousTasks[i] == task) {
+         return previousRunTimes[i];
+      }
+   }
+   return 0;
+}
+
+/*
+ * The run time counters of the tasks sum up the time on both cores, therefore 100 % stands for both cores being busy.
+ */
+static void logCpuUsage() {
+   TaskStatus_t tasks[MAX_PROFILED_TASKS];
+   uint32_t totalRunTime;
+   UBaseType_t taskCount = uxTaskGetSystemState(tasks, MAX_PROFILED_TASKS, &totalRunTime);
+
+   if (taskCount == 0) {
+      ESP_LOGW(TAG, "more than %d tasks -> CPU usage not available", MAX_PROFILED_TASKS);
+      return;
+   }
+
+   uint64_t elapsed = (uint64_t)(totalRunTime - previousTotalRunTime) * portNUM_PROCESSORS;
+   ESP_LOGI(TAG, "CPU usage of %u task(s):", taskCount);
+   for (int i = 0; i < taskCount; i++) {
+      uint32_t runTime     = tasks[i].ulRunTimeCounter - getPreviousRunTime(tasks[i].xHandle);
+      uint32_t perMille    = (elapsed == 0) ? 0 : (runTime * 1000ULL) / elapsed;
+      ESP_LOGI(TAG, "   %-28s %3u.%u %% (stack high water mark %u bytes)", tasks[i].pcTaskName, perMille / 10, perMille % 10, 
+         tasks[i].usStackHighWaterMark);
+      previousTasks[i]    = tasks[i].xHandle;
+      previousRunTimes[i] = tasks[i].ulRunTimeCounter;
+   }
+   previousTaskCount    = taskCount;
+   previousTotalRunTime = totalRunTime;
+}
+#endif
+
+void logProfile() {
+#ifdef CONFIG_WINDSENSOR_PROFILING
+   logCpuUsage();
+
+   HISTOGRAM histograms[PROFILED_VALUE_COUNT];
+   portENTER_CRITICAL(&histogramsMux);
+   for (int value = 0; value < PROFILED_VALUE_COUNT; value++) {
+      mergeHistograms(value, &histograms[value]);
+   }
+   rotateHistogramWindow();
+   portEXIT_CRITICAL(&histogramsMux);
+
+   ESP_LOGI(TAG, "durations of the last %d windows in us:", HISTOGRAM_WINDOW_COUNT);
+   for (int value = 0; value < PROFILED_VALUE_COUNT; value++) {
+      const HISTOGRAM *histogram = &histograms[value];
+      if (histogram->count > 0) {
+         ESP_LOGI(TAG, "   %-12s count %6u, median %8u, 90%% %8u, 99%% %8u, max %8u", getProfiledValueName(value), histogram->count, 
+            getPercentileUs(histogram, 50), getPercentileUs(histogram, 90), getPercentileUs(histogram, 99), histogram->maxUs);
+      }
+   }
+#endif
+}
+
+int formatProfile(char *buffer, size_t bufferSize) {
+#ifdef CONFIG_WINDSENSOR_PROFILING
+   portENTER_CRITICAL(&histogramsMux);
+   int length = formatHistograms(buffer, bufferSize);
+   portEXIT_CRITICAL(&histogramsMux);
+   return length;
+#else
+   return -1;
+#endif
+}
\ No newline at end of file
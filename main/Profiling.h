@@ -0,0 +1,38 @@
+#ifndef windsensor_profiling_h
+#define windsensor_profiling_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "LatencyHistograms.h"
+
+/**
+ * Returns true if the firmware got built with profiling (CONFIG_WINDSENSOR_PROFILING). Without it all other functions
+ * of this module do nothing.
+ **/
+bool isProfilingEnabled();
+
+/**
+ * Adds the duration to the histogram of the value. Can be used by any task.
+ **/
+void profileDuration(ProfiledValue value, uint32_t durationUs);
+
+/**
+ * Adds the durations of the phases of the last publishment (see PhaseTimings.h) to their histograms.
+ **/
+void profilePublishPhases();
+
+/**
+ * Logs the CPU usage of each task since the previous invocation and the histograms of all windows. Afterwards a new 
+ * window starts.
+ **/
+void logProfile();
+
+/**
+ * Writes the histograms as compact JSON object into the buffer (see formatHistograms(...)) and returns the number of
+ * characters written or -1 if profiling is disabled or the buffer is too small.
+ **/
+int formatProfile(char *buffer, size_t bufferSize);
+
+#endif
\ No newline at end of file
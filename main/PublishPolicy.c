@@ -0,0 +1,88 @@
+#include <string.h>
+
+#include "PublishPolicy.h"
+
+#define OK_RESPONSE                    200
+
+MESSAGE_RANGE selectMessagesToPublish(const PENDING_MESSAGES *pendingMessages, bool goodSignal) {
+   MESSAGE_RANGE range = { 0, 0 };
+
+   if (pendingMessages->count == 0) {
+      return range;
+   }
+
+   if (goodSignal) {
+      range.first = 0;
+      range.count = getContiguousMessageCount(pendingMessages, 0);
+   } else {
+      range.first = pendingMessages->count - 1;
+      range.count = 1;
+   }
+
+   return range;
+}
+
+MESSAGE_RANGE selectLiveMessagesToPublish(const PENDING_MESSAGES *pendingMessages, bool goodSignal, PublishOrder order) {
+   bool newestOnly = !goodSignal || order == PUBLISH_ORDER_NEWEST_FIRST;
+   return selectMessagesToPublish(pendingMessages, !newestOnly);
+}
+
+MESSAGE_RANGE selectBacklogToDrain(const PENDING_MESSAGES *pendingMessages, int first, size_t budgetInBytes) {
+   MESSAGE_RANGE range = { first, 0 };
+
+   if (first < 0 || first >= pendingMessages->count) {
+      return range;
+   }
+
+   int contiguousCount = getContiguousMessageCount(pendingMessages, first);
+   size_t usedBytes    = 0;
+
+   for (int i = first; i < first + contiguousCount; i++) {
+      size_t separatorBytes = (i == first) ? 0 : 1;
+      size_t messageBytes   = strlen(pendingMessages->message[i]) + separatorBytes;
+      if (range.count > 0 && usedBytes + messageBytes > budgetInBytes) {
+         break;
+      }
+      usedBytes += messageBytes;
+      range.count++;
+   }
+
+   return range;
+}
+
+bool isAcknowledgementInRange(const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE range, uint32_t acknowledgedRecordId) {
+   if (range.count <= 0 || range.first < 0 || range.first + range.count > pendingMessages->count) {
+      return false;
+   }
+   uint32_t firstRecordId = pendingMessages->recordNumber[range.first];
+   uint32_t lastRecordId  = pendingMessages->recordNumber[range.first + range.count - 1];
+   // written without firstRecordId - 1 because it underflows for the very first record
+   bool nothingStored = acknowledgedRecordId + 1 == firstRecordId;
+   return nothingStored || (acknowledgedRecordId >= firstRecordId && acknowledgedRecordId <= lastRecordId);
+}
+
+static bool hasValidAcknowledgement(const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE range, const UPLINK_RESULT *result) {
+   return result->acknowledged && isAcknowledgementInRange(pendingMessages, range, result->acknowledgedRecordId);
+}
+
+MESSAGE_RANGE getDeliveredMessages(const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE range, const UPLINK_RESULT *result) {
+   MESSAGE_RANGE delivered = { 0, 0 };
+
+   if (hasValidAcknowledgement(pendingMessages, range, result)) {
+      // the pending messages are sorted by their record numbers
+      while (delivered.count < pendingMessages->count && pendingMessages->recordNumber[delivered.count] <= result->acknowledgedRecordId) {
+         delivered.count++;
+      }
+   } else if (result->httpStatusCode == OK_RESPONSE) {
+      delivered = range;
+   }
+
+   return delivered;
+}
+
+bool isDeliveryUnknown(bool unknownBefore, const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE range, const UPLINK_RESULT *result) {
+   if (hasValidAcknowledgement(pendingMessages, range, result) || result->httpStatusCode == OK_RESPONSE) {
+      return false;
+   }
+   return (result->httpStatusCode <= 0) || unknownBefore;
+}
\ No newline at end of file
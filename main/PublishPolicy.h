@@ -0,0 +1,71 @@
+#ifndef windsensor_publish_policy_h
+#define windsensor_publish_policy_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Messages.h"
+#include "Uplink.h"
+
+typedef struct {
+   int first;
+   int count;
+} MESSAGE_RANGE;
+
+typedef enum {
+   PUBLISH_ORDER_OLDEST_FIRST,
+   PUBLISH_ORDER_NEWEST_FIRST
+} PublishOrder;
+
+/**
+ * Selects the pending messages that get published next. Only messages recorded directly one after the other can get
+ * published together (see getContiguousMessageCount(...)).
+ *
+ * If the signal is good, the oldest run of messages gets selected to reduce the backlog as fast as possible. If it is 
+ * poor, only the newest message gets selected because a small request has the best chance to get through. The backlog
+ * gets delivered as soon as the signal improves.
+ **/
+MESSAGE_RANGE selectMessagesToPublish(const PENDING_MESSAGES *pendingMessages, bool goodSignal);
+
+/**
+ * Selects the messages of the publishment that follows a measurement cycle. With PUBLISH_ORDER_OLDEST_FIRST the 
+ * selection is the same as the one of selectMessagesToPublish(...). With PUBLISH_ORDER_NEWEST_FIRST only the newest 
+ * message gets selected independent of the signal, because the live data should arrive as soon as possible in a small 
+ * request. The older messages get backfilled with selectMessagesToPublish(...) in separate requests.
+ **/
+MESSAGE_RANGE selectLiveMessagesToPublish(const PENDING_MESSAGES *pendingMessages, bool goodSignal, PublishOrder order);
+
+/**
+ * Selects the messages of the next envelope while the backlog gets drained. The range starts at index first and 
+ * contains as many contiguous messages as fit into budgetInBytes (lengths of the messages plus the separating commas), 
+ * but at least one message. The range is empty if there is no message at index first.
+ **/
+MESSAGE_RANGE selectBacklogToDrain(const PENDING_MESSAGES *pendingMessages, int first, size_t budgetInBytes);
+
+/**
+ * Returns true if the acknowledged record id lies between the record id before the first message of the published 
+ * range (nothing got stored) and the one of its last message (everything got stored). Any other acknowledgement refers
+ * to records the sensor did not send in this envelope (e.g. the ones of a previous boot) and must not remove messages.
+ **/
+bool isAcknowledgementInRange(const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE range, uint32_t acknowledgedRecordId);
+
+/**
+ * Returns the pending messages the service stored according to the result of publishing the range. An acknowledgement
+ * (see parseAcknowledgement(...) in Http.h) covers all pending messages up to the acknowledged record id, whichever 
+ * envelope carried them (e.g. one whose response timed out), therefore the returned range starts at the oldest message
+ * and may contain gaps in the record numbers. An acknowledgement outside of the published range gets ignored. Without 
+ * an acknowledgement either all or none of the published messages got stored, depending on the status code.
+ **/
+MESSAGE_RANGE getDeliveredMessages(const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE range, const UPLINK_RESULT *result);
+
+/**
+ * Returns whether it is open which of the pending messages the service stored. A publishment without a response (e.g.
+ * a timed out +HTTPACTION) leaves it open, because the service might have stored the messages. A status code 200 or an
+ * acknowledgement settles it, any other response leaves it as it was before (unknownBefore).
+ *
+ * As long as it is open, only the newest message should get published: the acknowledgement of its envelope tells which
+ * of the older messages got stored already, so that they do not get sent again.
+ **/
+bool isDeliveryUnknown(bool unknownBefore, const PENDING_MESSAGES *pendingMessages, MESSAGE_RANGE range, const UPLINK_RESULT *result);
+
+#endif
\ No newline at end of file
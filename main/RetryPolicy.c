@@ -0,0 +1,143 @@
+#include <string.h>
+
+#include "RetryPolicy.h"
+
+static const char* FAILURE_CLASS_NAMES[] = {
+   "none",
+   "server",
+   "network",
+   "registration",
+   "modemUnresponsive"
+};
+
+static const char* RECOVERY_ACTION_NAMES[] = {
+   "none",
+   "softReset",
+   "functionalityReset",
+   "powerCycle"
+};
+
+static bool timeReached(uint32_t nowMs, uint32_t pointInTimeMs) {
+   return (int32_t)(nowMs - pointInTimeMs) >= 0;
+}
+
+void startRetryBudget(RETRY_BUDGET *budget, uint32_t nowMs, uint32_t budgetInMs) {
+   budget->startedAtMs = nowMs;
+   budget->deadlineMs  = nowMs + budgetInMs;
+   budget->attempts    = 0;
+}
+
+int32_t getRetryDelayMs(RETRY_BUDGET *budget, uint32_t nowMs, uint32_t randomValue) {
+   budget->attempts++;
+
+   uint32_t delay = INITIAL_BACKOFF_MS;
+   for (int i = 1; i < budget->attempts && delay < MAX_BACKOFF_MS; i++) {
+      delay *= 2;
+   }
+   if (delay > MAX_BACKOFF_MS) {
+      delay = MAX_BACKOFF_MS;
+   }
+
+   // "equal jitter" keeps at least half of the delay and spreads the rest to avoid synchronized retries
+   uint32_t halfDelay = delay / 2;
+   delay = halfDelay + (randomValue % (halfDelay + 1));
+
+   if (!timeReached(budget->deadlineMs, nowMs + delay + MIN_ATTEMPT_DURATION_MS)) {
+      return -1;
+   }
+   return delay;
+}
+
+bool isUplinkAllowed(CIRCUIT_BREAKER *breaker, uint32_t nowMs) {
+   if (breaker->state == BREAKER_OPEN) {
+      if (!timeReached(nowMs, breaker->openUntilMs)) {
+         breaker->rejectedAttempts++;
+         return false;
+      }
+      breaker->state = BREAKER_HALF_OPEN;
+   }
+   return true;
+}
+
+bool isCircuitBreakerOpen(const CIRCUIT_BREAKER *breaker, uint32_t nowMs) {
+   return breaker->state == BREAKER_OPEN && !timeReached(nowMs, breaker->openUntilMs);
+}
+
+static RecoveryAction getFirstAction(FailureClass failureClass) {
+   switch(failureClass) {
+      case FAILURE_NETWORK:            return RECOVERY_SOFT_RESET;
+      case FAILURE_REGISTRATION:       return RECOVERY_FUNCTIONALITY_RESET;
+      case FAILURE_MODEM_UNRESPONSIVE: return RECOVERY_POWER_CYCLE;
+      default:                         return RECOVERY_NONE;
+   }
+}
+
+static RecoveryAction getStrongestAction(FailureClass failureClass) {
+   switch(failureClass) {
+      case FAILURE_NETWORK:            return RECOVERY_POWER_CYCLE;
+      case FAILURE_REGISTRATION:       return RECOVERY_FUNCTIONALITY_RESET;
+      case FAILURE_MODEM_UNRESPONSIVE: return RECOVERY_POWER_CYCLE;
+      default:                         return RECOVERY_NONE;
+   }
+}
+
+static void open(CIRCUIT_BREAKER *breaker, uint32_t nowMs) {
+   uint32_t cooldown = INITIAL_COOLDOWN_MS;
+   for (int i = 0; i < breaker->openCount && cooldown < MAX_COOLDOWN_MS; i++) {
+      cooldown *= 2;
+   }
+   if (cooldown > MAX_COOLDOWN_MS) {
+      cooldown = MAX_COOLDOWN_MS;
+   }
+   breaker->openCount++;
+   breaker->openUntilMs = nowMs + cooldown;
+   breaker->state       = BREAKER_OPEN;
+}
+
+RecoveryAction recordUplinkOutcome(CIRCUIT_BREAKER *breaker, FailureClass failureClass, uint32_t nowMs) {
+   if (failureClass == FAILURE_NONE || failureClass == FAILURE_SERVER) {
+      breaker->state               = BREAKER_CLOSED;
+      breaker->consecutiveFailures = 0;
+      breaker->escalationLevel     = 0;
+      breaker->openCount           = 0;
+      return RECOVERY_NONE;
+   }
+
+   breaker->consecutiveFailures++;
+
+   int threshold = (failureClass == FAILURE_MODEM_UNRESPONSIVE) ? 1 : FAILURES_BEFORE_RECOVERY;
+   if (breaker->state != BREAKER_HALF_OPEN && breaker->consecutiveFailures < threshold) {
+      return RECOVERY_NONE;
+   }
+
+   RecoveryAction strongestAction = getStrongestAction(failureClass);
+   RecoveryAction action          = getFirstAction(failureClass) + breaker->escalationLevel;
+   if (action > strongestAction) {
+      action = strongestAction;
+   }
+
+   breaker->consecutiveFailures = 0;
+   breaker->escalationLevel++;
+   breaker->recoveries[action]++;
+
+   if (action == strongestAction || breaker->state == BREAKER_HALF_OPEN) {
+      open(breaker, nowMs);
+   } else {
+      breaker->state = BREAKER_CLOSED;
+   }
+
+   return action;
+}
+
+const char* getFailureClassName(FailureClass failureClass) {
+   return (failureClass >= FAILURE_NONE && failureClass <= FAILURE_MODEM_UNRESPONSIVE) ? FAILURE_CLASS_NAMES[failureClass] : "unknown";
+}
+
+const char* getRecoveryActionName(RecoveryAction action) {
+   return (action >= RECOVERY_NONE && action <= RECOVERY_POWER_CYCLE) ? RECOVERY_ACTION_NAMES[action] : "unknown";
+}
+
+void resetCircuitBreaker(CIRCUIT_BREAKER *breaker) {
+   memset(breaker, 0, sizeof(CIRCUIT_BREAKER));
+   breaker->state = BREAKER_CLOSED;
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef windsensor_retry_policy_h
+#define windsensor_retry_policy_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define INITIAL_BACKOFF_MS             1000
+#define MAX_BACKOFF_MS                 16000
+#define MIN_ATTEMPT_DURATION_MS        5000
+#define FAILURES_BEFORE_RECOVERY       2
+#define INITIAL_COOLDOWN_MS            60000
+#define MAX_COOLDOWN_MS                600000
+
+typedef enum {
+   FAILURE_NONE,
+   FAILURE_SERVER,               // the server answered with an error status code -> the path to the server works
+   FAILURE_NETWORK,              // connection could not get opened or no (complete) response received
+   FAILURE_REGISTRATION,         // the modem answers but it is not registered in the network (e.g. no coverage)
+   FAILURE_MODEM_UNRESPONSIVE    // the modem does not answer
+} FailureClass;
+
+typedef enum {
+   RECOVERY_NONE,
+   RECOVERY_SOFT_RESET,          // close connections and bearer
+   RECOVERY_FUNCTIONALITY_RESET, // switch the RF part off and on again (AT+CFUN)
+   RECOVERY_POWER_CYCLE          // interrupt the power supply of the modem
+} RecoveryAction;
+
+typedef enum {
+   BREAKER_CLOSED,               // uplink attempts are allowed
+   BREAKER_OPEN,                 // uplink attempts get rejected till the cooldown elapsed
+   BREAKER_HALF_OPEN             // a single attempt is allowed to check whether the uplink works again
+} BreakerState;
+
+typedef struct {
+   uint32_t startedAtMs;
+   uint32_t deadlineMs;
+   int attempts;
+} RETRY_BUDGET;
+
+typedef struct {
+   BreakerState state;
+   int consecutiveFailures;
+   int escalationLevel;
+   int openCount;
+   uint32_t openUntilMs;
+   uint32_t recoveries[RECOVERY_POWER_CYCLE + 1];
+   uint32_t rejectedAttempts;
+} CIRCUIT_BREAKER;
+
+/**
+ * Starts a new budget for all attempts of a publishment.
+ **/
+void startRetryBudget(RETRY_BUDGET *budget, uint32_t nowMs, uint32_t budgetInMs);
+
+/**
+ * Counts the failed attempt and returns the delay in milliseconds before the next attempt or -1 if the next attempt
+ * (including MIN_ATTEMPT_DURATION_MS) would not fit into the budget. The delay grows exponentially with the number of
+ * attempts and the randomValue adds a jitter of up to half the delay.
+ **/
+int32_t getRetryDelayMs(RETRY_BUDGET *budget, uint32_t nowMs, uint32_t randomValue);
+
+/**
+ * Returns false while the circuit breaker is open. When the cooldown elapsed, the breaker allows a single attempt.
+ **/
+bool isUplinkAllowed(CIRCUIT_BREAKER *breaker, uint32_t nowMs);
+
+/**
+ * Returns true if the circuit breaker is open and its cooldown did not elapse yet. In contrast to isUplinkAllowed(...) 
+ * it does not change the breaker.
+ **/
+bool isCircuitBreakerOpen(const CIRCUIT_BREAKER *breaker, uint32_t nowMs);
+
+/**
+ * Records the outcome of an uplink attempt and returns the recovery action the caller has to execute. The action 
+ * escalates with repeated failures depending on the failure class:
+ *
+ *    FAILURE_SERVER              no action because the modem and the network work
+ *    FAILURE_NETWORK             soft reset -> functionality reset -> power cycle
+ *    FAILURE_REGISTRATION        functionality reset (a power cycle does not help without coverage)
+ *    FAILURE_MODEM_UNRESPONSIVE  power cycle
+ *
+ * When the strongest action of a failure class got returned or the single attempt of a half open breaker failed, the 
+ * breaker opens. Its cooldown doubles with each opening (up to MAX_COOLDOWN_MS). A successful attempt or an answer of 
+ * the server closes the breaker and resets the escalation.
+ **/
+RecoveryAction recordUplinkOutcome(CIRCUIT_BREAKER *breaker, FailureClass failureClass, uint32_t nowMs);
+
+const char* getFailureClassName(FailureClass failureClass);
+
+const char* getRecoveryActionName(RecoveryAction action);
+
+void resetCircuitBreaker(CIRCUIT_BREAKER *breaker);
+
+#endif
\ No newline at end of file
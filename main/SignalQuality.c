@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "SignalQuality.h"
+
+#define CSQ_PREFIX                     "+CSQ:"
+#define CREG_PREFIX                    "+CREG:"
+#define MAX_RSSI                       31
+#define FIXED_POINT_FACTOR             16
+
+static SIGNAL_SAMPLE history[SIGNAL_HISTORY_LENGTH];
+static int historyStart                = 0;
+static int historyCount                = 0;
+static int smoothedRssiFixedPoint      = -1;
+static int lastRssi                    = -1;
+static uint32_t lastRssiTime           = 0;
+static int lastRegistrationStatus      = -1;
+static uint32_t lastRegistrationTime   = 0;
+
+static const char* skipPrefix(const char *line, const char *prefix) {
+   if (strncmp(line, prefix, strlen(prefix)) != 0) {
+      return NULL;
+   }
+   const char *position = line + strlen(prefix);
+   while (*position == ' ') {
+      position++;
+   }
+   return position;
+}
+
+int parseSignalQuality(const char *line) {
+   const char *position = skipPrefix(line, CSQ_PREFIX);
+   if (position == NULL || *position < '0' || *position > '9') {
+      return -1;
+   }
+   int rssi = atoi(position);
+   return (rssi <= MAX_RSSI || rssi == RSSI_UNKNOWN) ? rssi : -1;
+}
+
+int parseRegistrationStatus(const char *line) {
+   const char *position = skipPrefix(line, CREG_PREFIX);
+   if (position == NULL) {
+      return -1;
+   }
+   // the response contains "<n>,<stat>" and optionally location information
+   const char *separator = strchr(position, ',');
+   if (separator == NULL || separator[1] < '0' || separator[1] > '5') {
+      return -1;
+   }
+   return separator[1] - '0';
+}
+
+void recordSignalQuality(int rssi, uint32_t nowInSeconds) {
+   int value = (rssi == RSSI_UNKNOWN) ? 0 : rssi;
+
+   if (smoothedRssiFixedPoint < 0) {
+      smoothedRssiFixedPoint = value * FIXED_POINT_FACTOR;
+   } else {
+      smoothedRssiFixedPoint = ((3 * smoothedRssiFixedPoint) + (value * FIXED_POINT_FACTOR)) / 4;
+   }
+
+   lastRssi     = rssi;
+   lastRssiTime = nowInSeconds;
+
+   int index = (historyStart + historyCount) % SIGNAL_HISTORY_LENGTH;
+   if (historyCount == SIGNAL_HISTORY_LENGTH) {
+      historyStart = (historyStart + 1) % SIGNAL_HISTORY_LENGTH;
+   } else {
+      historyCount++;
+   }
+   history[index].timeInSeconds      = nowInSeconds;
+   history[index].rssi               = rssi;
+   history[index].registrationStatus = lastRegistrationStatus;
+}
+
+void recordRegistrationStatus(int status, uint32_t nowInSeconds) {
+   lastRegistrationStatus = status;
+   lastRegistrationTime   = nowInSeconds;
+}
+
+int getSmoothedRssi() {
+   return (smoothedRssiFixedPoint < 0) ? -1 : (smoothedRssiFixedPoint + (FIXED_POINT_FACTOR / 2)) / FIXED_POINT_FACTOR;
+}
+
+bool isSignalGood() {
+   int rssi = getSmoothedRssi();
+   return rssi < 0 || rssi >= GOOD_SIGNAL_MIN_RSSI;
+}
+
+bool isCoverageProblem(uint32_t nowInSeconds) {
+   bool rssiKnown         = lastRssi >= 0 && (nowInSeconds - lastRssiTime) <= SIGNAL_SAMPLE_MAX_AGE_SECONDS;
+   bool registrationKnown = lastRegistrationStatus >= 0 && (nowInSeconds - lastRegistrationTime) <= SIGNAL_SAMPLE_MAX_AGE_SECONDS;
+   bool poorSignal        = rssiKnown && (lastRssi == RSSI_UNKNOWN || lastRssi <= POOR_SIGNAL_MAX_RSSI);
+   bool notRegistered     = registrationKnown && lastRegistrationStatus != REGISTRATION_HOME && lastRegistrationStatus != REGISTRATION_ROAMING;
+   return poorSignal || notRegistered;
+}
+
+int getSignalHistory(SIGNAL_SAMPLE *samples, int maxSamples) {
+   int count = (historyCount < maxSamples) ? historyCount : maxSamples;
+   int skip  = historyCount - count;
+   for (int i = 0; i < count; i++) {
+      samples[i] = history[(historyStart + skip + i) % SIGNAL_HISTORY_LENGTH];
+   }
+   return count;
+}
+
+void resetSignalQuality() {
+   historyStart           = 0;
+   historyCount           = 0;
+   smoothedRssiFixedPoint = -1;
+   lastRssi               = -1;
+   lastRssiTime           = 0;
+   lastRegistrationStatus = -1;
+   lastRegistrationTime   = 0;
+}
\ No newline at end of file
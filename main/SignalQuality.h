@@ -0,0 +1,76 @@
+#ifndef windsensor_signal_quality_h
+#define windsensor_signal_quality_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RSSI_UNKNOWN                   99
+#define GOOD_SIGNAL_MIN_RSSI           10    // -93 dBm
+#define POOR_SIGNAL_MAX_RSSI           5     // -103 dBm
+#define SIGNAL_HISTORY_LENGTH          16
+#define SIGNAL_SAMPLE_MAX_AGE_SECONDS  300
+
+typedef enum {
+   REGISTRATION_NOT_SEARCHING  = 0,
+   REGISTRATION_HOME           = 1,
+   REGISTRATION_SEARCHING      = 2,
+   REGISTRATION_DENIED         = 3,
+   REGISTRATION_UNKNOWN        = 4,
+   REGISTRATION_ROAMING        = 5
+} RegistrationStatus;
+
+typedef struct {
+   uint32_t timeInSeconds;
+   uint8_t rssi;
+   int8_t registrationStatus;
+} SIGNAL_SAMPLE;
+
+/**
+ * Returns the RSSI (0 ... 31 or 99 if unknown) contained in a response to AT+CSQ (e.g. "+CSQ: 17,0") or -1 if the line
+ * is not such a response.
+ **/
+int parseSignalQuality(const char *line);
+
+/**
+ * Returns the registration status contained in a response to AT+CREG? (e.g. "+CREG: 0,1") or -1 if the line is not such 
+ * a response.
+ **/
+int parseRegistrationStatus(const char *line);
+
+/**
+ * Adds a RSSI to the rolling estimate and to the history.
+ **/
+void recordSignalQuality(int rssi, uint32_t nowInSeconds);
+
+/**
+ * Stores the registration status. It gets attached to the next RSSI sample in the history.
+ **/
+void recordRegistrationStatus(int status, uint32_t nowInSeconds);
+
+/**
+ * Returns the smoothed RSSI or -1 if no sample was recorded yet. RSSI_UNKNOWN samples count as 0.
+ **/
+int getSmoothedRssi();
+
+/**
+ * Returns true if the signal is good enough for bulk uploads or if nothing is known about it.
+ **/
+bool isSignalGood();
+
+/**
+ * Returns true if the latest information (not older than SIGNAL_SAMPLE_MAX_AGE_SECONDS) says that the GSM module answers
+ * but has no (usable) network coverage. In such a case restarting the module does not help.
+ **/
+bool isCoverageProblem(uint32_t nowInSeconds);
+
+/**
+ * Copies up to maxSamples samples (oldest first) into samples and returns the number of copied samples.
+ **/
+int getSignalHistory(SIGNAL_SAMPLE *samples, int maxSamples);
+
+/**
+ * Removes all samples and the estimate.
+ **/
+void resetSignalQuality();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Telemetry.h"
+
+static TELEMETRY_COUNTERS counters;
+static uint32_t envelopeCount = 0;
+
+void recordSentBytes(uint32_t byteCount) {
+   counters.sentBytes += byteCount;
+}
+
+void recordRetry() {
+   counters.retries++;
+}
+
+void recordMissedSamples(uint32_t sampleCount) {
+   counters.missedSamples += sampleCount;
+}
+
+const TELEMETRY_COUNTERS* getTelemetryCounters() {
+   return &counters;
+}
+
+bool isTelemetryDue(uint32_t interval) {
+   if (interval == 0) {
+      return false;
+   }
+   return (envelopeCount++ % interval) == 0;
+}
+
+uint32_t getTelemetryEnvelopeCount() {
+   return envelopeCount;
+}
+
+void setTelemetryEnvelopeCount(uint32_t count) {
+   envelopeCount = count;
+}
+
+static size_t appendArray(char *buffer, size_t bufferSize, size_t length, const char *name, const uint32_t *values, int count) {
+   length += snprintf(buffer + length, (length < bufferSize) ? bufferSize - length : 0, ",\"%s\":[", name);
+   for (int i = 0; i < count; i++) {
+      length += snprintf(buffer + length, (length < bufferSize) ? bufferSize - length : 0, (i == 0) ? "%u" : ",%u", values[i]);
+   }
+   length += snprintf(buffer + length, (length < bufferSize) ? bufferSize - length : 0, "]");
+   return length;
+}
+
+int formatTelemetry(char *buffer, size_t bufferSize, const TELEMETRY *telemetry) {
+   size_t length = snprintf(buffer, bufferSize, "{\"up\":%u,\"heap\":[%u,%u]", telemetry->uptimeSeconds, telemetry->freeHeapBytes, 
+      telemetry->minimumFreeHeapBytes);
+   length = appendArray(buffer, bufferSize, length, "stack", telemetry->stackHighWaterMarks, telemetry->taskCount);
+   length = appendArray(buffer, bufferSize, length, "phases", telemetry->phaseDurationsMs, PHASE_COUNT);
+   length = appendArray(buffer, bufferSize, length, "live", telemetry->liveLatencyMs, LIVE_LATENCY_VALUES);
+   length += snprintf(buffer + length, (length < bufferSize) ? bufferSize - length : 0, ",\"transports\":[");
+   for (int i = 0; i < telemetry->transportCount; i++) {
+      length += snprintf(buffer + length, (length < bufferSize) ? bufferSize - length : 0, (i == 0) ? "[%u,%u]" : ",[%u,%u]", 
+         telemetry->transports[i].successRate, telemetry->transports[i].latencyMs);
+   }
+   length += snprintf(buffer + length, (length < bufferSize) ? bufferSize - length : 0, "]");
+   length += snprintf(buffer + length, (length < bufferSize) ? bufferSize - length : 0, ",\"rssi\":%d,\"tx\":%u,\"retries\":%u,\"missed\":%u}",
+      telemetry->rssi, telemetry->counters.sentBytes, telemetry->counters.retries, telemetry->counters.missedSamples);
+   return (length < bufferSize) ? (int)length : -1;
+}
+
+void resetTelemetry() {
+   memset(&counters, 0, sizeof(TELEMETRY_COUNTERS));
+   envelopeCount = 0;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef windsensor_telemetry_h
+#define windsensor_telemetry_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PhaseTimings.h"
+
+#define TELEMETRY_MAX_TASKS         4
+#define TELEMETRY_MAX_TRANSPORTS    2
+#define LIVE_LATENCY_VALUES         3
+
+/**
+ * The counters sum up since the boot, therefore the receiver can calculate the differences even if envelopes got lost.
+ **/
+typedef struct {
+   uint32_t sentBytes;
+   uint32_t retries;
+   uint32_t missedSamples;
+} TELEMETRY_COUNTERS;
+
+typedef struct {
+   uint32_t successRate;      // per mille
+   uint32_t latencyMs;        // smoothed latency of the successful attempts
+} TELEMETRY_TRANSPORT;
+
+typedef struct {
+   uint32_t uptimeSeconds;
+   uint32_t freeHeapBytes;
+   uint32_t minimumFreeHeapBytes;
+   int taskCount;
+   uint32_t stackHighWaterMarks[TELEMETRY_MAX_TASKS];
+   uint32_t phaseDurationsMs[PHASE_COUNT];
+   uint32_t liveLatencyMs[LIVE_LATENCY_VALUES];    // last, smoothed and maximum latency of the live data
+   int transportCount;
+   TELEMETRY_TRANSPORT transports[TELEMETRY_MAX_TRANSPORTS];
+   int rssi;
+   TELEMETRY_COUNTERS counters;
+} TELEMETRY;
+
+/**
+ * Records the number of bytes handed over to a transport.
+ **/
+void recordSentBytes(uint32_t byteCount);
+
+/**
+ * Records an attempt to deliver an envelope that was not the first one.
+ **/
+void recordRetry();
+
+/**
+ * Records samples that did not get taken because the collector was blocked.
+ **/
+void recordMissedSamples(uint32_t sampleCount);
+
+/**
+ * Returns the counters since the last reset.
+ **/
+const TELEMETRY_COUNTERS* getTelemetryCounters();
+
+/**
+ * Returns true for the first envelope and then for every interval-th envelope. Each invocation counts as one 
+ * envelope. An interval of 0 disables the telemetry.
+ **/
+bool isTelemetryDue(uint32_t interval);
+
+/**
+ * Returns the number of envelopes counted by isTelemetryDue(...), e.g. to keep it during a deep sleep.
+ **/
+uint32_t getTelemetryEnvelopeCount();
+
+/**
+ * Continues counting the envelopes at the provided count (e.g. after a deep sleep).
+ **/
+void setTelemetryEnvelopeCount(uint32_t count);
+
+/**
+ * Writes the telemetry as compact JSON object into the buffer and returns the number of characters written (without 
+ * the null byte) or -1 if the buffer is too small.
+ *
+ * Example: {"up":3600,"heap":[free,minimumFree],"stack":[bytes,...],"phases":[ms,...],"live":[last,smoothed,max],"transports":[[successRate,latency],...],"rssi":15,"tx":12345,"retries":2,"missed":0}
+ **/
+int formatTelemetry(char *buffer, size_t bufferSize, const TELEMETRY *telemetry);
+
+/**
+ * Resets the counters and the envelope count.
+ **/
+void resetTelemetry();
+
+#endif
\ No newline at end of file
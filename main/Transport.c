@@ -0,0 +1,93 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "Transport.h"
+
+static TRANSPORT *transports[MAX_TRANSPORTS];
+static int transportCount = 0;
+
+bool registerTransport(TRANSPORT *transport) {
+   if (transportCount >= MAX_TRANSPORTS) {
+      return false;
+   }
+   memset(&transport->statistics, 0, sizeof(TRANSPORT_STATISTICS));
+   transport->statistics.successRate = INITIAL_SUCCESS_RATE;
+   resetCircuitBreaker(&transport->breaker);
+   transports[transportCount++] = transport;
+   return true;
+}
+
+int getTransportCount() {
+   return transportCount;
+}
+
+TRANSPORT* getTransport(int index) {
+   return (index >= 0 && index < transportCount) ? transports[index] : NULL;
+}
+
+size_t getMaxTransportDataLength() {
+   size_t maxDataLength = 0;
+
+   for (int i = 0; i < transportCount; i++) {
+      size_t limit = transports[i]->maxDataLength;
+      if (limit > 0 && (maxDataLength == 0 || limit < maxDataLength)) {
+         maxDataLength = limit;
+      }
+   }
+   return maxDataLength;
+}
+
+void recordTransportOutcome(TRANSPORT *transport, bool successful, uint32_t latencyMs) {
+   TRANSPORT_STATISTICS *statistics = &transport->statistics;
+   uint32_t outcome                 = successful ? 1000 : 0;
+
+   statistics->successRate = (statistics->attempts == 0) ? outcome : ((3 * statistics->successRate) + outcome) / 4;
+   statistics->attempts++;
+
+   if (successful) {
+      statistics->smoothedLatencyMs = (statistics->successes == 0) ? latencyMs : ((7 * statistics->smoothedLatencyMs) + latencyMs) / 8;
+      statistics->lastLatencyMs     = latencyMs;
+      statistics->successes++;
+   }
+}
+
+static bool isBetter(const TRANSPORT *candidate, const TRANSPORT *best) {
+   const TRANSPORT_STATISTICS *a = &candidate->statistics;
+   const TRANSPORT_STATISTICS *b = &best->statistics;
+
+   if (a->successRate > b->successRate + SIMILAR_SUCCESS_RATE_DELTA) {
+      return true;
+   }
+   if (b->successRate > a->successRate + SIMILAR_SUCCESS_RATE_DELTA) {
+      return false;
+   }
+   return a->smoothedLatencyMs < b->smoothedLatencyMs;
+}
+
+TRANSPORT* selectTransport(const TRANSPORT *excluded, uint32_t nowMs) {
+   TRANSPORT *selected = NULL;
+
+   for (int i = 0; i < transportCount; i++) {
+      TRANSPORT *candidate = transports[i];
+      if (candidate == excluded || isCircuitBreakerOpen(&candidate->breaker, nowMs)) {
+         continue;
+      }
+      if (candidate->statistics.selectionsSinceLastUse >= PROBE_INTERVAL) {
+         selected = candidate;
+         break;
+      }
+      if (selected == NULL || isBetter(candidate, selected)) {
+         selected = candidate;
+      }
+   }
+
+   for (int i = 0; i < transportCount && selected != NULL; i++) {
+      transports[i]->statistics.selectionsSinceLastUse = (transports[i] == selected) ? 0 : transports[i]->statistics.selectionsSinceLastUse + 1;
+   }
+
+   return selected;
+}
+
+void removeAllTransports() {
+   transportCount = 0;
+}
\ No newline at end of file
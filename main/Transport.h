@@ -0,0 +1,122 @@
+#ifndef windsensor_transport_h
+#define windsensor_transport_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "RetryPolicy.h"
+
+#define MAX_TRANSPORTS                 2
+#define INITIAL_SUCCESS_RATE           1000     // per mille
+#define SIMILAR_SUCCESS_RATE_DELTA     100      // per mille
+#define PROBE_INTERVAL                 30       // selections without using a transport
+#define MAX_RESPONSE_BODY_LENGTH       64
+
+typedef struct {
+   uint32_t attempts;
+   uint32_t successes;
+   uint32_t lastLatencyMs;
+   uint32_t smoothedLatencyMs;
+   uint32_t successRate;                        // per mille, exponentially smoothed
+   uint32_t selectionsSinceLastUse;
+} TRANSPORT_STATISTICS;
+
+/**
+ * A way to deliver envelopes to the server (e.g. GSM module or WIFI).
+ **/
+typedef struct {
+   const char *name;
+
+   /**
+    * Maximum number of bytes of data send(...) accepts or 0 if there is no limit.
+    **/
+   size_t maxDataLength;
+
+   /**
+    * Initializes the hardware. Gets called once at startup.
+    **/
+   void (*initialize)();
+
+   /**
+    * Sets up everything needed to send data to the URL (e.g. wake up, registration and connection). Returns true if a
+    * following send(...) can transfer its data immediately.
+    **/
+   bool (*connect)(const char *url);
+
+   /**
+    * Sends data to the URL and returns the HTTP status code. In case of problems the returned status code is 0.
+    **/
+   int (*send)(const char *url, const char *data);
+
+   /**
+    * Optional. Returns the body of the response received by the last invocation of send(...) (at most 
+    * MAX_RESPONSE_BODY_LENGTH characters) or an empty string if there was none.
+    **/
+   const char* (*getResponseBody)();
+
+   /**
+    * Optional. Enters the low power state till the next publishment.
+    **/
+   void (*sleep)();
+
+   /**
+    * Returns the class of the failure that happened in the last invocation of send(...).
+    **/
+   FailureClass (*getFailureClass)();
+
+   /**
+    * Executes the recovery action returned by the circuit breaker of the transport.
+    **/
+   void (*recover)(RecoveryAction action);
+
+   /**
+    * Optional. Limits all following waits of the transport to the provided point in time (in ticks).
+    **/
+   void (*setDeadline)(uint32_t deadlineInTicks);
+
+   /**
+    * Optional. Removes the deadline.
+    **/
+   void (*clearDeadline)();
+
+   TRANSPORT_STATISTICS statistics;
+   CIRCUIT_BREAKER breaker;
+} TRANSPORT;
+
+/**
+ * Adds the transport to the transports used for publishing and resets its statistics and its circuit breaker. Returns
+ * false if MAX_TRANSPORTS are already registered.
+ **/
+bool registerTransport(TRANSPORT *transport);
+
+int getTransportCount();
+
+TRANSPORT* getTransport(int index);
+
+/**
+ * Returns the smallest maxDataLength of the registered transports (an envelope must fit into each of them, because a
+ * failed attempt gets repeated with another one) or 0 if none of them has a limit.
+ **/
+size_t getMaxTransportDataLength();
+
+/**
+ * Updates the success rate and the latency (successful attempts only) of the transport.
+ **/
+void recordTransportOutcome(TRANSPORT *transport, bool successful, uint32_t latencyMs);
+
+/**
+ * Returns the transport that should get used for the next attempt or NULL if none is available. Transports whose 
+ * circuit breaker is open and the excluded one (e.g. the one that just failed) do not get selected.
+ *
+ * The transport with the highest success rate wins. If the success rates are similar, the one with the lower latency
+ * wins. A transport that did not get used for PROBE_INTERVAL selections gets selected once to update its statistics.
+ **/
+TRANSPORT* selectTransport(const TRANSPORT *excluded, uint32_t nowMs);
+
+/**
+ * Unregisters all transports.
+ **/
+void removeAllTransports();
+
+#endif
\ No newline at end of file
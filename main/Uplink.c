@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include "ErrorMessages.h"
+#include "Http.h"
+#include "LeadTime.h"
+#include "PhaseTimings.h"
+#include "PowerManagement.h"
+#include "Profiling.h"
+#include "RetryPolicy.h"
+#include "Telemetry.h"
+#include "Transport.h"
+#include "Uplink.h"
+
+#define JOB_QUEUE_LENGTH               2
+#define OK_RESPONSE                    200
+#define UPLINK_TASK_STACK_SIZE         6144
+#define UPLINK_TASK_PRIORITY           5
+
+typedef struct {
+   UPLINK_JOB job;
+   bool preparation;
+   TickType_t submittedAt;
+   uint32_t submittedAtMs;
+   TickType_t deadline;
+} QUEUED_JOB;
+
+static const char* TAG                       = "uplink";
+static const char* HTTP_RESPONSE_TIMED_OUT   = "HTTP_RESPONSE_TIMED_OUT";
+
+static QueueHandle_t jobQueue;
+static TaskHandle_t uplinkTaskHandle = NULL;
+static bool prepared                = false;
+static uint32_t preparedAtMs        = 0;
+static TRANSPORT *preparedTransport = NULL;
+
+static uint32_t millis() {
+   // higher resolution than the tick count for the phase durations
+   return esp_timer_get_time() / 1000;
+}
+
+static bool deadlinePassed(TickType_t deadline) {
+   return (int32_t)(deadline - xTaskGetTickCount()) <= 0;
+}
+
+static void recordFailedAttempt(int httpResponseCode) {
+   if (httpResponseCode == -1) {
+      addErrorMessage(HTTP_RESPONSE_TIMED_OUT);
+   } else if (httpResponseCode != OK_RESPONSE && httpResponseCode != 0) {
+      char message[25];
+      sprintf(message, "HTTP_RESPONSE_CODE_%d", httpResponseCode);
+      addErrorMessage(message);
+   }
+}
+
+static void logTransportStatistics() {
+   for (int i = 0; i < getTransportCount(); i++) {
+      const TRANSPORT *transport               = getTransport(i);
+      const TRANSPORT_STATISTICS *statistics   = &transport->statistics;
+      const CIRCUIT_BREAKER *breaker           = &transport->breaker;
+      ESP_LOGI(TAG, "%s: success rate %u per mille (%u of %u), latency %u ms (smoothed %u ms)", transport->name, statistics->successRate,
+         statistics->successes, statistics->attempts, statistics->lastLatencyMs, statistics->smoothedLatencyMs);
+      if (breaker->state != BREAKER_CLOSED || breaker->escalationLevel > 0) {
+         ESP_LOGW(TAG, "%s: circuit breaker %s (escalation level %d, rejected attempts %u, soft resets %u, functionality resets %u, power cycles %u)",
+            transport->name, breaker->state == BREAKER_OPEN ? "open" : "half open", breaker->escalationLevel, breaker->rejectedAttempts,
+            breaker->recoveries[RECOVERY_SOFT_RESET], breaker->recoveries[RECOVERY_FUNCTIONALITY_RESET], breaker->recoveries[RECOVERY_POWER_CYCLE]);
+      }
+   }
+}
+
+static void setDeadline(TRANSPORT *transport, TickType_t deadline) {
+   if (transport->setDeadline != NULL) {
+      transport->setDeadline(deadline);
+   }
+}
+
+static void clearDeadline(TRANSPORT *transport) {
+   if (transport->clearDeadline != NULL) {
+      transport->clearDeadline();
+   }
+}
+
+static void sleepTransports(uint32_t usedTransports) {
+   for (int i = 0; i < getTransportCount(); i++) {
+      TRANSPORT *transport = getTransport(i);
+      if ((usedTransports & (1 << i)) != 0 && transport->sleep != NULL) {
+         transport->sleep();
+      }
+   }
+}
+
+static uint32_t getTransportBit(const TRANSPORT *transport) {
+   for (int i = 0; i < getTransportCount(); i++) {
+      if (getTransport(i) == transport) {
+         return 1 << i;
+      }
+   }
+   return 0;
+}
+
+static void logPhaseTimings() {
+   ESP_LOGI(TAG, "publishment took %u ms", getLastPublishDurationMs());
+   for (int phase = 0; phase < PHASE_COUNT; phase++) {
+      const PHASE_STATISTICS *statistics = getPublishPhaseStatistics(phase);
+      if (statistics->lastDurationMs > 0) {
+         ESP_LOGI(TAG, "   %-20s %6u ms (max %u ms)", getPublishPhaseName(phase), statistics->lastDurationMs, statistics->maxDurationMs);
+      }
+   }
+}
+
+static void logLeadTimeStatistics() {
+   const LEAD_TIME_STATISTICS *statistics = getLeadTimeStatistics();
+   ESP_LOGI(TAG, "lead time %u ms (bring up: last %u ms, smoothed %u ms, max %u ms, in time %u, too late %u, failed %u)", 
+      statistics->leadTimeMs, statistics->lastBringUpMs, statistics->smoothedBringUpMs, statistics->maxBringUpMs,
+      statistics->preparedInTime, statistics->preparedTooLate, statistics->failedPreparations);
+}
+
+static void processPreparation(QUEUED_JOB *queuedJob) {
+   uint32_t startedAtMs = millis();
+   TRANSPORT *transport = selectTransport(NULL, startedAtMs);
+
+   if (deadlinePassed(queuedJob->deadline)) {
+      ESP_LOGW(TAG, "budget of %u ms used up in the queue -> skipping preparation", queuedJob->job.budgetInMs);
+      return;
+   }
+   if (transport == NULL || !isUplinkAllowed(&transport->breaker, startedAtMs)) {
+      ESP_LOGW(TAG, "no transport available -> skipping preparation");
+      return;
+   }
+
+   startPublishPhases(startedAtMs);
+   setDeadline(transport, queuedJob->deadline);
+   bool ready = transport->connect(queuedJob->job.url);
+   clearDeadline(transport);
+
+   preparedAtMs      = millis();
+   prepared          = true;
+   preparedTransport = transport;
+   enterPublishPhase(PHASE_WAITING_FOR_DATA, preparedAtMs);
+   recordBringUpDuration(preparedAtMs - startedAtMs, ready);
+   ESP_LOGI(TAG, "preparation of %s %s after %u ms", transport->name, ready ? "succeeded" : "failed", preparedAtMs - startedAtMs);
+}
+
+static void processJob(QUEUED_JOB *queuedJob) {
+   UPLINK_RESULT result       = { 0, false, 0, false, 0 };
+   uint32_t submittedAtMs     = queuedJob->submittedAtMs;
+   TRANSPORT *transport       = NULL;
+   uint32_t usedTransports    = 0;
+
+   if (prepared) {
+      // the phases of the preparation and the time waiting for the data belong to this publishment
+      recordPreparationOutcome(preparedAtMs <= submittedAtMs);
+      enterPublishPhase(PHASE_QUEUED, (preparedAtMs > submittedAtMs) ? preparedAtMs : submittedAtMs);
+      transport = preparedTransport;
+      prepared  = false;
+   } else {
+      startPublishPhases(submittedAtMs);
+      enterPublishPhase(PHASE_QUEUED, submittedAtMs);
+      transport = selectTransport(NULL, millis());
+   }
+
+   RETRY_BUDGET budget;
+   startRetryBudget(&budget, submittedAtMs, queuedJob->job.budgetInMs);
+   int32_t retryDelayMs = 0;
+
+   // all attempts share the budget of the job and the circuit breakers decide when a transport needs to get recovered
+   while (retryDelayMs >= 0 && !deadlinePassed(queuedJob->deadline)) {
+      if (transport == NULL || !isUplinkAllowed(&transport->breaker, millis())) {
+         ESP_LOGW(TAG, "no transport available -> skipping attempt");
+         addErrorMessage("UPLINK_CIRCUIT_OPEN");
+         break;
+      }
+      
+      uint32_t attemptStartedAtMs = millis();
+      usedTransports             |= getTransportBit(transport);
+      setDeadline(transport, queuedJob->deadline);
+      result.httpStatusCode       = transport->send(queuedJob->job.url, queuedJob->job.data);
+      recordSentBytes(strlen(queuedJob->job.data));
+      result.acknowledged         = result.httpStatusCode > 0 && transport->getResponseBody != NULL 
+                                    && parseAcknowledgement(transport->getResponseBody(), &result.acknowledgedRecordId);
+      bool successful             = result.httpStatusCode == OK_RESPONSE;
+      FailureClass failureClass   = successful ? FAILURE_NONE : transport->getFailureClass();
+      RecoveryAction action       = recordUplinkOutcome(&transport->breaker, failureClass, millis());
+      recordTransportOutcome(transport, successful, millis() - attemptStartedAtMs);
+      recordFailedAttempt(result.httpStatusCode);
+      transport->recover(action);
+      clearDeadline(transport);
+
+      if (successful) {
+         break;
+      }
+      if (result.acknowledged) {
+         // sending the same envelope again would repeat the stored messages -> the caller sends the rest in a new one
+         ESP_LOGW(TAG, "server stored the messages up to record %u only", result.acknowledgedRecordId);
+         break;
+      }
+
+      // the next attempt uses another transport if one is available -> the envelope stays pending till it got delivered
+      TRANSPORT *alternative = selectTransport(transport, millis());
+      if (alternative != NULL) {
+         ESP_LOGW(TAG, "failing over from %s to %s", transport->name, alternative->name);
+         transport = alternative;
+      }
+
+      retryDelayMs = getRetryDelayMs(&budget, millis(), esp_random());
+      if (retryDelayMs >= 0) {
+         ESP_LOGI(TAG, "attempt %d failed (%s) -> retrying in %d ms", budget.attempts, getFailureClassName(failureClass), retryDelayMs);
+         recordRetry();
+         vTaskDelay(retryDelayMs / portTICK_PERIOD_MS);
+      }
+   }
+
+   sleepTransports(usedTransports);
+   finishPublishPhases(millis());
+   profilePublishPhases();
+
+   result.deadlineExceeded = result.httpStatusCode != OK_RESPONSE && deadlinePassed(queuedJob->deadline);
+   result.durationMs       = millis() - submittedAtMs;
+
+   if (result.deadlineExceeded) {
+      ESP_LOGW(TAG, "budget of %u ms exceeded", queuedJob->job.budgetInMs);
+      addErrorMessage("PUBLISH_DEADLINE_EXCEEDED");
+   }
+
+   logPhaseTimings();
+   logLeadTimeStatistics();
+   logTransportStatistics();
+
+   if (queuedJob->job.callback != NULL) {
+      queuedJob->job.callback(&result, queuedJob->job.context);
+   }
+}
+
+static void uplinkTask(void* arg) {
+   QUEUED_JOB queuedJob;
+
+   for(;;) {
+      if (xQueueReceive(jobQueue, &queuedJob, portMAX_DELAY)) {
+         acquirePowerLock(POWER_LOCK_UPLINK);
+         if (queuedJob.preparation) {
+            processPreparation(&queuedJob);
+         } else {
+            processJob(&queuedJob);
+         }
+         releasePowerLock(POWER_LOCK_UPLINK);
+      }
+   }
+}
+
+void startUplinkTask() {
+   jobQueue = xQueueCreate(JOB_QUEUE_LENGTH, sizeof(QUEUED_JOB));
+   if (jobQueue == NULL) {
+      ESP_LOGE(TAG, "failed to create queue for uplink jobs");
+      return;
+   }
+   xTaskCreate(uplinkTask, "uplinkTask", UPLINK_TASK_STACK_SIZE, NULL, UPLINK_TASK_PRIORITY, &uplinkTaskHandle);
+}
+
+uint32_t getUplinkTaskStackHighWaterMark() {
+   return (uplinkTaskHandle == NULL) ? 0 : uxTaskGetStackHighWaterMark(uplinkTaskHandle);
+}
+
+static bool queueJob(const UPLINK_JOB *job, bool preparation) {
+   QUEUED_JOB queuedJob;
+   queuedJob.job           = *job;
+   queuedJob.preparation   = preparation;
+   queuedJob.submittedAt   = xTaskGetTickCount();
+   queuedJob.submittedAtMs = millis();
+   queuedJob.deadline      = queuedJob.submittedAt + (job->budgetInMs / portTICK_PERIOD_MS);
+
+   if (jobQueue == NULL || xQueueSend(jobQueue, &queuedJob, 0) != pdTRUE) {
+      ESP_LOGE(TAG, "failed to queue uplink job");
+      return false;
+   }
+   return true;
+}
+
+bool submitUplinkJob(const UPLINK_JOB *job) {
+   return queueJob(job, false);
+}
+
+bool submitUplinkPreparation(const char *url, uint32_t budgetInMs) {
+   UPLINK_JOB job = {
+      .url        = url,
+      .data       = NULL,
+      .budgetInMs = budgetInMs,
+      .callback   = NULL,
+      .context    = NULL
+   };
+   return queueJob(&job, true);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef windsensor_uplink_h
+#define windsensor_uplink_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+   int httpStatusCode;
+   bool deadlineExceeded;
+   uint32_t durationMs;       // from submitting the job till its result was available
+   bool acknowledged;         // the response contained an acknowledgement (see parseAcknowledgement(...) in Http.h)
+   uint32_t acknowledgedRecordId;
+} UPLINK_RESULT;
+
+typedef void (*UplinkCallback)(const UPLINK_RESULT *result, void *context);
+
+typedef struct {
+   const char *url;
+   const char *data;
+   uint32_t budgetInMs;
+   UplinkCallback callback;
+   void *context;
+} UPLINK_JOB;
+
+/**
+ * Creates the queue for the publish jobs and starts the task that delivers them. The transports (see Transport.h) need
+ * to get registered before.
+ **/
+void startUplinkTask();
+
+/**
+ * Returns the minimum of free stack bytes of the uplink task since it got started (0 if it is not running).
+ **/
+uint32_t getUplinkTaskStackHighWaterMark();
+
+/**
+ * Queues the job for delivery and returns immediately. The data must stay valid till the callback got invoked. The 
+ * callback gets invoked in the context of the uplink task when the job is done or its budget (counting from now) 
+ * is used up. Returns false if the job could not get queued.
+ **/
+bool submitUplinkJob(const UPLINK_JOB *job);
+
+/**
+ * Queues the preparation of the connection to the URL (wake up, registration and bearer/connection set up) so that the 
+ * next job can send its data immediately. The url must stay valid till the next job got processed. The measured 
+ * bring up duration adapts the lead time (see LeadTime.h). The budget (counting from now) limits all waits of the 
+ * preparation, it should end before the next job gets submitted so that the job does not wait for the preparation. 
+ * Returns false if the preparation could not get queued.
+ **/
+bool submitUplinkPreparation(const char *url, uint32_t budgetInMs);
+
+#endif
\ No newline at end of file
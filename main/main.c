@@ -4,6 +4,7 @@
 
 #include "esp_log.h"
 #include "esp_sleep.h"
+#include "esp_timer.h"
 #include "esp_intr_alloc.h"
 #include "soc/rtc_periph.h"
 #include "freertos/FreeRTOS.h"
@@ -14,10 +15,28 @@
 #include "driver/adc.h"
 #include "sdkconfig.h"
 
+#include "BacklogDrain.h"
+#include "BootTimings.h"
+#include "DeepSleep.h"
+#include "DeferredLog.h"
+#include "EnvelopePacker.h"
 #include "Messages.h"
 #include "ErrorMessages.h"
 #include "GsmModule.h"
+#include "LeadTime.h"
+#include "LiveLatency.h"
+#include "Memory.h"
 #include "MessageFormatter.h"
+#include "NonVolatileStorage.h"
+#include "PhaseTimings.h"
+#include "PowerManagement.h"
+#include "Profiling.h"
+#include "PublishPolicy.h"
+#include "SignalQuality.h"
+#include "Telemetry.h"
+#include "Transport.h"
+#include "Uplink.h"
+#include "wifi.h"
 
 #define MEASUREMENTS_PER_PUBLISHMENT 60
 
@@ -40,9 +59,35 @@
 
 #define MAX_PULSES_PER_SECOND          89
 #define OK_RESPONSE                    200
+#define PUBLISH_BUDGET_IN_MS           (CONFIG_WINDSENSOR_PUBLISH_BUDGET_SECONDS * 1000)
+#define MIN_PREPARATION_LEAD_TIME_MS   (CONFIG_WINDSENSOR_PREPARATION_MIN_LEAD_SECONDS * 1000)
+#define MAX_PREPARATION_LEAD_TIME_MS   (CONFIG_WINDSENSOR_PREPARATION_MAX_LEAD_SECONDS * 1000)
+#define MIN_BACKLOG_BUDGET_IN_MS       10000
+#define BACKLOG_SAFETY_MARGIN_IN_MS    5000
+#define STARTUP_TASK_STACK_SIZE        6144
+#define STARTUP_TASK_PRIORITY          5
+#define MEMORY_STATISTICS_LENGTH       256
+#define TELEMETRY_LENGTH               320
+#define PROFILE_LENGTH                 (MAX_FORMATTED_HISTOGRAMS_LENGTH + 1)
+#define TELEMETRY_INTERVAL             CONFIG_WINDSENSOR_TELEMETRY_INTERVAL
+#define MAX_PREBUILT_ENVELOPE_AGE_S    5
+#define RECORD_NUMBER_KEY              "recordNumber"
+#define RECORD_NUMBERS_PER_RESERVATION 1000
+#ifdef CONFIG_WINDSENSOR_PUBLISH_ORDER_NEWEST_FIRST
+#define PUBLISH_ORDER                  PUBLISH_ORDER_NEWEST_FIRST
+#else
+#define PUBLISH_ORDER                  PUBLISH_ORDER_OLDEST_FIRST
+#endif
+#ifdef CONFIG_WINDSENSOR_BACKLOG_DRAIN
+#define BACKLOG_DRAIN_ENABLED          true
+#define DRAIN_ENVELOPE_BYTES           CONFIG_WINDSENSOR_DRAIN_ENVELOPE_BYTES
+#define DRAIN_ENVELOPE_BUDGET_BYTES    (DRAIN_ENVELOPE_BYTES - 1)    // the null byte needs the rest
+#else
+#define BACKLOG_DRAIN_ENABLED          false
+#define DRAIN_ENVELOPE_BUDGET_BYTES    0
+#endif
 
 static const char* TAG                       = "main";
-static const char* HTTP_RESPONSE_TIMED_OUT   = "HTTP_RESPONSE_TIMED_OUT";
 
 static void resetMeasuredValues();
 static void initializeAnemometerInputPin();
@@ -51,6 +96,8 @@ static void sendMeasuredValuesToServer();
 
 uint16_t anemometerPulses[MEASUREMENTS_PER_PUBLISHMENT];
 uint16_t directionVaneValues[MEASUREMENTS_PER_PUBLISHMENT];
+uint16_t completedAnemometerPulses[MEASUREMENTS_PER_PUBLISHMENT];
+uint16_t completedDirectionVaneValues[MEASUREMENTS_PER_PUBLISHMENT];
 size_t nextIndex = 0;
 
 PENDING_MESSAGES pendingMessages;
@@ -58,51 +105,148 @@ PENDING_MESSAGES pendingMessages;
 uint16_t pulseCount;
 
 static xQueueHandle anemometerQueue;
+static xQueueHandle publishResultQueue;
+static gpio_int_type_t anemometerWakeUpLevel = GPIO_INTR_LOW_LEVEL;
 static bool sendMeasuredValues = false;
+static bool prepareUplink      = false;
+static uint32_t preparationDeadlineMs;
+static bool publishInFlight    = false;
+static bool publishBacklog     = false;
+static bool publishedSinceBoot = false;
+static bool deliveryUnknown    = false;
+static bool uplinkReady        = false;
+static MESSAGE_RANGE publishedRange;
+static TaskHandle_t collectorTaskHandle  = NULL;
+static TaskHandle_t debounceTaskHandle   = NULL;
+static char *jsonEnvelope      = NULL;
+static bool jsonEnvelopeDrained   = false;
+static char *prebuiltEnvelope     = NULL;
+static bool prebuildAttempted     = false;
+static uint32_t prebuiltFirstRecordNumber;
+static int prebuiltCount;
+static time_t prebuiltAt;
+static int sequenceIdBeforePrebuilding;
+static int sequenceIdAfterPrebuilding;
+#ifdef CONFIG_WINDSENSOR_BACKLOG_DRAIN
+static char drainEnvelopes[2][DRAIN_ENVELOPE_BYTES];
+#endif
+static time_t timeOfCompletion;
+static uint32_t msOfCompletion;
 static time_t timeOfPreviousMessage;
+static uint32_t reservedRecordNumbers;
 
 static void sleepMs(TickType_t durationInMs) {
    vTaskDelay( durationInMs / portTICK_PERIOD_MS);
 }
 
+static uint32_t msSinceBoot() {
+   return esp_timer_get_time() / 1000;
+}
+
 static void debouceTask(void* arg)
 {
-   uint8_t value;
+   uint32_t pulseAtUs;
    size_t debounceDelayInMs = 1000 / MAX_PULSES_PER_SECOND;
    
    for(;;) {
-      if(xQueueReceive(anemometerQueue, &value, 500 / portTICK_RATE_MS)) {
+      // blocking without timeout -> the task does not wake up the CPU without a pulse
+      if(xQueueReceive(anemometerQueue, &pulseAtUs, portMAX_DELAY)) {
          pulseCount++;
+         if (isProfilingEnabled()) {
+            profileDuration(PROFILED_PULSE_LATENCY, (uint32_t)esp_timer_get_time() - pulseAtUs);
+         }
          sleepMs(debounceDelayInMs);
-         xQueueReceive(anemometerQueue, &value, 0);
+         xQueueReceive(anemometerQueue, &pulseAtUs, 0);
       }
    }
 }
 
+/*
+ * No samples get taken while the collector waits, therefore each second of waiting counts as a missed sample.
+ */
+static void waitTillMeasuredValuesGotSent() {
+   uint32_t waitingSinceMs = msSinceBoot();
+   while(sendMeasuredValues) {
+      sleepMs(100);
+   }
+   recordMissedSamples((msSinceBoot() - waitingSinceMs) / 1000);
+}
+
+static size_t getPreparationLeadTimeInSeconds() {
+   return (getLeadTimeMs() + 999) / 1000;
+}
+
 static void valueCollectorTask(void* arg)
 {
+   bool preparationTriggered = false;
+
    for(;;) {
       pulseCount = 0;
       sleepMs(1000);
 
       uint16_t pulses         = pulseCount;
+      acquirePowerLock(POWER_LOCK_SAMPLING);
+      int64_t readStartedAtUs = esp_timer_get_time();
       int directionVaneValue  = adc1_get_raw(ADC1_CHANNEL_6) & 0xfff;
+      profileDuration(PROFILED_ADC_READ, esp_timer_get_time() - readStartedAtUs);
+      releasePowerLock(POWER_LOCK_SAMPLING);
+      recordBootPhase(BOOT_PHASE_FIRST_SAMPLE, msSinceBoot());
 
       if (nextIndex < MEASUREMENTS_PER_PUBLISHMENT) {
          size_t index = nextIndex++;
          anemometerPulses[index]    = pulses;
          directionVaneValues[index] = directionVaneValue;
+
+         // the GSM module gets prepared in parallel to the last measurements of this publishment
+         if (MAX_PREPARATION_LEAD_TIME_MS > 0 && !preparationTriggered && (nextIndex + getPreparationLeadTimeInSeconds()) >= MEASUREMENTS_PER_PUBLISHMENT) {
+            // the preparation must not hold up the job that gets submitted when the values are complete
+            preparationDeadlineMs = msSinceBoot() + (MEASUREMENTS_PER_PUBLISHMENT - nextIndex) * 1000;
+            prepareUplink         = true;
+            preparationTriggered  = true;
+         }
       } else {
+         // the previous values get copied by the main loop immediately unless they are still waiting for a running publishment
+         waitTillMeasuredValuesGotSent();
+         memcpy(completedAnemometerPulses, anemometerPulses, sizeof(anemometerPulses));
+         memcpy(completedDirectionVaneValues, directionVaneValues, sizeof(directionVaneValues));
+         timeOfCompletion   = time(NULL);
+         msOfCompletion     = msSinceBoot();
          sendMeasuredValues = true;
-         while(sendMeasuredValues) {
-            sleepMs(100);
-         }
          resetMeasuredValues();
          nextIndex = 0;
+         preparationTriggered = false;
       }
    }
 }
 
+/*
+ * Replaces the valueCollectorTask in deep sleep mode. While the sensor is awake it takes the samples the same way as 
+ * the wake stub (pulse counter and RTC controller of the ADC) and keeps them in RTC memory.
+ */
+static void retainedValueCollectorTask(void* arg)
+{
+   for(;;) {
+      nextIndex = getRetainedSampleCount();
+
+      if (nextIndex >= MEASUREMENTS_PER_PUBLISHMENT) {
+         waitTillMeasuredValuesGotSent();
+         removeRetainedSamples(completedAnemometerPulses, completedDirectionVaneValues);
+         timeOfCompletion   = time(NULL);
+         msOfCompletion     = msSinceBoot();
+         sendMeasuredValues = true;
+         nextIndex          = 0;
+      }
+
+      sleepMs(getMsTillNextSample());
+      acquirePowerLock(POWER_LOCK_SAMPLING);
+      int64_t sampleStartedAtUs = esp_timer_get_time();
+      takeRetainedSample();
+      profileDuration(PROFILED_ADC_READ, esp_timer_get_time() - sampleStartedAtUs);
+      releasePowerLock(POWER_LOCK_SAMPLING);
+      recordBootPhase(BOOT_PHASE_FIRST_SAMPLE, msSinceBoot());
+   }
+}
+
 static void resetMeasuredValues() {
    for (size_t i=0; i < MEASUREMENTS_PER_PUBLISHMENT; i++) {
       anemometerPulses[i]    = 0;
@@ -110,6 +254,405 @@ static void resetMeasuredValues() {
    }
 }
 
+/*
+ * Gets invoked in the context of the uplink task.
+ */
+static void onPublishResult(const UPLINK_RESULT *result, void *context) {
+   xQueueSend(publishResultQueue, result, 0);
+}
+
+static void logMemoryStatistics() {
+   ARENA_STATISTICS arena  = getMemoryStatistics();
+   HEAP_STATISTICS heap    = getHeapStatistics();
+   ESP_LOGI(TAG, "heap: %u bytes free (largest block %u bytes, minimum %u bytes)", heap.freeBytes, heap.largestFreeBlock, heap.minimumFreeBytes);
+   ESP_LOGI(TAG, "memory arena: high water %u of %u bytes, %u allocation(s), %u overflow(s), %u refused reset(s)", 
+      arena.highWaterBytes, arena.sizeInBytes, arena.allocations, arena.overflows, arena.refusedResets);
+   for (int tag = 0; tag < ALLOCATION_TAG_COUNT; tag++) {
+      const ALLOCATION_STATISTICS *statistics = getAllocationStatistics(tag);
+      const uint32_t *histogram               = statistics->latencyHistogram;
+      ESP_LOGI(TAG, "   %-12s %6u allocation(s) %8u bytes (peak %u bytes in use), latency [us] <1:%u <2:%u <4:%u <8:%u <16:%u <32:%u <64:%u more:%u", 
+         getAllocationTagName(tag), statistics->allocations, statistics->bytes, statistics->peakLiveBytes, histogram[0], histogram[1], 
+         histogram[2], histogram[3], histogram[4], histogram[5], histogram[6], histogram[7]);
+   }
+}
+
+/*
+ * The statistics describe the state before the envelope got created, therefore the allocations of the previous 
+ * publishment are included.
+ */
+static void attachMemoryStatistics() {
+#ifdef CONFIG_WINDSENSOR_MEMORY_STATISTICS_IN_ENVELOPE
+   static char memoryStatistics[MEMORY_STATISTICS_LENGTH];
+   HEAP_STATISTICS heap = getHeapStatistics();
+   if (formatMemoryStatistics(memoryStatistics, MEMORY_STATISTICS_LENGTH, &heap) > 0) {
+      setEnvelopeAttachment("memory", memoryStatistics);
+   } else {
+      setEnvelopeAttachment("memory", NULL);
+   }
+#endif
+}
+
+static uint32_t getStackHighWaterMark(TaskHandle_t task) {
+   return (task == NULL) ? 0 : uxTaskGetStackHighWaterMark(task);
+}
+
+/*
+ * Gets invoked by the main task. The phase durations belong to the previous publishment.
+ */
+static void attachTelemetry() {
+   static char telemetryJson[TELEMETRY_LENGTH];
+
+   if (!isTelemetryDue(TELEMETRY_INTERVAL)) {
+      setEnvelopeAttachment("telemetry", NULL);
+      setEnvelopeAttachment("profile", NULL);
+      return;
+   }
+
+   HEAP_STATISTICS heap = getHeapStatistics();
+   TELEMETRY telemetry  = {
+      .uptimeSeconds          = msSinceBoot() / 1000,
+      .freeHeapBytes          = heap.freeBytes,
+      .minimumFreeHeapBytes   = heap.minimumFreeBytes,
+      .taskCount              = 4,
+      .stackHighWaterMarks    = { 
+         uxTaskGetStackHighWaterMark(NULL),
+         getStackHighWaterMark(collectorTaskHandle),
+         getStackHighWaterMark(debounceTaskHandle),
+         getUplinkTaskStackHighWaterMark()
+      },
+      .rssi                   = getSmoothedRssi(),
+      .counters               = *getTelemetryCounters()
+   };
+   for (int phase = 0; phase < PHASE_COUNT; phase++) {
+      telemetry.phaseDurationsMs[phase] = getPublishPhaseStatistics(phase)->lastDurationMs;
+   }
+   const LIVE_LATENCY_STATISTICS *liveLatency = getLiveLatencyStatistics();
+   telemetry.liveLatencyMs[0] = liveLatency->lastMs;
+   telemetry.liveLatencyMs[1] = liveLatency->smoothedMs;
+   telemetry.liveLatencyMs[2] = liveLatency->maxMs;
+   for (int i = 0; i < getTransportCount() && i < TELEMETRY_MAX_TRANSPORTS; i++) {
+      const TRANSPORT_STATISTICS *statistics   = &getTransport(i)->statistics;
+      telemetry.transports[i].successRate      = statistics->successRate;
+      telemetry.transports[i].latencyMs        = statistics->smoothedLatencyMs;
+      telemetry.transportCount++;
+   }
+
+   bool formatted = formatTelemetry(telemetryJson, TELEMETRY_LENGTH, &telemetry) > 0;
+   setEnvelopeAttachment("telemetry", formatted ? telemetryJson : NULL);
+
+   if (isProfilingEnabled()) {
+      static char profileJson[PROFILE_LENGTH];
+      setEnvelopeAttachment("profile", (formatProfile(profileJson, PROFILE_LENGTH) > 0) ? profileJson : NULL);
+   }
+}
+
+static void releaseJsonEnvelope() {
+   if (!jsonEnvelopeDrained) {
+      release(jsonEnvelope);
+   }
+   jsonEnvelope         = NULL;
+   jsonEnvelopeDrained  = false;
+}
+
+static void submitJsonEnvelope(uint32_t budgetInMs) {
+   logDeferred(LOG_FORMAT_ENVELOPE_LENGTH, NULL, strlen(jsonEnvelope), 0, 0);
+   
+   UPLINK_JOB job = {
+      .url        = CONFIG_WINDSENSOR_SERVICE_URL,
+      .data       = jsonEnvelope,
+      .budgetInMs = budgetInMs,
+      .callback   = onPublishResult,
+      .context    = NULL
+   };
+
+   publishInFlight   = submitUplinkJob(&job);
+   prebuildAttempted = false;
+
+   if (!publishInFlight) {
+      addErrorMessage("UPLINK_JOB_REJECTED");
+      releaseJsonEnvelope();
+      finishAllocationCycle();
+   }
+}
+
+/*
+ * The sequence id of a prebuilt envelope that never got sent gets reused, otherwise the receiver would see a gap.
+ */
+static void discardPrebuiltEnvelope() {
+   if (prebuiltEnvelope != NULL && peekNextSequenceId() == sequenceIdAfterPrebuilding) {
+      setNextSequenceId(sequenceIdBeforePrebuilding);
+   }
+   prebuiltEnvelope = NULL;
+}
+
+/*
+ * Returns the maximum length of the next envelope. It depends on the limits of the transports, on the largest free 
+ * block of the heap and on the free part of the arena (the preparation of the connection already used some of it).
+ */
+static size_t getEnvelopeBudget() {
+   ARENA_STATISTICS arena = getMemoryStatistics();
+   return getEnvelopeByteBudget(getMaxTransportDataLength(), getHeapStatistics().largestFreeBlock, arena.sizeInBytes, arena.usedBytes);
+}
+
+/*
+ * The publishment of the measured values (liveData) selects the messages according to the configured order, the 
+ * backlog always gets published oldest first. The envelope contains only as many of the selected messages as fit into
+ * the envelope budget, the remaining ones get published like the backlog.
+ */
+static void publishPendingMessages(uint32_t budgetInMs, bool liveData) {
+   discardPrebuiltEnvelope();
+   // like with a poor signal only the newest message gets published if the previous envelope might have been stored
+   bool backlogAllowed      = isSignalGood() && !deliveryUnknown;
+   MESSAGE_RANGE candidates = liveData ? selectLiveMessagesToPublish(&pendingMessages, backlogAllowed, PUBLISH_ORDER) 
+                                       : selectMessagesToPublish(&pendingMessages, backlogAllowed);
+   if (candidates.count == 0) {
+      return;
+   }
+
+   attachMemoryStatistics();
+   attachTelemetry();
+   time_t now           = time(NULL);
+   size_t budgetInBytes = getEnvelopeBudget();
+   publishedRange       = packEnvelope(&pendingMessages, candidates, budgetInBytes, now);
+   if (publishedRange.count == 0) {
+      ESP_LOGW(TAG, "message at index %d does not fit into an envelope of %u bytes", candidates.first, (uint32_t)budgetInBytes);
+      addErrorMessage("ENVELOPE_EXCEEDS_BUDGET");
+      finishAllocationCycle();
+      return;
+   }
+   
+   // the receiver needs the age of the last message to calculate the timestamps of the messages
+   int indexOfLastMessage           = publishedRange.first + publishedRange.count - 1;
+   uint32_t secondsSinceLastMessage = now - pendingMessages.recordedAt[indexOfLastMessage];
+
+   ESP_LOGI(TAG, "publishing %d of %d pending message(s) starting at index %d", publishedRange.count, pendingMessages.count, publishedRange.first);
+   jsonEnvelope = createJsonEnvelopeForRange(&pendingMessages, publishedRange.first, publishedRange.count, secondsSinceLastMessage);
+   submitJsonEnvelope(budgetInMs);
+}
+
+/*
+ * Returns the time left in the current measurement cycle for delivering backlog without delaying the publishment of
+ * the next measured values.
+ */
+static uint32_t getBacklogBudgetInMs() {
+   uint32_t timeLeftInMs = (MEASUREMENTS_PER_PUBLISHMENT - nextIndex) * 1000;
+   return (timeLeftInMs > BACKLOG_SAFETY_MARGIN_IN_MS) ? timeLeftInMs - BACKLOG_SAFETY_MARGIN_IN_MS : 0;
+}
+
+/*
+ * Uses the remaining time of the current measurement cycle to deliver the pending messages that did not get published
+ * together with the newest one.
+ */
+static void publishBacklogIfTimeLeft() {
+   uint32_t budgetInMs = getBacklogBudgetInMs();
+
+   if (budgetInMs >= MIN_BACKLOG_BUDGET_IN_MS) {
+      ESP_LOGI(TAG, "publishing backlog (budget: %u ms)", budgetInMs);
+      publishPendingMessages(budgetInMs, false);
+   }
+   publishBacklog = false;
+}
+
+/*
+ * Selects the messages of the next drain envelope starting at index first. The envelope fits into a drain buffer and
+ * into the envelope budget.
+ */
+static MESSAGE_RANGE packDrainEnvelope(int first) {
+   size_t budgetInBytes = getEnvelopeBudget();
+   budgetInBytes        = (budgetInBytes < DRAIN_ENVELOPE_BUDGET_BYTES) ? budgetInBytes : DRAIN_ENVELOPE_BUDGET_BYTES;
+
+   // the telemetry and the statistics belong to the envelopes of the measured values
+   setEnvelopeAttachment("memory", NULL);
+   setEnvelopeAttachment("telemetry", NULL);
+   setEnvelopeAttachment("profile", NULL);
+
+   // the messages alone must fit into the budget -> only these candidates need to get packed
+   MESSAGE_RANGE candidates = selectBacklogToDrain(&pendingMessages, first, budgetInBytes);
+   return packEnvelope(&pendingMessages, candidates, budgetInBytes, time(NULL));
+}
+
+/*
+ * Drain envelopes get copied out of the arena into a static buffer, because the next envelope gets built while the 
+ * current one gets uploaded and the arena gets reset after each publishment. Returns NULL if the envelope does not fit
+ * (e.g. an error message got added after the messages got packed).
+ */
+static char* buildDrainEnvelope(MESSAGE_RANGE range) {
+#ifdef CONFIG_WINDSENSOR_BACKLOG_DRAIN
+   if (range.count == 0) {
+      return NULL;
+   }
+
+   int indexOfLastMessage           = range.first + range.count - 1;
+   uint32_t secondsSinceLastMessage = time(NULL) - pendingMessages.recordedAt[indexOfLastMessage];
+   int sequenceId                   = peekNextSequenceId();
+   char *envelope = createJsonEnvelopeForRange(&pendingMessages, range.first, range.count, secondsSinceLastMessage);
+   char *buffer   = (jsonEnvelope == drainEnvelopes[0]) ? drainEnvelopes[1] : drainEnvelopes[0];
+   bool fits      = envelope != NULL && strlen(envelope) < DRAIN_ENVELOPE_BYTES;
+
+   if (fits) {
+      strcpy(buffer, envelope);
+   } else {
+      ESP_LOGW(TAG, "drain envelope of %d message(s) exceeds %d bytes", range.count, DRAIN_ENVELOPE_BYTES);
+      setNextSequenceId(sequenceId);
+   }
+   release(envelope);
+   return fits ? buffer : NULL;
+#else
+   return NULL;
+#endif
+}
+
+static void stopDrain(bool completed) {
+   uint32_t nowMs = msSinceBoot();
+   discardPrebuiltEnvelope();
+   stopBacklogDrain(nowMs, completed);
+
+   const BACKLOG_DRAIN_STATISTICS *drain = getBacklogDrainStatistics();
+   uint32_t throughput                   = getBacklogDrainThroughput(nowMs);
+   ESP_LOGI(TAG, "backlog drain %s: %u record(s) in %u envelope(s) (%u bytes) within %u ms -> %u.%03u records/s", 
+      completed ? "completed" : "stopped", drain->records, drain->envelopes, drain->bytes, drain->durationMs, 
+      throughput / 1000, throughput % 1000);
+}
+
+/*
+ * Builds the envelope that follows the one in flight while it gets uploaded (the uplink task waits for the network 
+ * most of the time). Only the oldest run of messages gets drained, therefore the next envelope starts behind it.
+ */
+static void prebuildDrainEnvelope() {
+   prebuildAttempted = true;
+   if (publishedRange.first != 0) {
+      return;
+   }
+
+   MESSAGE_RANGE range = packDrainEnvelope(publishedRange.count);
+   if (range.count == 0) {
+      return;
+   }
+
+   sequenceIdBeforePrebuilding   = peekNextSequenceId();
+   prebuiltEnvelope              = buildDrainEnvelope(range);
+   sequenceIdAfterPrebuilding    = peekNextSequenceId();
+   prebuiltFirstRecordNumber     = pendingMessages.recordNumber[range.first];
+   prebuiltCount                 = range.count;
+   prebuiltAt                    = time(NULL);
+}
+
+/*
+ * The prebuilt envelope is usable if its messages are the oldest ones now (the envelope in front of it got delivered)
+ * and its age of the last message is still accurate enough.
+ */
+static bool isPrebuiltEnvelopeUsable() {
+   return prebuiltEnvelope != NULL 
+      && pendingMessages.count >= prebuiltCount
+      && pendingMessages.recordNumber[0] == prebuiltFirstRecordNumber
+      && getContiguousMessageCount(&pendingMessages, 0) >= prebuiltCount
+      && time(NULL) - prebuiltAt <= MAX_PREBUILT_ENVELOPE_AGE_S;
+}
+
+/*
+ * Sends the next envelope of the drain as soon as the previous one got delivered. The drain pauses when the time left 
+ * in the measurement cycle is too short (the measured values have priority) and stops when the backlog is empty or the
+ * signal got poor.
+ */
+static void continueBacklogDrain() {
+   if (pendingMessages.count == 0) {
+      stopDrain(true);
+      return;
+   }
+   if (!isSignalGood()) {
+      stopDrain(false);
+      return;
+   }
+
+   uint32_t budgetInMs = getBacklogBudgetInMs();
+   if (budgetInMs < MIN_BACKLOG_BUDGET_IN_MS) {
+      return;
+   }
+
+   MESSAGE_RANGE range;
+   if (isPrebuiltEnvelopeUsable()) {
+      range.first       = 0;
+      range.count       = prebuiltCount;
+      jsonEnvelope      = prebuiltEnvelope;
+      prebuiltEnvelope  = NULL;
+   } else {
+      discardPrebuiltEnvelope();
+      range        = packDrainEnvelope(0);
+      jsonEnvelope = buildDrainEnvelope(range);
+   }
+
+   if (jsonEnvelope == NULL) {
+      stopDrain(false);
+      return;
+   }
+
+   ESP_LOGI(TAG, "draining %d of %d pending message(s) (budget: %u ms)", range.count, pendingMessages.count, budgetInMs);
+   publishedRange       = range;
+   jsonEnvelopeDrained  = true;
+   submitJsonEnvelope(budgetInMs);
+   if (!publishInFlight) {
+      stopDrain(false);
+   }
+}
+
+static void registerTransports() {
+#ifdef CONFIG_WINDSENSOR_TRANSPORT_GSM
+   registerTransport(getGsmTransport());
+#endif
+#ifdef CONFIG_WINDSENSOR_TRANSPORT_WIFI
+   registerTransport(getWifiTransport());
+#endif
+   for (int i = 0; i < getTransportCount(); i++) {
+      ESP_LOGI(TAG, "initializing transport %s", getTransport(i)->name);
+      getTransport(i)->initialize();
+   }
+}
+
+/*
+ * Initializes the transports in the background, because the GSM module might need several seconds (power up and 
+ * configuration of the baudrate) and the sampling must not wait for it.
+ */
+static void startupTask(void* arg) {
+   registerTransports();
+   recordBootPhase(BOOT_PHASE_TRANSPORTS_INITIALIZED, msSinceBoot());
+   startUplinkTask();
+   recordBootPhase(BOOT_PHASE_UPLINK_READY, msSinceBoot());
+   uplinkReady = true;
+   vTaskDelete(NULL);
+}
+
+static void logBootTimings() {
+   ESP_LOGI(TAG, "boot phases (ms since the start of the application):");
+   for (int phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+      ESP_LOGI(TAG, "   %-22s %6u ms", getBootPhaseName(phase), getBootPhaseMs(phase));
+   }
+}
+
+/*
+ * The record numbers must not start again at 0 after a reset, otherwise the service would acknowledge records of the 
+ * previous boot. Blocks of record numbers get reserved in the NVS, so it gets written once per block only. After a 
+ * reset the numbering continues behind the last reserved block, after a deep sleep it continues where it stopped.
+ */
+static void restoreRecordNumbers(bool retainedStateRestored) {
+   reservedRecordNumbers = readStoredNumber(RECORD_NUMBER_KEY, 0);
+   if (!retainedStateRestored) {
+      pendingMessages.nextRecordNumber = reservedRecordNumbers;
+   }
+   ESP_LOGI(TAG, "next record number: %u", pendingMessages.nextRecordNumber);
+}
+
+static void reserveRecordNumber() {
+   if (pendingMessages.nextRecordNumber < reservedRecordNumbers) {
+      return;
+   }
+   uint32_t endOfReservation = pendingMessages.nextRecordNumber + RECORD_NUMBERS_PER_RESERVATION;
+   if (storeNumber(RECORD_NUMBER_KEY, endOfReservation)) {
+      reservedRecordNumbers = endOfReservation;
+   } else {
+      addErrorMessage("RECORD_NUMBER_NOT_RESERVED");
+   }
+}
+
 static void sendMeasuredValuesToServer() {
    ESP_LOGI(TAG, "-----------------------------------------------------------------");
    const char* errorMessages = getErrorMessages();
@@ -118,7 +661,7 @@ static void sendMeasuredValuesToServer() {
    }
 
    uint16_t secondSincePreviousMessage = 0;
-   time_t now = time(NULL);
+   time_t now = timeOfCompletion;
       
    if (pendingMessages.count == 0) {
       timeOfPreviousMessage = now;
@@ -126,78 +669,222 @@ static void sendMeasuredValuesToServer() {
       secondSincePreviousMessage = now - timeOfPreviousMessage;
       timeOfPreviousMessage = now;
    }
-   char* jsonMessage = createJsonPayload(anemometerPulses, directionVaneValues, MEASUREMENTS_PER_PUBLISHMENT, secondSincePreviousMessage);
-   ESP_LOGI(TAG, "json message length = %d", strlen(jsonMessage));
-   addToPendingMessages(&pendingMessages, jsonMessage);
-   free(jsonMessage);
+   char* jsonMessage = createJsonPayload(completedAnemometerPulses, completedDirectionVaneValues, MEASUREMENTS_PER_PUBLISHMENT, secondSincePreviousMessage);
+   logDeferred(LOG_FORMAT_MESSAGE_LENGTH, NULL, strlen(jsonMessage), 0, 0);
+   reserveRecordNumber();
+   addToPendingMessagesWithTime(&pendingMessages, jsonMessage, now);
+   release(jsonMessage);
    ESP_LOGI(TAG, "%d message(s) pending", pendingMessages.count);
-   char* jsonEnvelope = createJsonEnvelope(&pendingMessages);
-   ESP_LOGI(TAG, "total message length = %d", strlen(jsonEnvelope));
-   
-   int httpResponseCode = 0;
-   for (int retries = 0; retries < 2 && httpResponseCode != OK_RESPONSE; retries++) {
-      
-      httpResponseCode = send(CONFIG_WINDSENSOR_SERVICE_URL, jsonEnvelope);
-      
-      if (httpResponseCode != OK_RESPONSE && httpResponseCode != 0) {
-         if (httpResponseCode == -1) {
-            addErrorMessage(HTTP_RESPONSE_TIMED_OUT);
-         } else {
-            char message[25];
-            sprintf(message, "HTTP_RESPONSE_CODE_%d", httpResponseCode);
-            addErrorMessage(message);
-         }
+   recordLiveMessage(pendingMessages.recordNumber[pendingMessages.count - 1], msOfCompletion);
+   logPowerStatistics();
+   logProfile();
+   publishPendingMessages(PUBLISH_BUDGET_IN_MS, true);
+}
+
+static void logLiveLatency() {
+   const LIVE_LATENCY_STATISTICS *latency = getLiveLatencyStatistics();
+   const uint32_t *histogram              = latency->histogram;
+   ESP_LOGI(TAG, "live data latency: last %u ms, smoothed %u ms, max %u ms, %u delivered, %u superseded, <10s:%u <20s:%u <30s:%u <60s:%u more:%u", 
+      latency->lastMs, latency->smoothedMs, latency->maxMs, latency->deliveries, latency->superseded, histogram[0], histogram[1], 
+      histogram[2], histogram[3], histogram[4]);
+}
+
+/*
+ * Removes the messages the service stored from the pending ones and returns their number (see getDeliveredMessages(...)).
+ */
+static int removeDeliveredMessages(const UPLINK_RESULT *result) {
+   if (result->acknowledged && !isAcknowledgementInRange(&pendingMessages, publishedRange, result->acknowledgedRecordId)) {
+      if (result->acknowledgedRecordId > pendingMessages.recordNumber[publishedRange.first + publishedRange.count - 1]) {
+         ESP_LOGW(TAG, "acknowledged record %u is beyond the published range -> ignored", result->acknowledgedRecordId);
+         addErrorMessage("ACK_OUT_OF_RANGE");
+      } else {
+         // older pending messages are still missing (e.g. the newest message got published first)
+         ESP_LOGI(TAG, "acknowledged record %u is before the published range", result->acknowledgedRecordId);
       }
    }
 
-   if (httpResponseCode == OK_RESPONSE) {
+   MESSAGE_RANGE delivered = getDeliveredMessages(&pendingMessages, publishedRange, result);
+   if (delivered.count == 0) {
+      return 0;
+   }
+
+   uint32_t deliveries = getLiveLatencyStatistics()->deliveries;
+   for (int i = delivered.first; i < delivered.first + delivered.count; i++) {
+      // the delivered messages might not be consecutive
+      recordDeliveredMessages(pendingMessages.recordNumber[i], 1, msSinceBoot());
+   }
+   if (getLiveLatencyStatistics()->deliveries != deliveries) {
+      logLiveLatency();
+   }
+   removePendingMessages(&pendingMessages, delivered.first, delivered.count);
+   return delivered.count;
+}
+
+static void handlePublishResult(const UPLINK_RESULT *result) {
+   ESP_LOGI(TAG, "publishment finished with status code %d after %u ms", result->httpStatusCode, result->durationMs);
+   deliveryUnknown    = isDeliveryUnknown(deliveryUnknown, &pendingMessages, publishedRange, result);
+
+   // only the stored messages get removed, the others get sent again
+   int deliveredCount = removeDeliveredMessages(result);
+   if (result->acknowledged) {
+      ESP_LOGI(TAG, "%d message(s) acknowledged (record %u), %d pending", deliveredCount, result->acknowledgedRecordId, pendingMessages.count);
+   }
+   if (deliveryUnknown) {
+      ESP_LOGW(TAG, "no response -> publishing only the newest message till an acknowledgement tells what got stored");
+   }
+   if (deliveredCount > 0 && jsonEnvelopeDrained) {
+      recordDrainedEnvelope(deliveredCount, strlen(jsonEnvelope));
+   }
+
+   if (result->httpStatusCode == OK_RESPONSE) {
       clearErrorMessages();
-      clearPendingMessages(&pendingMessages);
    }
 
-   free(jsonEnvelope);
+   if (result->httpStatusCode == OK_RESPONSE && deliveredCount > 0) {
+      publishBacklog = pendingMessages.count > 0 && isSignalGood();
+      if (BACKLOG_DRAIN_ENABLED && publishBacklog) {
+         // the link is healthy -> the backlog gets sent back to back instead of one envelope per minute
+         if (!isBacklogDrainActive()) {
+            startBacklogDrain(msSinceBoot());
+         }
+         publishBacklog = false;
+      }
+   } else if (isBacklogDrainActive()) {
+      stopDrain(false);
+   }
+
+   releaseJsonEnvelope();
+   publishInFlight    = false;
+   finishAllocationCycle();
+   logMemoryStatistics();
+   dumpGsmModuleAtTrace();
+
+   if (!publishedSinceBoot) {
+      recordBootPhase(BOOT_PHASE_FIRST_PUBLISHMENT, msSinceBoot());
+      logBootTimings();
+   }
+   publishedSinceBoot = true;
+
+   if (isDeepSleepEnabled()) {
+      recordBootToPublish();
+   }
+}
+
+/*
+ * The sensor sleeps only if all messages got delivered, because the pending messages do not survive the deep sleep.
+ */
+static bool isReadyForDeepSleep() {
+   return isDeepSleepEnabled() && publishedSinceBoot && !publishInFlight && !sendMeasuredValues && !publishBacklog 
+      && !isBacklogDrainActive() && pendingMessages.count == 0;
 }
 
 void app_main() {  
+   startDeferredLogTask();
    pulseCount = 0;
    resetMeasuredValues();
    initializePendingMessages(&pendingMessages);
-   
-   sleepMs(2000);
-   initializeGsmModule();
+   initializePowerManagement();
+   bool retainedStateRestored = false;
 
-   anemometerQueue = xQueueCreate(1, sizeof(uint8_t));
-   if (anemometerQueue == NULL) {
-      ESP_LOGE(TAG, "failed to create queue for anemometer pulses");
+   // sampling starts first, the transports get initialized in the background
+   if (isDeepSleepEnabled()) {
+      // the task accesses RTC fast memory -> PRO CPU only
+      initializeDeepSleep(MEASUREMENTS_PER_PUBLISHMENT);
+      retainedStateRestored = restoreRetainedState(&pendingMessages.nextRecordNumber, &timeOfPreviousMessage);
+      xTaskCreatePinnedToCore(retainedValueCollectorTask, "retainedValueCollectorTask", 4096, NULL, 10, &collectorTaskHandle, 0);
+   } else {
+      anemometerQueue = xQueueCreate(1, sizeof(uint32_t));
+      if (anemometerQueue == NULL) {
+         ESP_LOGE(TAG, "failed to create queue for anemometer pulses");
+      }
+      xTaskCreate(debouceTask, "anemometerInputDebouceTask", 4096, NULL, 10, &debounceTaskHandle);
+         
+      initializeAnemometerInputPin();
+      initializeDirectionVanePin();
+
+      xTaskCreate(valueCollectorTask, "valueCollectorTask", 4096, NULL, 10, &collectorTaskHandle);
    }
-   xTaskCreate(debouceTask, "anemometerInputDebouceTask", 4096, NULL, 10, NULL);
-      
-   initializeAnemometerInputPin();
-   initializeDirectionVanePin();
+   recordBootPhase(BOOT_PHASE_SAMPLING_STARTED, msSinceBoot());
+   restoreRecordNumbers(retainedStateRestored);
 
-   xTaskCreate(valueCollectorTask, "valueCollectorTask", 4096, NULL, 10, NULL);
+   publishResultQueue = xQueueCreate(1, sizeof(UPLINK_RESULT));
+   if (publishResultQueue == NULL) {
+      ESP_LOGE(TAG, "failed to create queue for publish results");
+   }
+   initializeLeadTime(MIN_PREPARATION_LEAD_TIME_MS, MAX_PREPARATION_LEAD_TIME_MS);
+   xTaskCreate(startupTask, "startupTask", STARTUP_TASK_STACK_SIZE, NULL, STARTUP_TASK_PRIORITY, NULL);
    
+   UPLINK_RESULT publishResult;
+
    for(;;) {
       sleepMs(250);
-      if (sendMeasuredValues) {
+      if (publishInFlight && xQueueReceive(publishResultQueue, &publishResult, 0)) {
+         handlePublishResult(&publishResult);
+      }
+      if (!uplinkReady) {
+         // the measured values and a preparation wait till the transports are initialized
+         continue;
+      }
+      if (prepareUplink) {
+         int32_t preparationBudgetInMs = (int32_t)(preparationDeadlineMs - msSinceBoot());
+         if (!publishInFlight && preparationBudgetInMs > 0) {
+            submitUplinkPreparation(CONFIG_WINDSENSOR_SERVICE_URL, preparationBudgetInMs);
+         }
+         prepareUplink = false;
+      }
+      if (sendMeasuredValues && !publishInFlight) {
          sendMeasuredValuesToServer();
          sendMeasuredValues = false;
       }
+      if (publishBacklog && !publishInFlight && !sendMeasuredValues && !prepareUplink) {
+         publishBacklogIfTimeLeft();
+      }
+      if (isBacklogDrainActive() && !sendMeasuredValues && !prepareUplink) {
+         if (!publishInFlight) {
+            continueBacklogDrain();
+         } else if (!prebuildAttempted) {
+            prebuildDrainEnvelope();
+         }
+      }
+      if (isReadyForDeepSleep()) {
+         enterDeepSleep(pendingMessages.nextRecordNumber, timeOfPreviousMessage);
+      }
    }
 }
 
 static void IRAM_ATTR onAnemometerPulse(void* arg)
 {
    BaseType_t xHigherPriorityTaskWoken;
-   uint8_t value = 0;
-   xQueueSendFromISR(anemometerQueue, &value, &xHigherPriorityTaskWoken);
+#ifdef CONFIG_WINDSENSOR_PROFILING
+   uint32_t pulseAtUs = esp_timer_get_time();
+#else
+   uint32_t pulseAtUs = 0;
+#endif
+   xQueueSendFromISR(anemometerQueue, &pulseAtUs, &xHigherPriorityTaskWoken);
+}
+
+/*
+ * Edge interrupts do not wake up the chip from light sleep. Therefore the pin uses level interrupts that alternate 
+ * between low (reed contact closed) and high (contact open). A pulse gets counted when the contact opens, like the
+ * rising edge without light sleep. The wake up of the pin gets enabled once in task context, the level it wakes up at
+ * is the interrupt type, therefore flipping the interrupt type is enough.
+ */
+static void IRAM_ATTR onAnemometerLevel(void* arg)
+{
+   if (anemometerWakeUpLevel == GPIO_INTR_LOW_LEVEL) {
+      anemometerWakeUpLevel = GPIO_INTR_HIGH_LEVEL;
+   } else {
+      anemometerWakeUpLevel = GPIO_INTR_LOW_LEVEL;
+      onAnemometerPulse(arg);
+   }
+   gpio_set_intr_type(D25, anemometerWakeUpLevel);
 }
 
 static void initializeAnemometerInputPin() 
 {
    ESP_LOGI(TAG, "initializing anemometer input pin");
    gpio_config_t io_conf = {};
-   io_conf.intr_type     = GPIO_INTR_POSEDGE;
+   io_conf.intr_type     = isLightSleepEnabled() ? anemometerWakeUpLevel : GPIO_INTR_POSEDGE;
    io_conf.mode          = GPIO_MODE_INPUT;
    io_conf.pin_bit_mask  = (1ULL << D25);
    io_conf.pull_down_en  = GPIO_PULLDOWN_DISABLE;
@@ -211,9 +898,13 @@ static void initializeAnemometerInputPin()
       ESP_LOGE(TAG, "failed to install the drivers GPIO ISR handler service");
    }
    
-   if (gpio_isr_handler_add(D25, onAnemometerPulse, NULL) != ESP_OK) {
+   if (gpio_isr_handler_add(D25, isLightSleepEnabled() ? onAnemometerLevel : onAnemometerPulse, NULL) != ESP_OK) {
       ESP_LOGE(TAG, "failed add ISR handler");
    }
+
+   if (isLightSleepEnabled() && (gpio_wakeup_enable(D25, anemometerWakeUpLevel) != ESP_OK || esp_sleep_enable_gpio_wakeup() != ESP_OK)) {
+      ESP_LOGE(TAG, "failed to enable wake up by anemometer pulses");
+   }
 }
 
 static void initializeDirectionVanePin() 
@@ -3,176 +3,413 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
 #include "esp_wifi.h"
-#include "nvs_flash.h" // non-volatile storage library
 #include "esp_http_client.h"
 #include "sdkconfig.h"
 
+#include "AwakeTime.h"
+#include "DeferredLog.h"
+#include "Http.h"
+#include "NonVolatileStorage.h"
 #include "wifi.h"
 
-// The event group allows multiple bits for each event. We're only interested in the connected and fail events:
+// The event group allows multiple bits for each event. We're only interested in the connected event:
 #define WIFI_CONNECTED_BIT          BIT0
-#define WIFI_FAIL_BIT               BIT1
-#define WIFI_MAX_CONNECT_RETRIES    2
-#define HTTP_CLIENT_MAX_RETRIES     2
+#define MIN_RECONNECT_DELAY_MS      1000
+#define MAX_RECONNECT_DELAY_MS      30000
+#define CONNECT_TIMEOUT_MS          10000
+#define HTTP_TIMEOUT_MS             10000
+
+#if defined(CONFIG_WINDSENSOR_WIFI_POWER_SAVE_MAX_MODEM)
+#define POWER_SAVE_MODE             WIFI_PS_MAX_MODEM
+#define LISTEN_INTERVAL             CONFIG_WINDSENSOR_WIFI_LISTEN_INTERVAL
+#elif defined(CONFIG_WINDSENSOR_WIFI_POWER_SAVE_MIN_MODEM)
+#define POWER_SAVE_MODE             WIFI_PS_MIN_MODEM
+#define LISTEN_INTERVAL             0
+#else
+#define POWER_SAVE_MODE             WIFI_PS_NONE
+#define LISTEN_INTERVAL             0
+#endif
 
 static const char* TAG = "wifi";
 static EventGroupHandle_t eventGroup;
-static int wifiConnectRetries = 0;
-static EventBits_t eventBits;
+static TimerHandle_t reconnectTimer;
+static esp_http_client_handle_t client = NULL;
+static HTTP_URL clientUrl;
+static bool wifiStarted             = false;
+static bool connectionLost          = false;
+static bool awake                   = false;
+static bool reconnectPending        = false;
+static uint32_t wokeUpAtMs          = 0;
+static uint32_t reconnectDelayMs    = MIN_RECONNECT_DELAY_MS;
+static FailureClass failureClass    = FAILURE_NONE;
+static char responseBody[MAX_RESPONSE_BODY_LENGTH + 1];
+static TickType_t deadline          = 0;
+static bool deadlineActive          = false;
+
+static uint32_t millis()
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
 
-static void initNonVolatileStorage()
+/*
+ * Shortens the provided timeout to the time left till the deadline (if one is set).
+ */
+static uint32_t limitToDeadline(uint32_t timeoutInMs)
 {
-    ESP_LOGI(TAG, "initializing non-volatile storage");
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
+    if (!deadlineActive) {
+        return timeoutInMs;
     }
-    ESP_ERROR_CHECK( ret );
+    int32_t ticksLeft   = (int32_t)(deadline - xTaskGetTickCount());
+    uint32_t millisLeft = (ticksLeft > 0) ? ticksLeft * portTICK_PERIOD_MS : 0;
+    return (millisLeft < timeoutInMs) ? millisLeft : timeoutInMs;
+}
+
+static void onReconnectTimer(TimerHandle_t timer)
+{
+    ESP_LOGI(TAG, "reconnecting to the AP ...");
+    esp_wifi_connect();
 }
 
+/*
+ * The station stays connected between publishments. If the connection gets lost, it reconnects in the background with
+ * a delay that doubles with each failed attempt.
+ */
 static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
 {
-    if ((eventBits & WIFI_CONNECTED_BIT) == 0) {
-        if (strcmp(event_base, WIFI_EVENT) == 0) {
-            switch(event_id) {
-                case WIFI_EVENT_STA_START:          ESP_LOGI(TAG, "WIFI_EVENT_STA_START -> connecting to the AP ...");
-                                                    ESP_ERROR_CHECK(esp_wifi_connect());
-                                                    break;
-
-                case WIFI_EVENT_STA_DISCONNECTED:   if (wifiConnectRetries < WIFI_MAX_CONNECT_RETRIES) {
-                                                        wifiConnectRetries++;
-                                                        ESP_LOGI(TAG, "%d. retry to connect to the AP", wifiConnectRetries);
-                                                        ESP_ERROR_CHECK(esp_wifi_connect());
-                                                    } else {
-                                                        xEventGroupSetBits(eventGroup, WIFI_FAIL_BIT);
-                                                    }
-                                                    break;
-            }
-        } else if (strcmp(event_base, IP_EVENT) == 0) {
-            if ( event_id == IP_EVENT_STA_GOT_IP) {
-                ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-                ESP_LOGI(TAG, "got IP address: " IPSTR, IP2STR(&event->ip_info.ip));
-                wifiConnectRetries = 0;
-                xEventGroupSetBits(eventGroup, WIFI_CONNECTED_BIT);
-            }
-        } else {
-            ESP_LOGI(TAG, "%s ID=%d", event_base, event_id);
+    if (strcmp(event_base, WIFI_EVENT) == 0) {
+        switch(event_id) {
+            case WIFI_EVENT_STA_START:          ESP_LOGI(TAG, "WIFI_EVENT_STA_START -> connecting to the AP ...");
+                                                ESP_ERROR_CHECK(esp_wifi_connect());
+                                                break;
+
+            case WIFI_EVENT_STA_DISCONNECTED:   xEventGroupClearBits(eventGroup, WIFI_CONNECTED_BIT);
+                                                connectionLost = true;
+                                                ESP_LOGW(TAG, "disconnected -> reconnecting in %u ms", reconnectDelayMs);
+                                                xTimerChangePeriod(reconnectTimer, reconnectDelayMs / portTICK_PERIOD_MS, 0);
+                                                xTimerStart(reconnectTimer, 0);
+                                                reconnectDelayMs = (reconnectDelayMs * 2 > MAX_RECONNECT_DELAY_MS) ? MAX_RECONNECT_DELAY_MS : reconnectDelayMs * 2;
+                                                break;
+        }
+    } else if (strcmp(event_base, IP_EVENT) == 0) {
+        if ( event_id == IP_EVENT_STA_GOT_IP) {
+            ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
+            ESP_LOGI(TAG, "got IP address: " IPSTR, IP2STR(&event->ip_info.ip));
+            reconnectDelayMs = MIN_RECONNECT_DELAY_MS;
+            xEventGroupSetBits(eventGroup, WIFI_CONNECTED_BIT);
         }
+    } else {
+        ESP_LOGI(TAG, "%s ID=%d", event_base, event_id);
     }
 }
 
-static int sendHttpRequest(const char* url, const char* data) {
-    bool statusCode = false;
+/*
+ * Initializes the network stack and starts the station once. The default event loop and the default netif must not get
+ * created more than once.
+ */
+static bool startWifi()
+{
+    if (wifiStarted) {
+        return true;
+    }
 
-    esp_http_client_config_t config = {
-        .url = url
+    ESP_LOGI(TAG, "create event group");
+    eventGroup     = xEventGroupCreate();
+    reconnectTimer = xTimerCreate("wifiReconnect", MIN_RECONNECT_DELAY_MS / portTICK_PERIOD_MS, pdFALSE, NULL, onReconnectTimer);
+    if (eventGroup == NULL || reconnectTimer == NULL) {
+        ESP_LOGE(TAG, "failed to create event group or reconnect timer");
+        return false;
+    }
+
+    initializeNonVolatileStorage();
+    ESP_LOGI(TAG, "esp_netif_init");
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_LOGI(TAG, "esp_event_loop_create_default");
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    ESP_LOGI(TAG, "esp_netif_create_default_wifi_sta");
+    esp_netif_create_default_wifi_sta();
+    ESP_LOGI(TAG, "esp_wifi_init");
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+
+    esp_event_handler_instance_t handlerInstance;
+    ESP_LOGI(TAG, "esp_event_handler_instance_register");
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, &event_handler, NULL, &handlerInstance));
+
+    ESP_LOGI(TAG, "esp_wifi_set_mode");
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    ESP_LOGI(TAG, "esp_wifi_set_config");
+    wifi_config_t staConfig = {
+        .sta = {
+            .ssid = CONFIG_WINDSENSOR_WIFI_SSID,
+            .password = CONFIG_WINDSENSOR_WIFI_PASSWORD,
+            .listen_interval = LISTEN_INTERVAL
+        },
     };
-    ESP_LOGI(TAG, "initializing HTTP client");
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    
-    ESP_LOGI(TAG, "setting content-type to application/json");
-    ESP_ERROR_CHECK(esp_http_client_set_header(client, "Content-Type", "application/json"));
-    ESP_LOGI(TAG, "setting method POST");
-    ESP_ERROR_CHECK(esp_http_client_set_method(client, HTTP_METHOD_POST));
-    ESP_LOGI(TAG, "setting POST data");
-    ESP_ERROR_CHECK(esp_http_client_set_post_field(client, data, strlen(data)));
+    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &staConfig));
+    ESP_LOGI(TAG, "esp_wifi_start");
+    ESP_ERROR_CHECK(esp_wifi_start() );
+    ESP_LOGI(TAG, "esp_wifi_set_ps");
+    ESP_ERROR_CHECK(esp_wifi_set_ps(POWER_SAVE_MODE));
+    resetAwakeTimeStatistics(millis());
 
-    ESP_LOGI(TAG, "sending data");
-    int pendingAttempts = HTTP_CLIENT_MAX_RETRIES;
-
-    esp_err_t result;
-
-    do {
-        result = esp_http_client_perform(client);
-        pendingAttempts--;
-    
-        if ( result == ESP_OK) {
-            int statusCode = esp_http_client_get_status_code(client);
-            ESP_LOGI(TAG, "statusCode = %d", statusCode);
-            ESP_LOGI(TAG, "closing connection");
-            esp_err_t closingResult = esp_http_client_close(client);
-            if (closingResult == ESP_FAIL ) {
-                ESP_LOGW(TAG, "failed to close http connection");
-            }
-        } else {
-            if (pendingAttempts > 0) {
-                ESP_LOGW(TAG, "failed to send %s to %s -> retrying it ...", data, url);
-            } else {
-                ESP_LOGE(TAG, "failed to send %s to %s", data, url);
-            }
+    wifiStarted = true;
+    return true;
+}
+
+/*
+ * Keeps the beginning of the response body, esp_http_client_perform(...) consumes it.
+ */
+static esp_err_t onHttpEvent(esp_http_client_event_t *event)
+{
+    if (event->event_id == HTTP_EVENT_ON_DATA) {
+        size_t length    = strlen(responseBody);
+        size_t available = MAX_RESPONSE_BODY_LENGTH - length;
+        size_t count     = ((size_t)event->data_len < available) ? (size_t)event->data_len : available;
+        memcpy(responseBody + length, event->data, count);
+        responseBody[length + count] = 0;
+    }
+    return ESP_OK;
+}
+
+/*
+ * Creates the HTTP client once. The client keeps the TCP connection to the server open between the requests (HTTP/1.1
+ * keep-alive) as long as the server does not close it.
+ */
+static esp_http_client_handle_t getHttpClient(const char* url)
+{
+    HTTP_URL parsedUrl;
+
+    if (!parseUrl(url, &parsedUrl)) {
+        ESP_LOGE(TAG, "failed to parse URL \"%s\"", url);
+        return NULL;
+    }
+
+    bool sameServer = client != NULL && strcmp(parsedUrl.host, clientUrl.host) == 0 && parsedUrl.port == clientUrl.port;
+
+    if (client != NULL && !sameServer) {
+        ESP_LOGI(TAG, "server changed -> creating new HTTP client");
+        esp_http_client_cleanup(client);
+        client = NULL;
+    }
+
+    if (client == NULL) {
+        esp_http_client_config_t config = {
+            .host          = parsedUrl.host,
+            .port          = parsedUrl.port,
+            .path          = parsedUrl.path,
+            .method        = HTTP_METHOD_POST,
+            .timeout_ms    = HTTP_TIMEOUT_MS,
+            .event_handler = onHttpEvent
+        };
+        ESP_LOGI(TAG, "initializing HTTP client");
+        client    = esp_http_client_init(&config);
+        clientUrl = parsedUrl;
+        if (client != NULL) {
+            ESP_ERROR_CHECK(esp_http_client_set_header(client, "Content-Type", "application/json"));
         }
-    } while ((pendingAttempts > 0) && (result != ESP_OK));
+    }
 
-    esp_http_client_cleanup(client);
+    return client;
+}
+
+static int sendHttpRequest(const char* url, const char* data) {
+    int statusCode = 0;
+    esp_http_client_handle_t httpClient = getHttpClient(url);
+
+    if (httpClient == NULL) {
+        failureClass = FAILURE_NETWORK;
+        return statusCode;
+    }
+
+    if (connectionLost) {
+        // the TCP connection of the client did not survive the reconnect of the station
+        esp_http_client_close(httpClient);
+        connectionLost = false;
+    }
+
+    ESP_ERROR_CHECK(esp_http_client_set_method(httpClient, HTTP_METHOD_POST));
+    ESP_ERROR_CHECK(esp_http_client_set_post_field(httpClient, data, strlen(data)));
+
+    uint32_t timeoutInMs = limitToDeadline(HTTP_TIMEOUT_MS);
+    if (timeoutInMs == 0) {
+        ESP_LOGW(TAG, "deadline passed -> request not sent");
+        failureClass = FAILURE_NETWORK;
+        return statusCode;
+    }
+    ESP_ERROR_CHECK(esp_http_client_set_timeout_ms(httpClient, timeoutInMs));
+
+    // retries are up to the uplink task (see RetryPolicy.h)
+    ESP_LOGI(TAG, "sending data");
+    responseBody[0] = 0;
+    esp_err_t result = esp_http_client_perform(httpClient);
+
+    if ( result == ESP_OK) {
+        statusCode   = esp_http_client_get_status_code(httpClient);
+        failureClass = (statusCode == 200) ? FAILURE_NONE : FAILURE_SERVER;
+        ESP_LOGI(TAG, "statusCode = %d", statusCode);
+    } else {
+        failureClass = FAILURE_NETWORK;
+        // the payload does not get logged, printing it would delay the next attempt
+        logDeferred(LOG_FORMAT_SEND_FAILED, url, strlen(data), result, 0);
+        // the next request opens a new connection
+        esp_http_client_close(httpClient);
+    }
 
     return statusCode;
 }
 
-int send(const char* url, const char* data)
+static bool waitForConnection()
+{
+    ESP_LOGI(TAG, "waiting for WIFI to get connected ...");
+    EventBits_t eventBits = xEventGroupWaitBits(eventGroup, WIFI_CONNECTED_BIT, pdFALSE, pdFALSE, limitToDeadline(CONNECT_TIMEOUT_MS) / portTICK_PERIOD_MS);
+    bool connected        = (eventBits & WIFI_CONNECTED_BIT) != 0;
+
+    if (connected && reconnectPending) {
+        // 0 if the station stayed associated while it was sleeping
+        recordReconnectLatency(millis() - wokeUpAtMs);
+        reconnectPending = false;
+    }
+    return connected;
+}
+
+/*
+ * Leaves the power save mode for the duration of an upload. The radio stays on and does not wait for the next beacon
+ * to receive the response. The uplink task holds the power lock (see PowerManagement.h) that keeps the chip out of 
+ * light sleep.
+ */
+static void wakeWifi()
+{
+    if (awake) {
+        return;
+    }
+    esp_wifi_set_ps(WIFI_PS_NONE);
+    awake            = true;
+    reconnectPending = true;
+    wokeUpAtMs       = millis();
+    markAwake(wokeUpAtMs);
+}
+
+static void logAwakeTimeStatistics()
+{
+    const AWAKE_TIME_STATISTICS *statistics = getAwakeTimeStatistics(millis());
+    ESP_LOGI(TAG, "awake %u ms in the last minute (max %u ms, %u wake ups), reconnect after sleep %u ms (smoothed %u ms, max %u ms)",
+        statistics->lastMinuteAwakeMs, statistics->maxMinuteAwakeMs, statistics->wakeUps, statistics->lastReconnectMs,
+        statistics->smoothedReconnectMs, statistics->maxReconnectMs);
+}
+
+void initializeWifi()
+{
+    startWifi();
+}
+
+bool connectWifi(const char* url)
+{
+    if (!startWifi()) {
+        return false;
+    }
+    wakeWifi();
+    return waitForConnection() && getHttpClient(url) != NULL;
+}
+
+int sendViaWifi(const char* url, const char* data)
 {
     // https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-reference/network/esp_netif.html
 
-    int statusCode = 0;
+    // the access point is not reachable
+    failureClass    = FAILURE_REGISTRATION;
+    responseBody[0] = 0;
 
-    ESP_LOGI(TAG, "create event group");
-    eventGroup = xEventGroupCreate();
-    if (eventGroup == NULL) {
-        ESP_LOGI(TAG, "failed to create event group");
-    } else {
-        initNonVolatileStorage();
-        ESP_LOGI(TAG, "esp_netif_init");
-        ESP_ERROR_CHECK(esp_netif_init());
-        ESP_LOGI(TAG, "esp_event_loop_create_default");
-        ESP_ERROR_CHECK(esp_event_loop_create_default());
-        ESP_LOGI(TAG, "esp_netif_create_default_wifi_sta");
-        esp_netif_create_default_wifi_sta();
-        ESP_LOGI(TAG, "esp_wifi_init");
-        wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-        ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
-        esp_event_handler_instance_t handlerInstance;
-        ESP_LOGI(TAG, "esp_event_handler_instance_register");
-        ESP_ERROR_CHECK(esp_event_handler_instance_register(ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, &event_handler, NULL, &handlerInstance));
-
-        ESP_LOGI(TAG, "esp_wifi_set_mode");
-        ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-        ESP_LOGI(TAG, "esp_wifi_set_config");
-        wifi_config_t staConfig = {
-            .sta = {
-                .ssid = CONFIG_WINDSENSOR_WIFI_SSID,
-                .password = CONFIG_WINDSENSOR_WIFI_PASSWORD
-            },
-        };
-        ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &staConfig));
-        ESP_LOGI(TAG, "esp_wifi_start");
-        ESP_ERROR_CHECK(esp_wifi_start() );
-        
-        ESP_LOGI(TAG, "waiting for WIFI to get connected ...");
-        eventBits = xEventGroupWaitBits(eventGroup, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
-        bool connected = eventBits & WIFI_CONNECTED_BIT;
-
-        if (connected) {
-            statusCode = sendHttpRequest(url, data);
-        } else {
-            ESP_LOGE(TAG, "failed to connect to WIFI");
-        }
+    if (!startWifi()) {
+        return 0;
+    }
 
-        ESP_LOGI(TAG, "esp_event_handler_instance_unregister");
-        ESP_ERROR_CHECK(esp_event_handler_instance_unregister(ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, &handlerInstance));
-        
-        if(connected) {
-            ESP_LOGI(TAG, "esp_wifi_disconnect");
-            ESP_ERROR_CHECK(esp_wifi_disconnect());
-        }
+    wakeWifi();
+
+    if (!waitForConnection()) {
+        ESP_LOGE(TAG, "failed to connect to WIFI");
+        return 0;
+    }
+
+    return sendHttpRequest(url, data);
+}
+
+void sleepWifi()
+{
+    if (!awake) {
+        return;
+    }
+    esp_wifi_set_ps(POWER_SAVE_MODE);
+    awake            = false;
+    reconnectPending = false;
+    markAsleep(millis());
+    logAwakeTimeStatistics();
+}
+
+FailureClass getWifiFailureClass()
+{
+    return failureClass;
+}
+
+const char* getWifiResponseBody()
+{
+    return responseBody;
+}
 
-        ESP_LOGI(TAG, "deleting event group");
-        vEventGroupDelete(eventGroup);
-        ESP_LOGI(TAG, "esp_wifi_stop");
+void recoverWifi(RecoveryAction action)
+{
+    if (action == RECOVERY_NONE || !wifiStarted) {
+        return;
+    }
+
+    ESP_LOGW(TAG, "recovering WIFI (%s) ...", getRecoveryActionName(action));
+
+    if (client != NULL) {
+        esp_http_client_close(client);
+    }
+
+    if (action == RECOVERY_FUNCTIONALITY_RESET) {
+        // the disconnect event triggers the reconnect
+        esp_wifi_disconnect();
+    } else if (action == RECOVERY_POWER_CYCLE) {
         esp_wifi_stop();
+        // the next recovery or publishment tries again
+        esp_err_t result = esp_wifi_start();
+        if (result != ESP_OK) {
+            ESP_LOGE(TAG, "failed to restart WIFI (%s)", esp_err_to_name(result));
+        }
     }
-    return statusCode;
+}
+
+void setWifiDeadline(uint32_t deadlineInTicks)
+{
+    deadline       = deadlineInTicks;
+    deadlineActive = true;
+}
+
+void clearWifiDeadline()
+{
+    deadlineActive = false;
+}
+
+static TRANSPORT wifiTransport = {
+    .name             = "wifi",
+    .initialize       = initializeWifi,
+    .connect          = connectWifi,
+    .send             = sendViaWifi,
+    .getResponseBody  = getWifiResponseBody,
+    .sleep            = sleepWifi,
+    .getFailureClass  = getWifiFailureClass,
+    .recover          = recoverWifi,
+    .setDeadline      = setWifiDeadline,
+    .clearDeadline    = clearWifiDeadline
+};
+
+TRANSPORT* getWifiTransport()
+{
+    return &wifiTransport;
 }
 
 // state diagrams:  https://medium.com/@mahavirj/esp-idf-wifi-networking-3eaebd11eb43
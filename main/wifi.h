@@ -1,9 +1,66 @@
 #ifndef windsensor_wifi_h
 #define windsensor_wifi_h
 
+#include <stdbool.h>
+
+#include "RetryPolicy.h"
+#include "Transport.h"
+
+/**
+ * Returns WIFI as transport (see Transport.h).
+ **/
+TRANSPORT* getWifiTransport();
+
+/**
+ * Starts the WIFI station. It stays connected (and reconnects in the background) till the device restarts. This method 
+ * gets called automatically when you call sendViaWifi(...).
+ **/
+void initializeWifi();
+
+/**
+ * Waits till the station is connected and creates the HTTP client for the URL. Returns true if a following 
+ * sendViaWifi(...) can transfer its data immediately.
+ **/
+bool connectWifi(const char* url);
+
+/**
+ * Sends data to the URL and returns the HTTP status code. In case of problems the returned status code is 0. The 
+ * connection to the server gets reused by subsequent invocations.
+ **/
+int sendViaWifi(const char* url, const char* data);
+
+/**
+ * Enters the configured power save mode (modem sleep and optionally automatic light sleep) till the next invocation of
+ * connectWifi(...) or sendViaWifi(...). The station stays associated with the access point.
+ **/
+void sleepWifi();
+
+/**
+ * Returns the class of the failure that happened in the last invocation of sendViaWifi(...) or FAILURE_NONE if it 
+ * succeeded.
+ **/
+FailureClass getWifiFailureClass();
+
+/**
+ * Returns the beginning of the response body received by the last invocation of sendViaWifi(...) or an empty string.
+ **/
+const char* getWifiResponseBody();
+
+/**
+ * Closes the connection to the server (soft reset), reconnects to the access point (functionality reset) or restarts
+ * the WIFI driver (power cycle).
+ **/
+void recoverWifi(RecoveryAction action);
+
+/**
+ * Limits the following waits for the connection to the access point and the timeouts of the HTTP requests to the
+ * provided point in time (in ticks). When the deadline passed, sendViaWifi(...) does not send the data and returns 0.
+ **/
+void setWifiDeadline(uint32_t deadlineInTicks);
+
 /**
- * Sends data to the URL and returns the HTTP status code. In case of problems the returned status code is 0.
+ * Removes the deadline set by setWifiDeadline(...).
  **/
-int send(const char* url, const char* data);
+void clearWifiDeadline();
 
 #endif
\ No newline at end of file
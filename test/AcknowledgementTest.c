@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/Http.h"
+#include "../main/MessageFormatter.h"
+#include "../main/Messages.h"
+#include "../main/PublishPolicy.h"
+#include "TestingMemory.h"
+
+#define MAX_RECORDS        1100
+#define MESSAGE_MARKER     "\"m\":"
+#define FIRST_RECORD_ID    "\"firstRecordId\":"
+#define OLDEST_RECORD_ID   "\"oldestRecordId\":"
+#define RECORD_ID_OF_RESET 1000    // main.c continues behind the block of record ids reserved in NVS after a reset
+
+typedef enum {
+   RESPONSE_OK,
+   RESPONSE_TIMED_OUT,     // the service stored the envelope but the response did not arrive
+   NOT_STORED
+} Outcome;
+
+static PENDING_MESSAGES pendingMessages;
+static bool deliveryUnknown = false;
+
+/*
+ * The stand-in for the service counts how often each record arrived and acknowledges the highest record id up to 
+ * which it stored all records from the oldest record id the sensor still keeps on.
+ */
+static int receivedCount[MAX_RECORDS];
+static uint32_t oldestRecordId = 0;
+static char responseBody[32];
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+static uint32_t readRecordId(const char *envelope, const char *name) {
+   return strtoul(strstr(envelope, name) + strlen(name), NULL, 10);
+}
+
+static void storeEnvelope(const char *envelope) {
+   uint32_t recordId       = readRecordId(envelope, FIRST_RECORD_ID);
+   uint32_t oldestOfSensor = readRecordId(envelope, OLDEST_RECORD_ID);
+   oldestRecordId          = (oldestOfSensor > oldestRecordId) ? oldestOfSensor : oldestRecordId;
+   for (const char *message = strstr(envelope, MESSAGE_MARKER); message != NULL; message = strstr(message + 1, MESSAGE_MARKER)) {
+      receivedCount[recordId++]++;
+   }
+}
+
+static const char* respond() {
+   int highestRecordId = (int)oldestRecordId - 1;
+   while (highestRecordId + 1 < MAX_RECORDS && receivedCount[highestRecordId + 1] > 0) {
+      highestRecordId++;
+   }
+   responseBody[0] = 0;
+   if (highestRecordId >= 0) {
+      sprintf(responseBody, "{\"ack\":%d}", highestRecordId);
+   }
+   return responseBody;
+}
+
+/*
+ * Publishes like main.c does after a measurement cycle: only the newest message gets published as long as it is open
+ * which messages the service stored.
+ */
+static MESSAGE_RANGE publish(PublishOrder order, Outcome outcome) {
+   MESSAGE_RANGE range = selectLiveMessagesToPublish(&pendingMessages, !deliveryUnknown, order);
+   char *envelope      = createJsonEnvelopeForRange(&pendingMessages, range.first, range.count, 0);
+   UPLINK_RESULT result = { 0, false, 0, false, 0 };
+
+   if (outcome != NOT_STORED) {
+      storeEnvelope(envelope);
+   }
+   if (outcome == RESPONSE_OK) {
+      result.httpStatusCode = 200;
+      result.acknowledged   = parseAcknowledgement(respond(), &result.acknowledgedRecordId);
+   } else if (outcome == RESPONSE_TIMED_OUT) {
+      result.httpStatusCode   = -1;
+      result.deadlineExceeded = true;
+   } else {
+      result.httpStatusCode = 500;
+   }
+   release(envelope);
+
+   deliveryUnknown         = isDeliveryUnknown(deliveryUnknown, &pendingMessages, range, &result);
+   MESSAGE_RANGE delivered = getDeliveredMessages(&pendingMessages, range, &result);
+   removePendingMessages(&pendingMessages, delivered.first, delivered.count);
+   return range;
+}
+
+static void assertRecordsReceivedOnce(uint32_t firstRecordId, char const * description) {
+   for (uint32_t recordId = firstRecordId; recordId < pendingMessages.nextRecordNumber; recordId++) {
+      assertIntEqual(receivedCount[recordId], 1, description);
+   }
+}
+
+static void assertEachRecordReceivedOnce(char const * description) {
+   assertRecordsReceivedOnce(0, description);
+}
+
+int main(int argc, char* argv[]) {  
+   initializePendingMessages(&pendingMessages);
+
+   // the acknowledgement of the next envelope covers the one whose response timed out
+   addToPendingMessages(&pendingMessages, "{\"m\":[1]}");
+   addToPendingMessages(&pendingMessages, "{\"m\":[2]}");
+   addToPendingMessages(&pendingMessages, "{\"m\":[3]}");
+   publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_TIMED_OUT);
+   assertIntEqual(pendingMessages.count, 3, "messages stay pending without a response");
+   assertIntEqual(deliveryUnknown, true, "delivery unknown without a response");
+   addToPendingMessages(&pendingMessages, "{\"m\":[4]}");
+   MESSAGE_RANGE published = publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_OK);
+   assertIntEqual(published.count, 1, "only the newest message after a timed out response");
+   assertIntEqual(pendingMessages.count, 0, "acknowledgement removes the messages of the timed out envelope");
+   assertIntEqual(deliveryUnknown, false, "acknowledgement settles the delivery");
+   assertEachRecordReceivedOnce("nothing sent again after a timed out response");
+
+   // newest first: the acknowledgement of the live message lies before its envelope while older messages are missing
+   addToPendingMessages(&pendingMessages, "{\"m\":[5]}");
+   publish(PUBLISH_ORDER_NEWEST_FIRST, NOT_STORED);
+   assertIntEqual(deliveryUnknown, false, "error response settles the delivery");
+   addToPendingMessages(&pendingMessages, "{\"m\":[6]}");
+   publish(PUBLISH_ORDER_NEWEST_FIRST, RESPONSE_OK);
+   assertIntEqual(pendingMessages.count, 1, "live message delivered, the missing one stays pending");
+   assertIntEqual(pendingMessages.recordNumber[0], 4, "missing message stays pending");
+   published = publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_OK);
+   assertIntEqual(published.count, 1, "backfill of the missing message");
+   assertIntEqual(pendingMessages.count, 0, "backfill acknowledged");
+   assertEachRecordReceivedOnce("nothing sent again with newest first");
+
+   // newest first with a timed out response
+   addToPendingMessages(&pendingMessages, "{\"m\":[7]}");
+   publish(PUBLISH_ORDER_NEWEST_FIRST, RESPONSE_TIMED_OUT);
+   addToPendingMessages(&pendingMessages, "{\"m\":[8]}");
+   publish(PUBLISH_ORDER_NEWEST_FIRST, RESPONSE_OK);
+   assertIntEqual(pendingMessages.count, 0, "acknowledgement of the live message removes the timed out one");
+   assertEachRecordReceivedOnce("nothing sent again with newest first after a timed out response");
+
+   // the service does not acknowledge: the status code decides as before
+   addToPendingMessages(&pendingMessages, "{\"m\":[9]}");
+   publish(PUBLISH_ORDER_OLDEST_FIRST, NOT_STORED);
+   assertIntEqual(pendingMessages.count, 1, "message stays pending after an error response");
+   publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_OK);
+   assertIntEqual(pendingMessages.count, 0, "message delivered after an error response");
+
+   // the oldest message gets dropped when too many are pending, the service does not wait for it
+   for (int i = 0; i <= MAX_NUMBER_OF_MESSAGES_TO_KEEP; i++) {
+      addToPendingMessages(&pendingMessages, "{\"m\":[10]}");
+   }
+   uint32_t droppedRecordId = pendingMessages.recordNumber[0] - 1;
+   publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_TIMED_OUT);
+   addToPendingMessages(&pendingMessages, "{\"m\":[11]}");
+   published = publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_OK);
+   assertIntEqual(published.count, 1, "only the newest message after a timed out response");
+   assertIntEqual(pendingMessages.count, 0, "acknowledgement after a dropped message removes the timed out envelope");
+   assertIntEqual(receivedCount[droppedRecordId], 0, "dropped message never arrives");
+   assertRecordsReceivedOnce(droppedRecordId + 1, "nothing sent again after a dropped message");
+
+   // a reset loses the pending messages and continues behind the reserved record ids
+   pendingMessages.nextRecordNumber = RECORD_ID_OF_RESET;
+   deliveryUnknown                  = false;
+   addToPendingMessages(&pendingMessages, "{\"m\":[12]}");
+   publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_TIMED_OUT);
+   addToPendingMessages(&pendingMessages, "{\"m\":[13]}");
+   published = publish(PUBLISH_ORDER_OLDEST_FIRST, RESPONSE_OK);
+   assertIntEqual(published.count, 1, "only the newest message after a timed out response");
+   assertIntEqual(pendingMessages.count, 0, "acknowledgement after a reset removes the timed out envelope");
+   assertRecordsReceivedOnce(RECORD_ID_OF_RESET, "nothing sent again after a reset");
+
+   clearPendingMessages(&pendingMessages);
+   return 0;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/AllocationStatistics.h"
+
+static void assertEqual(char const * actual, char const * expected, char const * description) {
+   if (strcmp(actual, expected) != 0) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %s\n", expected);
+      printf("\tactual  : %s\n\n", actual);
+   }
+}
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   assertIntEqual(getLatencyBucket(0), 0, "latency bucket of 0 us");
+   assertIntEqual(getLatencyBucket(1), 1, "latency bucket of 1 us");
+   assertIntEqual(getLatencyBucket(3), 2, "latency bucket of 3 us");
+   assertIntEqual(getLatencyBucket(4), 3, "latency bucket of 4 us");
+   assertIntEqual(getLatencyBucket(100000), LATENCY_BUCKET_COUNT - 1, "slow allocations go to the last bucket");
+
+   uint64_t storage[4];
+   char *pointer = writeAllocationHeader(storage, ALLOCATION_TAG_ENVELOPE, 17);
+   assertIntEqual(pointer - (char*)storage, ALLOCATION_HEADER_SIZE, "header in front of the storage");
+   AllocationTag tag;
+   size_t size;
+   assertIntEqual(readAllocationHeader(pointer, &tag, &size) == (void*)storage, 1, "storage of the header");
+   assertIntEqual(tag, ALLOCATION_TAG_ENVELOPE, "tag of the header");
+   assertIntEqual(size, 17, "size of the header");
+
+   recordAllocation(ALLOCATION_TAG_PAYLOAD, 100, 0);
+   recordAllocation(ALLOCATION_TAG_PAYLOAD, 50, 3);
+   recordAllocation(ALLOCATION_TAG_AT_COMMAND, 20, 3);
+   recordRelease(ALLOCATION_TAG_PAYLOAD, 100);
+   recordAllocation(ALLOCATION_TAG_PAYLOAD, 30, 0);
+   const ALLOCATION_STATISTICS *payload = getAllocationStatistics(ALLOCATION_TAG_PAYLOAD);
+   assertIntEqual(payload->allocations, 3, "allocations");
+   assertIntEqual(payload->releases, 1, "releases");
+   assertIntEqual(payload->bytes, 180, "allocated bytes");
+   assertIntEqual(payload->liveBytes, 80, "live bytes");
+   assertIntEqual(payload->peakLiveBytes, 150, "peak live bytes of the tag");
+   assertIntEqual(payload->latencyHistogram[0], 2, "latency histogram bucket 0");
+   assertIntEqual(payload->latencyHistogram[2], 1, "latency histogram bucket 2");
+   assertIntEqual(getPeakLiveBytes(), 170, "peak live bytes of all tags");
+
+   recordRelease(ALLOCATION_TAG_AT_COMMAND, 1000);
+   assertIntEqual(getAllocationStatistics(ALLOCATION_TAG_AT_COMMAND)->liveBytes, 0, "live bytes do not underflow");
+   recordAllocation(ALLOCATION_TAG_COUNT, 10, 0);
+   assertIntEqual(getAllocationStatistics(ALLOCATION_TAG_COUNT) == NULL, 1, "invalid tag");
+
+   char buffer[200];
+   HEAP_STATISTICS heap = { 120000, 60000, 90000 };
+   int length = formatMemoryStatistics(buffer, sizeof(buffer), &heap);
+   assertEqual(buffer, "{\"heap\":[120000,60000,90000],\"peak\":170,\"payload\":[3,180,150],\"envelope\":[0,0,0],\"atCommand\":[1,20,20],\"httpRequest\":[0,0,0]}", "formatted statistics");
+   assertIntEqual(length, strlen(buffer), "length of the formatted statistics");
+   assertIntEqual(formatMemoryStatistics(buffer, 20, &heap), -1, "buffer too small");
+   assertIntEqual(formatMemoryStatistics(buffer, length, &heap), -1, "no space for the null byte");
+
+   resetAllocationStatistics();
+   payload = getAllocationStatistics(ALLOCATION_TAG_PAYLOAD);
+   assertIntEqual(payload->allocations, 0, "reset allocations");
+   assertIntEqual(payload->liveBytes, 80, "reset keeps the live bytes");
+   assertIntEqual(payload->peakLiveBytes, 80, "peak starts at the live bytes");
+   assertIntEqual(getPeakLiveBytes(), 80, "total peak starts at the live bytes");
+
+   assertIntEqual(strcmp(getAllocationTagName(ALLOCATION_TAG_HTTP_REQUEST), "httpRequest"), 0, "tag name");
+   assertIntEqual(strcmp(getAllocationTagName(ALLOCATION_TAG_COUNT), "unknown"), 0, "unknown tag name");
+
+   return 0;
+}
\ No newline at end of file
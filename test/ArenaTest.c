@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/Arena.h"
+
+static uint8_t region[64] __attribute__((aligned(ARENA_ALIGNMENT)));
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+   ARENA arena;
+   initializeArena(&arena, region, sizeof(region));
+   assertIntEqual(arena.statistics.sizeInBytes, 64, "size of the region");
+
+   uint8_t *first  = allocateFromArena(&arena, 5);
+   uint8_t *second = allocateFromArena(&arena, 8);
+   assertIntEqual(first == region, 1, "first allocation starts at the region");
+   assertIntEqual(second - first, 8, "allocations are aligned");
+   assertIntEqual(arena.statistics.usedBytes, 16, "used bytes");
+   assertIntEqual(arena.statistics.liveAllocations, 2, "live allocations");
+   assertIntEqual(isInArena(&arena, second), 1, "pointer in arena");
+   
+   int onHeap = 0;
+   assertIntEqual(isInArena(&arena, &onHeap), 0, "pointer outside of arena");
+
+   assertIntEqual(allocateFromArena(&arena, 49) == NULL, 1, "overflow returns NULL");
+   assertIntEqual(arena.statistics.overflows, 1, "overflow count");
+   assertIntEqual(allocateFromArena(&arena, 48) != NULL, 1, "remaining space can be used");
+   assertIntEqual(arena.statistics.usedBytes, 64, "arena full");
+   assertIntEqual(allocateFromArena(&arena, 0) == NULL, 1, "empty allocation needs space too");
+
+   assertIntEqual(resetArena(&arena), 0, "reset refused while allocations are in use");
+   assertIntEqual(arena.statistics.refusedResets, 1, "refused resets");
+   assertIntEqual(arena.statistics.usedBytes, 64, "refused reset keeps the allocations");
+
+   releaseToArena(&arena, first);
+   releaseToArena(&arena, second);
+   releaseToArena(&arena, region + 16);
+   releaseToArena(&arena, &onHeap);
+   assertIntEqual(arena.statistics.liveAllocations, 0, "all allocations released");
+   releaseToArena(&arena, first);
+   assertIntEqual(arena.statistics.liveAllocations, 0, "releasing twice does not underflow");
+
+   assertIntEqual(resetArena(&arena), 1, "reset");
+   assertIntEqual(arena.statistics.usedBytes, 0, "reset frees the whole region");
+   assertIntEqual(arena.statistics.highWaterBytes, 64, "high water mark survives the reset");
+   assertIntEqual(allocateFromArena(&arena, 1) == region, 1, "region gets reused after the reset");
+   assertIntEqual(arena.statistics.allocations, 4, "allocation count");
+   assertIntEqual(arena.statistics.resets, 1, "reset count");
+
+   assertIntEqual(allocateFromArena(&arena, SIZE_MAX) == NULL, 1, "huge allocation does not wrap around");
+
+   ARENA emptyArena;
+   initializeArena(&emptyArena, NULL, 100);
+   assertIntEqual(allocateFromArena(&emptyArena, 1) == NULL, 1, "arena without region");
+   assertIntEqual(isInArena(&emptyArena, NULL), 0, "NULL is not in an arena without region");
+
+   return 0;
+}
\ No newline at end of file
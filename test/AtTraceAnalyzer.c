@@ -0,0 +1,161 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/AtTrace.h"
+
+/*
+ * Reads a log of the sensor (file or stdin) containing the lines of dumpGsmModuleAtTrace() and prints the latency 
+ * statistics per command and expected responses, e.g. 
+ *
+ *    idf.py monitor | tee sensor.log
+ *    atTraceAnalyzer sensor.log
+ *
+ * The percentiles and the histogram contain only the responses received in time.
+ */
+
+#define MAX_LINE_LENGTH    1024
+#define BUCKET_COUNT       16
+
+typedef struct {
+   char key[AT_TRACE_KEY_LENGTH];
+   uint32_t *latenciesUs;
+   int count;
+   int capacity;
+   int timeouts;
+   uint32_t timeoutMs;
+   uint32_t buckets[BUCKET_COUNT];
+} COMMAND_STATISTICS;
+
+static void* allocateOrExit(void *pointer, size_t size) {
+   void *result = realloc(pointer, size);
+   if (result == NULL) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+   }
+   return result;
+}
+
+static int compareLatencies(const void *a, const void *b) {
+   uint32_t first  = *(const uint32_t*)a;
+   uint32_t second = *(const uint32_t*)b;
+   return (first > second) - (first < second);
+}
+
+/*
+ * Bucket 0 contains the latencies below 1 ms, bucket i (i > 0) those from 2^(i-1) till 2^i - 1 ms and the last bucket
+ * all longer ones.
+ */
+static int getBucket(uint32_t latencyUs) {
+   uint32_t latencyMs = latencyUs / 1000;
+   int bucket         = 0;
+   while (latencyMs > 0 && bucket < BUCKET_COUNT - 1) {
+      latencyMs >>= 1;
+      bucket++;
+   }
+   return bucket;
+}
+
+static COMMAND_STATISTICS* getStatistics(COMMAND_STATISTICS **statistics, int *statisticsCount, const char *key) {
+   for (int i = 0; i < *statisticsCount; i++) {
+      if (strcmp((*statistics)[i].key, key) == 0) {
+         return &(*statistics)[i];
+      }
+   }
+   *statistics                  = allocateOrExit(*statistics, (*statisticsCount + 1) * sizeof(COMMAND_STATISTICS));
+   COMMAND_STATISTICS *created  = &(*statistics)[(*statisticsCount)++];
+   memset(created, 0, sizeof(COMMAND_STATISTICS));
+   strcpy(created->key, key);
+   return created;
+}
+
+static void addSample(COMMAND_STATISTICS *statistics, const AT_TRACE_SAMPLE *sample) {
+   if (sample->timeoutMs > statistics->timeoutMs) {
+      statistics->timeoutMs = sample->timeoutMs;
+   }
+   if (sample->timedOut) {
+      statistics->timeouts++;
+      return;
+   }
+   if (statistics->count == statistics->capacity) {
+      statistics->capacity    = (statistics->capacity == 0) ? 16 : 2 * statistics->capacity;
+      statistics->latenciesUs = allocateOrExit(statistics->latenciesUs, statistics->capacity * sizeof(uint32_t));
+   }
+   statistics->latenciesUs[statistics->count++] = sample->latencyUs;
+   statistics->buckets[getBucket(sample->latencyUs)]++;
+}
+
+static void printHistogram(const COMMAND_STATISTICS *statistics) {
+   printf("      ");
+   for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+      if (statistics->buckets[bucket] > 0) {
+         if (bucket == 0) {
+            printf(" <1 ms: %u", statistics->buckets[bucket]);
+         } else if (bucket == BUCKET_COUNT - 1) {
+            printf(" >=%u ms: %u", 1u << (bucket - 1), statistics->buckets[bucket]);
+         } else {
+            printf(" %u-%u ms: %u", 1u << (bucket - 1), (1u << bucket) - 1, statistics->buckets[bucket]);
+         }
+      }
+   }
+   printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+   FILE *input = stdin;
+   if (argc > 1) {
+      input = fopen(argv[1], "r");
+      if (input == NULL) {
+         fprintf(stderr, "cannot open %s\n", argv[1]);
+         return 1;
+      }
+   }
+
+   char line[MAX_LINE_LENGTH];
+   AT_TRACE_RECORD *records = NULL;
+   int recordCount          = 0;
+   int recordCapacity       = 0;
+
+   while (fgets(line, sizeof(line), input) != NULL) {
+      AT_TRACE_RECORD record;
+      if (decodeAtTraceRecord(line, &record)) {
+         if (recordCount == recordCapacity) {
+            recordCapacity = (recordCapacity == 0) ? 256 : 2 * recordCapacity;
+            records        = allocateOrExit(records, recordCapacity * sizeof(AT_TRACE_RECORD));
+         }
+         records[recordCount++] = record;
+      }
+   }
+   if (input != stdin) {
+      fclose(input);
+   }
+
+   AT_TRACE_SAMPLE *samples = allocateOrExit(NULL, (recordCount + 1) * sizeof(AT_TRACE_SAMPLE));
+   int sampleCount          = extractAtTraceSamples(records, recordCount, samples, recordCount);
+   COMMAND_STATISTICS *statistics = NULL;
+   int statisticsCount            = 0;
+
+   for (int i = 0; i < sampleCount; i++) {
+      addSample(getStatistics(&statistics, &statisticsCount, samples[i].key), &samples[i]);
+   }
+
+   printf("%d records, %d responses\n\n", recordCount, sampleCount);
+   printf("%-52s %6s %8s %10s %9s %9s %9s\n", "command -> expected responses", "count", "timeouts", "timeout ms", "p50 ms", "p95 ms", "max ms");
+
+   for (int i = 0; i < statisticsCount; i++) {
+      COMMAND_STATISTICS *entry = &statistics[i];
+      qsort(entry->latenciesUs, entry->count, sizeof(uint32_t), compareLatencies);
+      printf("%-52s %6d %8d %10u %9.1f %9.1f %9.1f\n", entry->key, entry->count + entry->timeouts, entry->timeouts, entry->timeoutMs,
+         getSortedPercentileUs(entry->latenciesUs, entry->count, 50) / 1000.0, getSortedPercentileUs(entry->latenciesUs, entry->count, 95) / 1000.0,
+         getSortedPercentileUs(entry->latenciesUs, entry->count, 100) / 1000.0);
+      printHistogram(entry);
+      free(entry->latenciesUs);
+   }
+
+   free(statistics);
+   free(samples);
+   free(records);
+   return 0;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/AtTrace.h"
+
+static void assertEqual(char const * actual, char const * expected, char const * description) {
+   if (strcmp(actual, expected) != 0) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %s\n", expected);
+      printf("\tactual  : %s\n\n", actual);
+   }
+}
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+   AT_TRACE trace;
+   AT_TRACE_RECORD records[4];
+   AT_TRACE_RECORD record;
+   AT_TRACE_RECORD taken[8];
+   AT_TRACE_SAMPLE samples[8];
+   char key[AT_TRACE_TEXT_LENGTH];
+   char line[AT_TRACE_LINE_LENGTH + 1];
+
+   getAtCommandKey("AT+CREG?", key, sizeof(key));
+   assertEqual(key, "AT+CREG", "key of a query");
+   getAtCommandKey("AT+HTTPPARA=\"URL\",\"www.my-service.com\"", key, sizeof(key));
+   assertEqual(key, "AT+HTTPPARA", "key of a command with parameters");
+   getAtCommandKey("ATE0", key, sizeof(key));
+   assertEqual(key, "ATE0", "key of a command without parameters");
+   getAtCommandKey("{\"version\":\"1.0.0\"}", key, sizeof(key));
+   assertEqual(key, "<data>", "key of data");
+   getAtCommandKey("AT+SOMEVERYLONGCOMMANDNAME=1", key, 8);
+   assertEqual(key, "AT+SOME", "truncated key");
+
+   initializeAtTrace(&trace, records, 4);
+   assertIntEqual(takeAtTraceRecord(&trace, &record), 0, "empty trace");
+   recordAtTrace(&trace, 1000, AT_TRACE_COMMAND, "AT+HTTPACTION=0", 0);
+   recordAtTrace(&trace, 250000, AT_TRACE_RESPONSE, "OK", 5000);
+   assertIntEqual(takeAtTraceRecord(&trace, &record), 1, "take command");
+   assertEqual(record.text, "AT+HTTPACTION", "command gets reduced to its key");
+   assertIntEqual(takeAtTraceRecord(&trace, &record), 1, "take response");
+   assertIntEqual(record.kind, AT_TRACE_RESPONSE, "kind of the response");
+   assertIntEqual(record.timeoutMs, 5000, "timeout of the response");
+   assertIntEqual(takeAtTraceRecord(&trace, &record), 0, "trace empty again");
+
+   for (int i = 0; i < 6; i++) {
+      recordAtTrace(&trace, i, AT_TRACE_COMMAND, "AT", 0);
+   }
+   assertIntEqual(trace.lostRecords, 2, "oldest records get overwritten");
+   takeAtTraceRecord(&trace, &record);
+   assertIntEqual(record.timestampUs, 2, "oldest remaining record first");
+
+   record.timestampUs = 0x12345678;
+   record.timeoutMs   = 20000;
+   record.kind        = AT_TRACE_TIMEOUT;
+   strcpy(record.text, "CONNECT OK|ALREADY CONN");
+   assertIntEqual(encodeAtTraceRecord(&record, line, sizeof(line)), AT_TRACE_LINE_LENGTH, "length of the line");
+   assertIntEqual(strncmp(line, "attrace:78563412204e000002434f4e4e", 34), 0, "little endian hex");
+   assertIntEqual(encodeAtTraceRecord(&record, line, 10), -1, "buffer too small");
+   
+   char logLine[100];
+   encodeAtTraceRecord(&record, line, sizeof(line));
+   snprintf(logLine, sizeof(logLine), "I (123456) GSM-module: %s\n", line);
+   memset(&taken[0], 0, sizeof(AT_TRACE_RECORD));
+   assertIntEqual(decodeAtTraceRecord(logLine, &taken[0]), 1, "decode a log line");
+   assertIntEqual(taken[0].timestampUs, 0x12345678, "decoded timestamp");
+   assertIntEqual(taken[0].timeoutMs, 20000, "decoded timeout");
+   assertIntEqual(taken[0].kind, AT_TRACE_TIMEOUT, "decoded kind");
+   assertEqual(taken[0].text, "CONNECT OK|ALREADY CONN", "decoded text");
+   assertIntEqual(decodeAtTraceRecord("I (123) main: publishment finished", &record), 0, "line without record");
+   assertIntEqual(decodeAtTraceRecord("attrace:7856", &record), 0, "truncated record");
+
+   initializeAtTrace(&trace, records, 4);
+   recordAtTrace(&trace, 100, AT_TRACE_RESPONSE, "RDY", 5000);
+   recordAtTrace(&trace, 1000, AT_TRACE_COMMAND, "AT+HTTPACTION=0", 0);
+   recordAtTrace(&trace, 51000, AT_TRACE_RESPONSE, "OK", 5000);
+   recordAtTrace(&trace, 2001000, AT_TRACE_TIMEOUT, "+HTTPACTION:", 2000);
+   int count = 0;
+   while (takeAtTraceRecord(&trace, &taken[count])) {
+      count++;
+   }
+   assertIntEqual(extractAtTraceSamples(taken, count, samples, 8), 3, "one sample per response");
+   assertEqual(samples[0].key, "- -> RDY", "response without command");
+   assertIntEqual(samples[0].latencyUs, 0, "no latency without previous record");
+   assertEqual(samples[1].key, "AT+HTTPACTION -> OK", "key of a response");
+   assertIntEqual(samples[1].latencyUs, 50000, "latency since the command");
+   assertIntEqual(samples[1].timedOut, 0, "response in time");
+   assertEqual(samples[2].key, "AT+HTTPACTION -> +HTTPACTION:", "second response of the same command");
+   assertIntEqual(samples[2].latencyUs, 2000000, "latency of the second response");
+   assertIntEqual(samples[2].timedOut, 1, "timeout");
+   assertIntEqual(samples[2].timeoutMs, 2000, "timeout of the sample");
+   assertIntEqual(extractAtTraceSamples(taken, count, samples, 1), 1, "limited number of samples");
+
+   taken[0].kind        = AT_TRACE_COMMAND;
+   taken[0].timestampUs = 0xfffffff0;
+   taken[1].kind        = AT_TRACE_RESPONSE;
+   taken[1].timestampUs = 0x10;
+   extractAtTraceSamples(taken, 2, samples, 8);
+   assertIntEqual(samples[0].latencyUs, 0x20, "latency across the wrap around of the timestamp");
+
+   uint32_t latencies[] = { 10, 20, 30, 40, 50, 60, 70, 80, 90, 100 };
+   assertIntEqual(getSortedPercentileUs(latencies, 10, 50), 50, "median");
+   assertIntEqual(getSortedPercentileUs(latencies, 10, 95), 100, "95th percentile");
+   assertIntEqual(getSortedPercentileUs(latencies, 10, 0), 10, "minimum");
+   assertIntEqual(getSortedPercentileUs(latencies, 0, 50), 0, "no latencies");
+   assertEqual(getAtTraceKindName(AT_TRACE_TIMEOUT), "timeout", "kind name");
+
+   return 0;
+}
\ No newline at end of file
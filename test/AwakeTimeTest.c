@@ -0,0 +1,54 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/AwakeTime.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   resetAwakeTimeStatistics(1000);
+   assertIntEqual(getAwakeTimeStatistics(1000)->completedMinutes, 0, "no minute completed after reset");
+
+   markAwake(11000);
+   markAwake(12000);
+   markAsleep(14000);
+   assertIntEqual(getAwakeTimeStatistics(30000)->lastMinuteAwakeMs, 0, "minute not yet completed");
+   assertIntEqual(getAwakeTimeStatistics(61000)->lastMinuteAwakeMs, 3000, "awake time of first minute");
+   assertIntEqual(getAwakeTimeStatistics(61000)->completedMinutes, 1, "one minute completed");
+   assertIntEqual(getAwakeTimeStatistics(61000)->wakeUps, 1, "waking up an awake radio does not count");
+
+   markAwake(111000);
+   markAsleep(131000);
+   assertIntEqual(getAwakeTimeStatistics(131000)->lastMinuteAwakeMs, 10000, "awake time gets split at the end of the minute");
+   assertIntEqual(getAwakeTimeStatistics(181000)->lastMinuteAwakeMs, 10000, "awake time of the following minute");
+   assertIntEqual(getAwakeTimeStatistics(181000)->maxMinuteAwakeMs, 10000, "max awake time");
+   assertIntEqual(getAwakeTimeStatistics(181000)->totalAwakeMs, 23000, "total awake time");
+
+   markAwake(181000);
+   const AWAKE_TIME_STATISTICS *statistics = getAwakeTimeStatistics(361000);
+   assertIntEqual(statistics->lastMinuteAwakeMs, 60000, "awake for whole minutes");
+   assertIntEqual(statistics->completedMinutes, 6, "minutes completed while awake");
+   assertIntEqual(statistics->wakeUps, 3, "wake ups");
+
+   recordReconnectLatency(0);
+   recordReconnectLatency(4000);
+   assertIntEqual(statistics->lastReconnectMs, 4000, "last reconnect latency");
+   assertIntEqual(statistics->smoothedReconnectMs, 1000, "smoothed reconnect latency");
+   assertIntEqual(statistics->maxReconnectMs, 4000, "max reconnect latency");
+   assertIntEqual(statistics->reconnects, 2, "reconnects");
+
+   resetAwakeTimeStatistics(0);
+   assertIntEqual(getAwakeTimeStatistics(0)->reconnects, 0, "statistics reset");
+
+   return 0;
+}
\ No newline at end of file
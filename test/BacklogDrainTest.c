@@ -0,0 +1,54 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/BacklogDrain.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   assertIntEqual(isBacklogDrainActive(), 0, "no drain after the start");
+   assertIntEqual(getBacklogDrainThroughput(1000), 0, "no throughput without drain");
+
+   recordDrainedEnvelope(5, 2000);
+   assertIntEqual(getBacklogDrainStatistics()->envelopes, 0, "envelopes outside of a drain do not get counted");
+
+   startBacklogDrain(10000);
+   assertIntEqual(isBacklogDrainActive(), 1, "drain is active after the start");
+   assertIntEqual(getBacklogDrainStatistics()->drains, 1, "drains get counted");
+
+   recordDrainedEnvelope(5, 2000);
+   recordDrainedEnvelope(3, 1200);
+   assertIntEqual(getBacklogDrainStatistics()->envelopes, 2, "envelopes of the drain");
+   assertIntEqual(getBacklogDrainStatistics()->records, 8, "records of the drain");
+   assertIntEqual(getBacklogDrainStatistics()->bytes, 3200, "bytes of the drain");
+   assertIntEqual(getBacklogDrainThroughput(14000), 2000, "throughput of an active drain lasts till now");
+
+   stopBacklogDrain(15000, true);
+   assertIntEqual(isBacklogDrainActive(), 0, "drain is inactive after the stop");
+   assertIntEqual(getBacklogDrainStatistics()->completed, 1, "completed drain");
+   assertIntEqual(getBacklogDrainStatistics()->durationMs, 5000, "duration of the drain");
+   assertIntEqual(getBacklogDrainThroughput(99000), 1600, "throughput of a finished drain in thousandths");
+
+   stopBacklogDrain(20000, false);
+   assertIntEqual(getBacklogDrainStatistics()->durationMs, 5000, "stopping an inactive drain changes nothing");
+
+   startBacklogDrain(30000);
+   assertIntEqual(getBacklogDrainStatistics()->records, 0, "a new drain resets the counters");
+   assertIntEqual(getBacklogDrainStatistics()->drains, 2, "drains get counted across drains");
+   recordDrainedEnvelope(1, 500);
+   stopBacklogDrain(33000, false);
+   assertIntEqual(getBacklogDrainStatistics()->completed, 0, "failed drain");
+   assertIntEqual(getBacklogDrainThroughput(33000), 333, "throughput of a failed drain");
+
+   return 0;
+}
\ No newline at end of file
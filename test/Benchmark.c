@@ -0,0 +1,271 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../main/MessageFormatter.h"
+#include "../main/ErrorMessages.h"
+#include "../main/Messages.h"
+#include "HeapUsage.h"
+#include "TestingMemory.h"
+
+/*
+ * Measures the duration, the heap allocations and the peak heap usage of the formatting and the bookkeeping of the 
+ * messages on the host. 
+ *
+ *    benchmark [--csv | --json] [--iterations N] [--compare baseline.csv] [--tolerance PERCENT]
+ *
+ * Each case runs ROUNDS times and the fastest round counts, because the host schedules other processes too. The 
+ * comparison mode flags each case that is more than PERCENT (default 25) slower than the baseline (created with 
+ * --csv on the same machine) or needs more allocations or more heap, and exits with 1 if at least one regressed.
+ *
+ * The heap usage gets measured with HeapUsage.h to count the allocations of Messages.c too, which does not use 
+ * allocate(...).
+ */
+
+#define DEFAULT_ITERATIONS       20000
+#define DEFAULT_TOLERANCE        25
+#define MEASUREMENT_COUNT        60
+#define MAX_CASE_COUNT           16
+#define MAX_NAME_LENGTH          32
+#define MAX_LINE_LENGTH          200
+#define ERRORS_PER_CLEAR         8
+#define ROUNDS                   5
+
+typedef enum {
+   OUTPUT_TABLE,
+   OUTPUT_CSV,
+   OUTPUT_JSON
+} OutputFormat;
+
+typedef struct {
+   char name[MAX_NAME_LENGTH];
+   int iterations;
+   double nsPerCall;
+   double allocationsPerCall;
+   long peakHeapBytes;
+} RESULT;
+
+typedef void (*BenchmarkFunction)(int iteration);
+
+static uint16_t anemometerPulses[MEASUREMENT_COUNT];
+static uint16_t directionVaneValues[MEASUREMENT_COUNT];
+static PENDING_MESSAGES pendingMessages;
+static char *payload = NULL;
+
+static RESULT results[MAX_CASE_COUNT];
+static int resultCount = 0;
+
+static uint64_t nanoseconds() {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static void benchmarkPayload(int iteration) {
+   release(createJsonPayload(anemometerPulses, directionVaneValues, MEASUREMENT_COUNT, 60));
+}
+
+static void benchmarkEnvelope(int iteration) {
+   release(createJsonEnvelope(&pendingMessages));
+}
+
+static void benchmarkPendingMessagesChurn(int iteration) {
+   addToPendingMessages(&pendingMessages, payload);
+}
+
+static void benchmarkErrorMessages(int iteration) {
+   if (iteration % ERRORS_PER_CLEAR == 0) {
+      clearErrorMessages();
+   }
+   addErrorMessage("HTTP_RESPONSE_CODE_500");
+   getErrorMessages();
+}
+
+static void run(const char *name, BenchmarkFunction function, int iterations) {
+   if (resultCount >= MAX_CASE_COUNT) {
+      return;
+   }
+   
+   // warm up caches and reach the steady state (e.g. full pending messages)
+   for (int i = 0; i < iterations / 10; i++) {
+      function(i);
+   }
+
+   RESULT *result          = &results[resultCount++];
+   uint64_t mallocsAtStart = getHeapAllocationCount();
+   long heapAtStart        = getLiveHeapBytes();
+   resetPeakHeapBytes();
+   uint64_t durationNs     = UINT64_MAX;
+
+   for (int round = 0; round < ROUNDS; round++) {
+      uint64_t startedAt = nanoseconds();
+      for (int i = 0; i < iterations; i++) {
+         function(i);
+      }
+      uint64_t roundDurationNs = nanoseconds() - startedAt;
+      durationNs               = (roundDurationNs < durationNs) ? roundDurationNs : durationNs;
+   }
+
+   snprintf(result->name, sizeof(result->name), "%s", name);
+   result->iterations         = iterations;
+   result->nsPerCall          = (double)durationNs / iterations;
+   result->allocationsPerCall = (double)(getHeapAllocationCount() - mallocsAtStart) / ((uint64_t)ROUNDS * iterations);
+   result->peakHeapBytes      = getPeakHeapBytes() - heapAtStart;
+}
+
+static void fillPendingMessages(int count) {
+   clearPendingMessages(&pendingMessages);
+   for (int i = 0; i < count; i++) {
+      addToPendingMessages(&pendingMessages, payload);
+   }
+}
+
+static void runAll(int iterations) {
+   char name[MAX_NAME_LENGTH];
+
+   for (int i = 0; i < MEASUREMENT_COUNT; i++) {
+      anemometerPulses[i]    = (i * 7) % 90;
+      directionVaneValues[i] = (i * 37) % 1024;
+   }
+   initializePendingMessages(&pendingMessages);
+   clearErrorMessages();
+   payload = createJsonPayload(anemometerPulses, directionVaneValues, MEASUREMENT_COUNT, 60);
+
+   run("createJsonPayload", benchmarkPayload, iterations);
+
+   for (int depth = 0; depth <= MAX_NUMBER_OF_MESSAGES_TO_KEEP; depth++) {
+      fillPendingMessages(depth);
+      snprintf(name, sizeof(name), "createJsonEnvelope_%d", depth);
+      run(name, benchmarkEnvelope, iterations);
+   }
+
+   fillPendingMessages(MAX_NUMBER_OF_MESSAGES_TO_KEEP);
+   run("addToPendingMessages", benchmarkPendingMessagesChurn, iterations);
+   clearPendingMessages(&pendingMessages);
+
+   run("addErrorMessage", benchmarkErrorMessages, iterations);
+   clearErrorMessages();
+
+   release(payload);
+}
+
+static void printResults(OutputFormat format) {
+   if (format == OUTPUT_CSV) {
+      printf("name,iterations,ns_per_call,allocations_per_call,peak_heap_bytes\n");
+   } else if (format == OUTPUT_JSON) {
+      printf("[");
+   } else {
+      printf("%-24s %10s %12s %12s %10s\n", "case", "iterations", "ns/call", "allocs/call", "peak heap");
+   }
+
+   for (int i = 0; i < resultCount; i++) {
+      const RESULT *result = &results[i];
+      if (format == OUTPUT_CSV) {
+         printf("%s,%d,%.1f,%.3f,%ld\n", result->name, result->iterations, result->nsPerCall, result->allocationsPerCall, result->peakHeapBytes);
+      } else if (format == OUTPUT_JSON) {
+         printf("%s{\"name\":\"%s\",\"iterations\":%d,\"nsPerCall\":%.1f,\"allocationsPerCall\":%.3f,\"peakHeapBytes\":%ld}", (i > 0) ? "," : "", 
+            result->name, result->iterations, result->nsPerCall, result->allocationsPerCall, result->peakHeapBytes);
+      } else {
+         printf("%-24s %10d %12.1f %12.3f %10ld\n", result->name, result->iterations, result->nsPerCall, result->allocationsPerCall, result->peakHeapBytes);
+      }
+   }
+
+   if (format == OUTPUT_JSON) {
+      printf("]\n");
+   }
+}
+
+static const RESULT* findResult(const char *name) {
+   for (int i = 0; i < resultCount; i++) {
+      if (strcmp(results[i].name, name) == 0) {
+         return &results[i];
+      }
+   }
+   return NULL;
+}
+
+/*
+ * Returns the number of regressed cases or -1 if the baseline cannot be read.
+ */
+static int compareWithBaseline(const char *path, int tolerancePercent) {
+   FILE *file = fopen(path, "r");
+   if (file == NULL) {
+      fprintf(stderr, "cannot open baseline %s\n", path);
+      return -1;
+   }
+
+   char line[MAX_LINE_LENGTH];
+   int regressions = 0;
+
+   while (fgets(line, sizeof(line), file) != NULL) {
+      RESULT baseline;
+      char name[MAX_NAME_LENGTH];
+      if (sscanf(line, "%31[^,],%d,%lf,%lf,%ld", name, &baseline.iterations, &baseline.nsPerCall, &baseline.allocationsPerCall, &baseline.peakHeapBytes) != 5) {
+         continue;   // header
+      }
+      
+      const RESULT *current = findResult(name);
+      if (current == NULL) {
+         printf("%-24s missing\n", name);
+         continue;
+      }
+
+      bool slower          = current->nsPerCall > baseline.nsPerCall * (100 + tolerancePercent) / 100.0;
+      bool moreAllocations = current->allocationsPerCall > baseline.allocationsPerCall + 0.0005;
+      bool moreHeap        = current->peakHeapBytes > baseline.peakHeapBytes;
+      bool regressed       = slower || moreAllocations || moreHeap;
+      regressions         += regressed ? 1 : 0;
+
+      printf("%-24s %s %+6.1f %% ns/call, %.3f -> %.3f allocs/call, %ld -> %ld bytes peak heap\n", name, regressed ? "REGRESSION" : "ok        ",
+         (current->nsPerCall / baseline.nsPerCall - 1) * 100, baseline.allocationsPerCall, current->allocationsPerCall, baseline.peakHeapBytes, 
+         current->peakHeapBytes);
+   }
+
+   fclose(file);
+   return regressions;
+}
+
+int main(int argc, char* argv[]) {
+   OutputFormat format     = OUTPUT_TABLE;
+   int iterations          = DEFAULT_ITERATIONS;
+   int tolerancePercent    = DEFAULT_TOLERANCE;
+   const char *baseline    = NULL;
+
+   for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "--csv") == 0) {
+         format = OUTPUT_CSV;
+      } else if (strcmp(argv[i], "--json") == 0) {
+         format = OUTPUT_JSON;
+      } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+         iterations = atoi(argv[++i]);
+      } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+         baseline = argv[++i];
+      } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+         tolerancePercent = atoi(argv[++i]);
+      } else {
+         fprintf(stderr, "usage: %s [--csv | --json] [--iterations N] [--compare baseline.csv] [--tolerance PERCENT]\n", argv[0]);
+         return 2;
+      }
+   }
+
+   if (iterations <= 0) {
+      iterations = DEFAULT_ITERATIONS;
+   }
+
+   runAll(iterations);
+
+   if (baseline == NULL) {
+      printResults(format);
+      return 0;
+   }
+
+   int regressions = compareWithBaseline(baseline, tolerancePercent);
+   if (regressions != 0) {
+      printf("%d regression(s)\n", regressions);
+   }
+   return (regressions == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/BootTimings.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   resetBootTimings();
+   assertIntEqual(isBootPhaseReached(BOOT_PHASE_FIRST_SAMPLE), 0, "phase not reached after reset");
+   assertIntEqual(getBootPhaseMs(BOOT_PHASE_FIRST_SAMPLE), 0, "time of phase not reached");
+
+   recordBootPhase(BOOT_PHASE_SAMPLING_STARTED, 0);
+   recordBootPhase(BOOT_PHASE_FIRST_SAMPLE, 1003);
+   assertIntEqual(isBootPhaseReached(BOOT_PHASE_SAMPLING_STARTED), 1, "phase reached at 0 ms");
+   assertIntEqual(getBootPhaseMs(BOOT_PHASE_FIRST_SAMPLE), 1003, "time of first sample");
+
+   recordBootPhase(BOOT_PHASE_FIRST_SAMPLE, 2003);
+   assertIntEqual(getBootPhaseMs(BOOT_PHASE_FIRST_SAMPLE), 1003, "only the first invocation gets recorded");
+
+   recordBootPhase(BOOT_PHASE_COUNT, 5);
+   assertIntEqual(isBootPhaseReached(BOOT_PHASE_COUNT), 0, "invalid phase");
+   assertIntEqual(strcmp(getBootPhaseName(BOOT_PHASE_UPLINK_READY), "uplinkReady"), 0, "phase name");
+   assertIntEqual(strcmp(getBootPhaseName(BOOT_PHASE_COUNT), "unknown"), 0, "name of invalid phase");
+
+   resetBootTimings();
+   assertIntEqual(isBootPhaseReached(BOOT_PHASE_FIRST_SAMPLE), 0, "phase forgotten after reset");
+
+   return 0;
+}
\ No newline at end of file
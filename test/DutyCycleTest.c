@@ -0,0 +1,58 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/DutyCycle.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   resetDutyCycle(1000);
+   assertIntEqual(getDutyStatePerMille(DUTY_STATE_IDLE, 1000), 0, "no time passed");
+
+   enterDutyState(DUTY_STATE_SAMPLING, 1900);
+   leaveDutyState(DUTY_STATE_SAMPLING, 2000);
+   const DUTY_CYCLE_REPORT *report = getDutyCycleReport(2000);
+   assertIntEqual(report->durationMs[DUTY_STATE_IDLE], 900, "idle duration");
+   assertIntEqual(report->durationMs[DUTY_STATE_SAMPLING], 100, "sampling duration");
+   assertIntEqual(report->totalMs, 1000, "total duration");
+   assertIntEqual(getDutyStatePerMille(DUTY_STATE_SAMPLING, 2000), 100, "sampling share");
+
+   enterDutyState(DUTY_STATE_UPLINK, 2000);
+   enterDutyState(DUTY_STATE_SAMPLING, 2500);
+   leaveDutyState(DUTY_STATE_SAMPLING, 2600);
+   leaveDutyState(DUTY_STATE_UPLINK, 3000);
+   report = getDutyCycleReport(3000);
+   assertIntEqual(report->durationMs[DUTY_STATE_UPLINK], 1000, "overlapping states get accounted to the state with the highest priority");
+   assertIntEqual(report->durationMs[DUTY_STATE_SAMPLING], 100, "sampling during uplink does not count");
+
+   enterDutyState(DUTY_STATE_UPLINK, 3000);
+   enterDutyState(DUTY_STATE_UPLINK, 3000);
+   leaveDutyState(DUTY_STATE_UPLINK, 3500);
+   leaveDutyState(DUTY_STATE_UPLINK, 4000);
+   assertIntEqual(getDutyCycleReport(4000)->durationMs[DUTY_STATE_UPLINK], 2000, "state stays active till it got left as often as entered");
+
+   leaveDutyState(DUTY_STATE_UPLINK, 4000);
+   assertIntEqual(getDutyCycleReport(5000)->durationMs[DUTY_STATE_IDLE], 1900, "leaving an inactive state has no effect");
+
+   enterDutyState(DUTY_STATE_SAMPLING, 5000);
+   resetDutyCycle(6000);
+   report = getDutyCycleReport(6500);
+   assertIntEqual(report->durationMs[DUTY_STATE_SAMPLING], 500, "active state survives the reset");
+   assertIntEqual(report->totalMs, 500, "reset total duration");
+   leaveDutyState(DUTY_STATE_SAMPLING, 6500);
+
+   assertIntEqual(strcmp(getDutyStateName(DUTY_STATE_UPLINK), "uplink"), 0, "state name");
+   assertIntEqual(strcmp(getDutyStateName(DUTY_STATE_COUNT), "unknown"), 0, "unknown state name");
+
+   return 0;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/EnvelopePacker.h"
+#include "../main/ErrorMessages.h"
+#include "../main/Http.h"
+#include "../main/MessageFormatter.h"
+#include "../main/Messages.h"
+#include "TestingMemory.h"
+
+static PENDING_MESSAGES pendingMessages;
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+static void assertRange(MESSAGE_RANGE actual, int expectedFirst, int expectedCount, char const * description) {
+   if (actual.first != expectedFirst || actual.count != expectedCount) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: first=%d count=%d\n", expectedFirst, expectedCount);
+      printf("\tactual  : first=%d count=%d\n\n", actual.first, actual.count);
+   }
+}
+
+static size_t getLength(int first, int count, time_t now) {
+   return getJsonEnvelopeLength(&pendingMessages, first, count, now - pendingMessages.recordedAt[first + count - 1]);
+}
+
+static void allocateAtCommands(int count) {
+   for (int i = 0; i < count; i++) {
+      // like assertResponse(...) in GsmModule.c
+      release(allocate(2 * sizeof(char*), ALLOCATION_TAG_AT_COMMAND));
+      release(allocate(strlen("CONNECT OK|ALREADY CONNECT") + 1, ALLOCATION_TAG_AT_COMMAND));
+   }
+}
+
+/*
+ * The preparation of the connection takes a part of the arena before the envelope gets built. The envelope, its 
+ * request and the AT commands of an attempt must not overflow the arena nevertheless.
+ */
+static void assertNoArenaOverflow() {
+   HTTP_URL url = { "www.my-service.com", 80, "/windsensor/measurements" };
+   char message[300];
+   memset(message, '1', sizeof(message) - 1);
+   message[sizeof(message) - 1] = 0;
+   for (int i = 0; i < MAX_NUMBER_OF_MESSAGES_TO_KEEP; i++) {
+      addToPendingMessagesWithTime(&pendingMessages, message, 1000);
+   }
+   addErrorMessage("HTTP_RESPONSE_TIMED_OUT");
+   setEnvelopeAttachment("telemetry", "{\"uptime\":123456,\"heap\":[123456,65536,98765],\"stack\":[1234,2345,3456,4567]}");
+
+   useTestingArena(TESTING_ARENA_MAX_SIZE);
+   allocateAtCommands(20);
+   ARENA_STATISTICS arena = getMemoryStatistics();
+   size_t budget          = getEnvelopeByteBudget(0, 160 * 1024, arena.sizeInBytes, arena.usedBytes);
+   MESSAGE_RANGE all      = { 0, pendingMessages.count };
+   MESSAGE_RANGE packed   = packEnvelope(&pendingMessages, all, budget, 1000);
+   assertIntEqual(packed.count > 0 && packed.count < pendingMessages.count, 1, "arena: part of the messages fits");
+
+   char *envelope = createJsonEnvelopeForRange(&pendingMessages, packed.first, packed.count, 0);
+   char *request  = createHttpPostRequest(&url, envelope);
+   allocateAtCommands(15);
+   assertIntEqual(getMemoryStatistics().overflows, 0, "arena: no overflow after the preparation");
+   release(request);
+   release(envelope);
+   assertIntEqual(finishAllocationCycle(), 1, "arena: reset after the publishment");
+
+   stopUsingTestingArena();
+   setEnvelopeAttachment("telemetry", NULL);
+   clearErrorMessages();
+   clearPendingMessages(&pendingMessages);
+}
+
+int main(int argc, char* argv[]) {  
+
+   assertIntEqual(getEnvelopeByteBudget(0, 8192, 0, 0), 0, "no budget without memory beyond the reserve");
+   assertIntEqual(getEnvelopeByteBudget(0, 8192 + 10000, 0, 0), 5000, "memory limits the budget");
+   assertIntEqual(getEnvelopeByteBudget(3000, 8192 + 10000, 0, 0), 3000, "transport limits the budget");
+   assertIntEqual(getEnvelopeByteBudget(6000, 8192 + 10000, 0, 0), 5000, "smaller limit wins");
+   assertIntEqual(getEnvelopeByteBudget(0, 160 * 1024, 16384, 0), 5120, "arena limits the budget");
+   assertIntEqual(getEnvelopeByteBudget(0, 8192 + 4000, 16384, 0), 2000, "heap limits the budget despite the arena");
+   assertIntEqual(getEnvelopeByteBudget(0, 160 * 1024, 1024, 0), 0, "no budget without arena beyond its reserve");
+   assertIntEqual(getEnvelopeByteBudget(0, 160 * 1024, 16384, 6144), 3072, "used part of the arena limits the budget");
+   assertIntEqual(getEnvelopeByteBudget(0, 160 * 1024, 16384, 16384), 0, "no budget in a full arena");
+
+   MESSAGE_RANGE all = { 0, 4 };
+   assertRange(packEnvelope(&pendingMessages, all, 10000, 0), 0, 0, "no candidates");
+
+   clearErrorMessages();
+   addToPendingMessagesWithTime(&pendingMessages, "{\"a\":[11111111,11111111,11111111,11111111]}", 1000);
+   addToPendingMessagesWithTime(&pendingMessages, "{\"b\":[22222222,22222222,22222222,22222222]}", 1060);
+   addToPendingMessagesWithTime(&pendingMessages, "{\"c\":[33333333,33333333,33333333,33333333]}", 1120);
+   addToPendingMessagesWithTime(&pendingMessages, "{\"d\":[44444444,44444444,44444444,44444444]}", 1180);
+   time_t now = 1200;
+
+   assertRange(packEnvelope(&pendingMessages, all, 10000, now), 0, 4, "all candidates fit");
+   assertRange(packEnvelope(&pendingMessages, all, getLength(0, 4, now), now), 0, 4, "exact length fits");
+   assertRange(packEnvelope(&pendingMessages, all, getLength(0, 4, now) - 1, now), 0, 3, "one byte less leaves the last candidate out");
+   assertRange(packEnvelope(&pendingMessages, all, getLength(0, 2, now), now), 0, 2, "first two candidates");
+   assertRange(packEnvelope(&pendingMessages, all, getLength(0, 1, now) - 1, now), 0, 0, "not even the first candidate fits");
+
+   MESSAGE_RANGE rest = { 2, 2 };
+   assertRange(packEnvelope(&pendingMessages, rest, getLength(2, 2, now), now), 2, 2, "remaining candidates in the next envelope");
+   MESSAGE_RANGE beyond = { 3, 2 };
+   assertRange(packEnvelope(&pendingMessages, beyond, 10000, now), 3, 0, "candidates beyond the pending messages");
+
+   size_t budget = getLength(0, 3, now);
+   addErrorMessage("HTTP_RESPONSE_CODE_500");
+   assertRange(packEnvelope(&pendingMessages, all, budget, now), 0, 2, "errors count");
+   clearErrorMessages();
+   setEnvelopeAttachment("memory", "{\"peak\":1234}");
+   assertRange(packEnvelope(&pendingMessages, all, budget, now), 0, 2, "attachments count");
+   setEnvelopeAttachment("memory", NULL);
+
+   MESSAGE_RANGE packed = packEnvelope(&pendingMessages, all, budget, now);
+   char *envelope       = createJsonEnvelopeForRange(&pendingMessages, packed.first, packed.count, now - pendingMessages.recordedAt[packed.count - 1]);
+   assertIntEqual(strlen(envelope) <= budget, 1, "created envelope does not exceed the budget");
+   release(envelope);
+
+   clearPendingMessages(&pendingMessages);
+   assertNoArenaOverflow();
+   return 0;
+}
\ No newline at end of file
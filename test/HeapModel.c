@@ -0,0 +1,162 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HeapModel.h"
+
+#define MIN_BLOCK_SIZE     (2 * HEAP_MODEL_HEADER_SIZE)
+#define ALIGN(size)        (((size) + HEAP_MODEL_ALIGNMENT - 1) & ~(size_t)(HEAP_MODEL_ALIGNMENT - 1))
+
+/*
+ * The blocks follow each other without gaps, the size of a block (including its header) leads to the next one.
+ */
+typedef struct {
+   uint32_t size;
+   uint32_t used;
+} BLOCK_HEADER;
+
+void* __real_malloc(size_t size);
+void __real_free(void *pointer);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void *pointer, size_t size);
+
+static uint8_t *region      = NULL;
+static size_t regionSize    = 0;
+static size_t usedBytes     = 0;
+static size_t peakUsedBytes = 0;
+static uint64_t allocations = 0;
+
+static BLOCK_HEADER* getBlock(size_t offset) {
+   return (BLOCK_HEADER*)(region + offset);
+}
+
+static bool isInRegion(const void *pointer) {
+   return region != NULL && (const uint8_t*)pointer >= region && (const uint8_t*)pointer < region + regionSize;
+}
+
+/*
+ * Merges the free block at the offset with the free blocks following it.
+ */
+static void mergeFollowingFreeBlocks(size_t offset) {
+   BLOCK_HEADER *block = getBlock(offset);
+   while (offset + block->size < regionSize && !getBlock(offset + block->size)->used) {
+      block->size += getBlock(offset + block->size)->size;
+   }
+}
+
+static void* allocateFromModel(size_t sizeInBytes) {
+   size_t requiredSize = ALIGN(sizeInBytes + HEAP_MODEL_HEADER_SIZE);
+   requiredSize        = (requiredSize < MIN_BLOCK_SIZE) ? MIN_BLOCK_SIZE : requiredSize;
+
+   for (size_t offset = 0; offset < regionSize; offset += getBlock(offset)->size) {
+      BLOCK_HEADER *block = getBlock(offset);
+      if (block->used) {
+         continue;
+      }
+      mergeFollowingFreeBlocks(offset);
+      if (block->size < requiredSize) {
+         continue;
+      }
+      if (block->size - requiredSize >= MIN_BLOCK_SIZE) {
+         BLOCK_HEADER *remainder = getBlock(offset + requiredSize);
+         remainder->size         = block->size - requiredSize;
+         remainder->used         = 0;
+         block->size             = requiredSize;
+      }
+      block->used    = 1;
+      usedBytes     += block->size;
+      peakUsedBytes  = (usedBytes > peakUsedBytes) ? usedBytes : peakUsedBytes;
+      allocations++;
+      return (uint8_t*)block + HEAP_MODEL_HEADER_SIZE;
+   }
+
+   // the callers do not expect NULL -> stop with the state of the heap instead of crashing
+   HEAP_MODEL_STATISTICS statistics = getHeapModelStatistics();
+   printf("ERROR: allocation of %zu bytes failed (%zu bytes used, %zu bytes free, largest free block %zu bytes)\n", sizeInBytes, 
+      statistics.usedBytes, statistics.freeBytes, statistics.largestFreeBlock);
+   exit(1);
+}
+
+static void freeToModel(void *pointer) {
+   BLOCK_HEADER *block  = (BLOCK_HEADER*)((uint8_t*)pointer - HEAP_MODEL_HEADER_SIZE);
+   block->used          = 0;
+   usedBytes           -= block->size;
+}
+
+void* __wrap_malloc(size_t size) {
+   return (region == NULL) ? __real_malloc(size) : allocateFromModel(size);
+}
+
+void __wrap_free(void *pointer) {
+   if (isInRegion(pointer)) {
+      freeToModel(pointer);
+   } else {
+      __real_free(pointer);
+   }
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+   if (region == NULL) {
+      return __real_calloc(count, size);
+   }
+   void *pointer = allocateFromModel(count * size);
+   if (pointer != NULL) {
+      memset(pointer, 0, count * size);
+   }
+   return pointer;
+}
+
+void* __wrap_realloc(void *pointer, size_t size) {
+   if (pointer != NULL && !isInRegion(pointer)) {
+      return __real_realloc(pointer, size);
+   }
+   void *result = __wrap_malloc(size);
+   if (result != NULL && pointer != NULL) {
+      size_t oldSize = ((BLOCK_HEADER*)((uint8_t*)pointer - HEAP_MODEL_HEADER_SIZE))->size - HEAP_MODEL_HEADER_SIZE;
+      memcpy(result, pointer, (oldSize < size) ? oldSize : size);
+      freeToModel(pointer);
+   }
+   return result;
+}
+
+void initializeHeapModel(size_t sizeInBytes) {
+   regionSize = sizeInBytes & ~(size_t)(HEAP_MODEL_ALIGNMENT - 1);
+   region     = __real_malloc(regionSize);
+   if (region == NULL) {
+      regionSize = 0;
+      return;
+   }
+   getBlock(0)->size = regionSize;
+   getBlock(0)->used = 0;
+   usedBytes         = 0;
+   peakUsedBytes     = 0;
+   allocations       = 0;
+}
+
+HEAP_MODEL_STATISTICS getHeapModelStatistics() {
+   HEAP_MODEL_STATISTICS statistics = { regionSize, usedBytes, peakUsedBytes, 0, 0, 0, 0, allocations };
+
+   for (size_t offset = 0; offset < regionSize; offset += getBlock(offset)->size) {
+      BLOCK_HEADER *block = getBlock(offset);
+      statistics.blocks++;
+      if (!block->used) {
+         mergeFollowingFreeBlocks(offset);
+         statistics.freeBlocks++;
+         statistics.freeBytes        += block->size;
+         statistics.largestFreeBlock  = (block->size > statistics.largestFreeBlock) ? block->size : statistics.largestFreeBlock;
+      }
+   }
+   return statistics;
+}
+
+void resetHeapModelPeak() {
+   peakUsedBytes = usedBytes;
+}
+
+uint32_t getHeapModelFragmentation(const HEAP_MODEL_STATISTICS *statistics) {
+   if (statistics->freeBytes == 0) {
+      return 0;
+   }
+   return 1000 - (uint32_t)((uint64_t)statistics->largestFreeBlock * 1000 / statistics->freeBytes);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef windsensor_heap_model_h
+#define windsensor_heap_model_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HEAP_MODEL_HEADER_SIZE   8
+#define HEAP_MODEL_ALIGNMENT     8
+
+typedef struct {
+   size_t sizeInBytes;
+   size_t usedBytes;
+   size_t peakUsedBytes;
+   size_t freeBytes;
+   size_t largestFreeBlock;
+   uint32_t blocks;
+   uint32_t freeBlocks;
+   uint64_t allocations;
+} HEAP_MODEL_STATISTICS;
+
+/**
+ * Replaces the heap of all code linked with "-Wl,--wrap=malloc,--wrap=free,--wrap=calloc,--wrap=realloc" (see 
+ * CMakeLists.txt) by a fixed region of the provided size, like the heap of the ESP32. The model is a first fit 
+ * allocator with a header of HEAP_MODEL_HEADER_SIZE bytes per block that merges neighbouring free blocks. Allocations 
+ * that do not fit terminate the process with an error message, because the callers do not handle NULL. Storage 
+ * allocated before stays on the heap of the host.
+ **/
+void initializeHeapModel(size_t sizeInBytes);
+
+/**
+ * Returns the usage of the region. The used and free bytes include the headers.
+ **/
+HEAP_MODEL_STATISTICS getHeapModelStatistics();
+
+/**
+ * Sets the peak to the bytes currently in use.
+ **/
+void resetHeapModelPeak();
+
+/**
+ * Returns the fragmentation in per mille (0 = all free bytes are in one block).
+ **/
+uint32_t getHeapModelFragmentation(const HEAP_MODEL_STATISTICS *statistics);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/EnvelopePacker.h"
+#include "../main/ErrorMessages.h"
+#include "../main/Http.h"
+#include "../main/MessageFormatter.h"
+#include "../main/Messages.h"
+#include "../main/PublishPolicy.h"
+#include "HeapModel.h"
+#include "TestingMemory.h"
+
+/*
+ * Replays publish cycles with outages through the formatting and the bookkeeping of the messages on a heap of the
+ * size the firmware has (HeapModel.h) and fails if an allocation fails, if the memory use or the fragmentation trends
+ * upward or if memory leaks. Runs of millions of cycles take about 20 s per million.
+ *
+ *    heapSoakTest [--cycles N] [--heap-size BYTES] [--seed N] [--verbose]
+ *
+ * The publishments follow main.c: the measured values get published in either order, the envelopes get packed into the
+ * envelope budget of the current heap, the backlog gets drained in envelopes of at most DRAIN_ENVELOPE_BUDGET_BYTES and
+ * a stand-in for the service acknowledges the stored records. Some envelopes get stored although the response got lost.
+ *
+ * The cycles get split into windows. The trends are the least squares slopes of the peak usage and of the smallest
+ * largest free block per window (without the first window, the warm up) extrapolated over the whole run.
+ */
+
+#define DEFAULT_CYCLES              200000
+#define DEFAULT_HEAP_SIZE           (160 * 1024)      // free heap of the firmware after the start
+#define WINDOW_COUNT                20
+#define MEASUREMENT_COUNT           60
+#define TREND_TOLERANCE_BYTES       512
+#define AT_COMMANDS_PER_CYCLE       12
+#define OUTAGE_START_CHANCE         0.002
+#define MEAN_OUTAGE_CYCLES          90
+#define FLAKY_FAILURE_CHANCE        0.05
+#define RESPONSE_LOST_CHANCE        0.02     // part of the failures: the service stored the envelope anyway
+#define DRAIN_ENVELOPE_BUDGET_BYTES 4095
+#define MAX_DRAIN_ENVELOPES         3        // per cycle, the time left in the minute
+#define OK_RESPONSE                 200
+#define STORED_BEYOND_GAP_CAPACITY  256
+
+typedef struct {
+   size_t peakUsedBytes;
+   size_t minLargestFreeBlock;
+   uint32_t maxFragmentation;
+   uint32_t maxPendingMessages;
+   uint32_t failedPublishments;
+} WINDOW;
+
+static const char* EXPECTED_RESPONSES[] = { "OK", "OK|ERROR", "+CREG: 0,1|+CREG: 0,5", "CONNECT OK|ALREADY CONNECT", "SHUT OK", "DOWNLOAD" };
+static const char* ERRORS[]             = { "HTTP_RESPONSE_TIMED_OUT", "HTTP_RESPONSE_CODE_500", "GSM_MODULE_NOT_REGISTERED", "PUBLISH_DEADLINE_EXCEEDED" };
+
+static uint32_t randomState;
+static PENDING_MESSAGES pendingMessages;
+static WINDOW windows[WINDOW_COUNT];
+static bool deliveryUnknown = false;
+
+// stand-in for the service: all records below recordsWithoutGap got stored (or never arrive), some beyond it too
+static uint32_t recordsWithoutGap  = 0;
+static uint32_t storedBeyondGap[STORED_BEYOND_GAP_CAPACITY + MAX_NUMBER_OF_MESSAGES_TO_KEEP];  // plus the records of an envelope
+static int storedBeyondGapCount    = 0;
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+static void assertAtMost(double actual, double maximum, char const * description) {
+   if (actual > maximum) {
+      printf("ERROR: %s\n", description);
+      printf("\tmaximum : %.1f\n", maximum);
+      printf("\tactual  : %.1f\n\n", actual);
+   }
+}
+
+static uint32_t nextRandom() {
+   // xorshift32
+   randomState ^= randomState << 13;
+   randomState ^= randomState >> 17;
+   randomState ^= randomState << 5;
+   return randomState;
+}
+
+static double uniform() {
+   return (nextRandom() >> 8) / (double)(1u << 24);
+}
+
+/*
+ * Same allocations as assertResponse(...) in GsmModule.c.
+ */
+static void simulateAtCommand() {
+   const char *expectedResponses = EXPECTED_RESPONSES[nextRandom() % (sizeof(EXPECTED_RESPONSES) / sizeof(char*))];
+   int responseCount             = 1;
+   for (const char *c = expectedResponses; *c != 0; c++) {
+      responseCount += (*c == '|') ? 1 : 0;
+   }
+   char **allowedResponses       = allocate(responseCount * sizeof(char*), ALLOCATION_TAG_AT_COMMAND);
+   char *copyOfExpectedResponses = allocate(strlen(expectedResponses) + 1, ALLOCATION_TAG_AT_COMMAND);
+   if (allowedResponses != NULL && copyOfExpectedResponses != NULL) {
+      strcpy(copyOfExpectedResponses, expectedResponses);
+      allowedResponses[0] = copyOfExpectedResponses;
+   }
+   release(allowedResponses);
+   release(copyOfExpectedResponses);
+}
+
+static char* createPayload(uint32_t secondsSincePreviousMessage, bool calm) {
+   uint16_t anemometerPulses[MEASUREMENT_COUNT];
+   uint16_t directionVaneValues[MEASUREMENT_COUNT];
+   for (int i = 0; i < MEASUREMENT_COUNT; i++) {
+      anemometerPulses[i]    = calm ? nextRandom() % 10 : nextRandom() % 90;
+      directionVaneValues[i] = nextRandom() % 4096;
+   }
+   return createJsonPayload(anemometerPulses, directionVaneValues, MEASUREMENT_COUNT, secondsSincePreviousMessage);
+}
+
+static int findStoredBeyondGap(uint32_t recordId) {
+   for (int i = 0; i < storedBeyondGapCount; i++) {
+      if (storedBeyondGap[i] == recordId) {
+         return i;
+      }
+   }
+   return -1;
+}
+
+/*
+ * Same service as in Simulator.c. Moves the gap of the service behind the records it stored and behind the ones the sensor does not keep anymore 
+ * (oldestRecordId of the envelope, see README.md). When it keeps STORED_BEYOND_GAP_CAPACITY records beyond the gap, it
+ * stops waiting for the records of the gap.
+ */
+static void advanceGap(uint32_t oldestRecordId) {
+   recordsWithoutGap = (oldestRecordId > recordsWithoutGap) ? oldestRecordId : recordsWithoutGap;
+   for (int i = storedBeyondGapCount - 1; i >= 0; i--) {
+      if (storedBeyondGap[i] < recordsWithoutGap) {
+         storedBeyondGap[i] = storedBeyondGap[--storedBeyondGapCount];
+      }
+   }
+   while (storedBeyondGapCount > 0) {
+      int index = findStoredBeyondGap(recordsWithoutGap);
+      if (index >= 0) {
+         storedBeyondGap[index] = storedBeyondGap[--storedBeyondGapCount];
+      } else if (storedBeyondGapCount < STORED_BEYOND_GAP_CAPACITY) {
+         break;
+      }
+      recordsWithoutGap++;
+   }
+}
+
+static void storeInService(MESSAGE_RANGE range) {
+   advanceGap(pendingMessages.recordNumber[0]);
+   for (int i = range.first; i < range.first + range.count; i++) {
+      uint32_t recordId = pendingMessages.recordNumber[i];
+      if (recordId >= recordsWithoutGap && findStoredBeyondGap(recordId) < 0) {
+         storedBeyondGap[storedBeyondGapCount++] = recordId;
+      }
+   }
+
+   advanceGap(pendingMessages.recordNumber[0]);
+}
+
+/*
+ * Packs the candidates into an envelope of at most maxBytes (and the envelope budget of the heap), publishes it and 
+ * removes the delivered messages like handlePublishResult(...) in main.c. Returns true if the service responded with 
+ * status code 200.
+ */
+static bool publish(MESSAGE_RANGE candidates, size_t maxBytes, bool uplinkWorks, bool useTcp, const HTTP_URL *url, uint32_t now) {
+   if (candidates.count == 0) {
+      return true;
+   }
+
+   size_t budgetInBytes = getEnvelopeByteBudget(0, getHeapModelStatistics().largestFreeBlock, 0, 0);
+   budgetInBytes        = (maxBytes < budgetInBytes) ? maxBytes : budgetInBytes;
+   MESSAGE_RANGE range  = packEnvelope(&pendingMessages, candidates, budgetInBytes, now);
+   if (range.count == 0) {
+      addErrorMessage("ENVELOPE_EXCEEDS_BUDGET");
+      return false;
+   }
+
+   int indexOfLastMessage = range.first + range.count - 1;
+   char *envelope         = createJsonEnvelopeForRange(&pendingMessages, range.first, range.count, now - pendingMessages.recordedAt[indexOfLastMessage]);
+   if (envelope == NULL) {
+      return false;
+   }
+
+   for (int i = 0; i < AT_COMMANDS_PER_CYCLE; i++) {
+      simulateAtCommand();
+   }
+   if (useTcp) {
+      release(createHttpPostRequest(url, envelope));
+   }
+
+   UPLINK_RESULT result = { 0, false, 0, false, 0 };
+   double outcome       = uniform();
+   if (uplinkWorks && outcome >= FLAKY_FAILURE_CHANCE) {
+      char responseBody[32];
+      storeInService(range);
+      sprintf(responseBody, "{\"ack\":%u}", recordsWithoutGap - 1);
+      result.httpStatusCode = OK_RESPONSE;
+      result.acknowledged   = recordsWithoutGap > 0 && parseAcknowledgement(responseBody, &result.acknowledgedRecordId);
+   } else if (uplinkWorks && outcome < RESPONSE_LOST_CHANCE) {
+      storeInService(range);
+      result.httpStatusCode = -1;
+      addErrorMessage("HTTP_RESPONSE_TIMED_OUT");
+   } else {
+      addErrorMessage(ERRORS[nextRandom() % (sizeof(ERRORS) / sizeof(char*))]);
+   }
+
+   deliveryUnknown         = isDeliveryUnknown(deliveryUnknown, &pendingMessages, range, &result);
+   MESSAGE_RANGE delivered = getDeliveredMessages(&pendingMessages, range, &result);
+   removePendingMessages(&pendingMessages, delivered.first, delivered.count);
+   if (result.httpStatusCode == OK_RESPONSE) {
+      clearErrorMessages();
+   }
+   release(envelope);
+   return result.httpStatusCode == OK_RESPONSE;
+}
+
+static void updateWindow(WINDOW *window, const HEAP_MODEL_STATISTICS *statistics) {
+   uint32_t fragmentation       = getHeapModelFragmentation(statistics);
+   window->peakUsedBytes        = (statistics->peakUsedBytes > window->peakUsedBytes) ? statistics->peakUsedBytes : window->peakUsedBytes;
+   window->minLargestFreeBlock  = (statistics->largestFreeBlock < window->minLargestFreeBlock) ? statistics->largestFreeBlock : window->minLargestFreeBlock;
+   window->maxFragmentation     = (fragmentation > window->maxFragmentation) ? fragmentation : window->maxFragmentation;
+   window->maxPendingMessages   = (pendingMessages.count > window->maxPendingMessages) ? pendingMessages.count : window->maxPendingMessages;
+}
+
+/*
+ * Returns the least squares slope of the values of the windows 1 till WINDOW_COUNT - 1 per window.
+ */
+static double getSlope(const double *values) {
+   int count      = WINDOW_COUNT - 1;
+   double meanX   = 0;
+   double meanY   = 0;
+   for (int i = 1; i < WINDOW_COUNT; i++) {
+      meanX += i;
+      meanY += values[i];
+   }
+   meanX /= count;
+   meanY /= count;
+
+   double covariance = 0;
+   double variance   = 0;
+   for (int i = 1; i < WINDOW_COUNT; i++) {
+      covariance += (i - meanX) * (values[i] - meanY);
+      variance   += (i - meanX) * (i - meanX);
+   }
+   return covariance / variance;
+}
+
+int main(int argc, char* argv[]) {
+   long cycles       = DEFAULT_CYCLES;
+   size_t heapSize   = DEFAULT_HEAP_SIZE;
+   bool verbose      = false;
+   randomState       = 1;
+
+   for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+         cycles = atol(argv[++i]);
+      } else if (strcmp(argv[i], "--heap-size") == 0 && i + 1 < argc) {
+         heapSize = atol(argv[++i]);
+      } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+         randomState = strtoul(argv[++i], NULL, 10);
+      } else if (strcmp(argv[i], "--verbose") == 0) {
+         verbose = true;
+      } else {
+         fprintf(stderr, "usage: %s [--cycles N] [--heap-size BYTES] [--seed N] [--verbose]\n", argv[0]);
+         return 2;
+      }
+   }
+   if (cycles < WINDOW_COUNT || randomState == 0) {
+      fprintf(stderr, "at least %d cycles and a seed greater than 0 are required\n", WINDOW_COUNT);
+      return 2;
+   }
+
+   HTTP_URL url;
+   parseUrl("www.my-service.com/windsensor", &url);
+   initializeHeapModel(heapSize);
+   initializePendingMessages(&pendingMessages);
+   clearErrorMessages();
+   HEAP_MODEL_STATISTICS atStart = getHeapModelStatistics();
+
+   long cyclesPerWindow       = cycles / WINDOW_COUNT;
+   long outageCyclesLeft      = 0;
+   uint32_t now               = 0;
+   uint32_t previousMessageAt = 0;
+
+   for (int w = 0; w < WINDOW_COUNT; w++) {
+      WINDOW *window              = &windows[w];
+      window->minLargestFreeBlock = SIZE_MAX;
+      resetHeapModelPeak();
+
+      for (long c = 0; c < cyclesPerWindow; c++) {
+         now += 61;
+         if (outageCyclesLeft == 0 && uniform() < OUTAGE_START_CHANCE) {
+            outageCyclesLeft = 1 + (long)(uniform() * 2 * MEAN_OUTAGE_CYCLES);
+         }
+         bool uplinkWorks = outageCyclesLeft == 0;
+         outageCyclesLeft = (outageCyclesLeft > 0) ? outageCyclesLeft - 1 : 0;
+         bool goodSignal  = uniform() >= 0.2;
+         bool useTcp      = (nextRandom() & 1) == 0;
+
+         char *payload = createPayload(pendingMessages.count == 0 ? 0 : now - previousMessageAt, uniform() < 0.3);
+         if (payload != NULL) {
+            addToPendingMessagesWithTime(&pendingMessages, payload, now);
+            release(payload);
+            previousMessageAt = now;
+         }
+
+         PublishOrder order  = (nextRandom() & 1) ? PUBLISH_ORDER_NEWEST_FIRST : PUBLISH_ORDER_OLDEST_FIRST;
+         bool backlogAllowed = goodSignal && !deliveryUnknown;
+         bool delivered      = publish(selectLiveMessagesToPublish(&pendingMessages, backlogAllowed, order), SIZE_MAX, uplinkWorks, useTcp, &url, now);
+         window->failedPublishments += delivered ? 0 : 1;
+
+         // the backlog gets drained in the remaining time of the minute
+         for (int e = 0; e < MAX_DRAIN_ENVELOPES && delivered && pendingMessages.count > 0 && goodSignal; e++) {
+            MESSAGE_RANGE candidates = selectBacklogToDrain(&pendingMessages, 0, DRAIN_ENVELOPE_BUDGET_BYTES);
+            delivered                = publish(candidates, DRAIN_ENVELOPE_BUDGET_BYTES, uplinkWorks, useTcp, &url, now);
+         }
+
+         HEAP_MODEL_STATISTICS statistics = getHeapModelStatistics();
+         updateWindow(window, &statistics);
+      }
+
+      if (verbose) {
+         printf("window %2d: peak %6zu bytes, smallest largest free block %6zu bytes, fragmentation %3u per mille, max pending %u, failed publishments %u\n",
+            w, window->peakUsedBytes, window->minLargestFreeBlock, window->maxFragmentation, window->maxPendingMessages, window->failedPublishments);
+      }
+   }
+
+   double peaks[WINDOW_COUNT];
+   double largestFreeBlocks[WINDOW_COUNT];
+   for (int w = 0; w < WINDOW_COUNT; w++) {
+      peaks[w]             = windows[w].peakUsedBytes;
+      largestFreeBlocks[w] = windows[w].minLargestFreeBlock;
+   }
+   double usageGrowth    = getSlope(peaks) * (WINDOW_COUNT - 1);
+   double freeBlockLoss  = -getSlope(largestFreeBlocks) * (WINDOW_COUNT - 1);
+
+   if (verbose) {
+      printf("trend over %ld cycles: peak usage %+.1f bytes, smallest largest free block %+.1f bytes\n", cyclesPerWindow * WINDOW_COUNT, usageGrowth, -freeBlockLoss);
+   }
+
+   assertAtMost(usageGrowth, TREND_TOLERANCE_BYTES, "memory use does not trend upward");
+   assertAtMost(freeBlockLoss, TREND_TOLERANCE_BYTES, "largest free block does not trend downward");
+
+   clearPendingMessages(&pendingMessages);
+   clearErrorMessages();
+   HEAP_MODEL_STATISTICS atEnd = getHeapModelStatistics();
+   assertIntEqual(atEnd.usedBytes, atStart.usedBytes, "no memory leaked");
+   assertIntEqual(atEnd.freeBlocks, 1, "all free blocks merged again");
+
+   return 0;
+}
\ No newline at end of file
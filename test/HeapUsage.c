@@ -0,0 +1,46 @@
+#include <malloc.h>
+#include <stddef.h>
+
+#include "HeapUsage.h"
+
+void* __real_malloc(size_t size);
+void __real_free(void *pointer);
+
+static uint64_t allocationCount  = 0;
+static long liveBytes            = 0;
+static long peakBytes            = 0;
+
+void* __wrap_malloc(size_t size) {
+   void *pointer = __real_malloc(size);
+   if (pointer != NULL) {
+      allocationCount++;
+      liveBytes += malloc_usable_size(pointer);
+      if (liveBytes > peakBytes) {
+         peakBytes = liveBytes;
+      }
+   }
+   return pointer;
+}
+
+void __wrap_free(void *pointer) {
+   if (pointer != NULL) {
+      liveBytes -= malloc_usable_size(pointer);
+   }
+   __real_free(pointer);
+}
+
+uint64_t getHeapAllocationCount() {
+   return allocationCount;
+}
+
+long getLiveHeapBytes() {
+   return liveBytes;
+}
+
+long getPeakHeapBytes() {
+   return peakBytes;
+}
+
+void resetPeakHeapBytes() {
+   peakBytes = liveBytes;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef windsensor_heap_usage_h
+#define windsensor_heap_usage_h
+
+#include <stdint.h>
+
+/**
+ * Counts the heap allocations and the bytes in use of all code linked with "-Wl,--wrap=malloc,--wrap=free" (see 
+ * CMakeLists.txt). The bytes include the padding of the allocator (malloc_usable_size).
+ **/
+uint64_t getHeapAllocationCount();
+
+long getLiveHeapBytes();
+
+/**
+ * Returns the maximum of the bytes in use since the last invocation of resetPeakHeapBytes().
+ **/
+long getPeakHeapBytes();
+
+/**
+ * Sets the peak to the current bytes in use.
+ **/
+void resetPeakHeapBytes();
+
+#endif
\ No newline at end of file
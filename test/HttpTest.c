@@ -0,0 +1,86 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/Http.h"
+#include "TestingMemory.h"
+
+static void assertEqual(char const * actual, char const * expected, char const * description) {
+   if (actual == NULL || strcmp(actual, expected) != 0) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %s\n", expected);
+      printf("\tactual  : %s\n\n", (actual == NULL) ? "NULL" : actual);
+   }
+}
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   HTTP_URL url;
+
+   assertIntEqual(parseUrl("www.my-service.com", &url), 1, "parseUrl accepts host only");
+   assertEqual(url.host, "www.my-service.com", "parseUrl host of host only URL");
+   assertIntEqual(url.port, 80, "parseUrl default port");
+   assertEqual(url.path, "/", "parseUrl default path");
+
+   assertIntEqual(parseUrl("example.org:8080/windsensor/v1", &url), 1, "parseUrl accepts host, port and path");
+   assertEqual(url.host, "example.org", "parseUrl host");
+   assertIntEqual(url.port, 8080, "parseUrl port");
+   assertEqual(url.path, "/windsensor/v1", "parseUrl path");
+
+   assertIntEqual(parseUrl("http://example.org/data", &url), 1, "parseUrl accepts protocol prefix");
+   assertEqual(url.host, "example.org", "parseUrl host after protocol prefix");
+   assertEqual(url.path, "/data", "parseUrl path after protocol prefix");
+
+   assertIntEqual(parseUrl("", &url), 0, "parseUrl rejects empty URL");
+   assertIntEqual(parseUrl("example.org:/data", &url), 0, "parseUrl rejects missing port");
+   assertIntEqual(parseUrl("example.org:8x/data", &url), 0, "parseUrl rejects invalid port");
+   assertIntEqual(parseUrl("example.org:99999", &url), 0, "parseUrl rejects port out of range");
+
+   parseUrl("example.org/data", &url);
+   char *request = createHttpPostRequest(&url, "{\"a\":1}");
+   char *expected = "POST /data HTTP/1.1\r\nHost: example.org\r\nContent-Type: application/json\r\nContent-Length: 7\r\nConnection: keep-alive\r\n\r\n{\"a\":1}";
+   assertEqual(request, expected, "createHttpPostRequest with default port");
+   release(request);
+
+   parseUrl("example.org:8080", &url);
+   request = createHttpPostRequest(&url, "");
+   expected = "POST / HTTP/1.1\r\nHost: example.org:8080\r\nContent-Type: application/json\r\nContent-Length: 0\r\nConnection: keep-alive\r\n\r\n";
+   assertEqual(request, expected, "createHttpPostRequest with port and empty body");
+   release(request);
+
+   assertIntEqual(parseHttpStatusLine("HTTP/1.1 200 OK"), 200, "parseHttpStatusLine with reason phrase");
+   assertIntEqual(parseHttpStatusLine("HTTP/1.0 404"), 404, "parseHttpStatusLine without reason phrase");
+   assertIntEqual(parseHttpStatusLine("SEND OK"), -1, "parseHttpStatusLine ignores other lines");
+   assertIntEqual(parseHttpStatusLine("HTTP/1.1 20"), -1, "parseHttpStatusLine rejects short status code");
+   assertIntEqual(parseHttpStatusLine("HTTP/1.1 2000 OK"), -1, "parseHttpStatusLine rejects long status code");
+
+   assertEqual(getHttpHeaderValue("Content-Length: 12", "Content-Length"), "12", "getHttpHeaderValue returns value");
+   assertEqual(getHttpHeaderValue("connection:close", "Connection"), "close", "getHttpHeaderValue ignores case");
+   if (getHttpHeaderValue("Content-Type: text/plain", "Content-Length") != NULL) {
+      printf("ERROR: getHttpHeaderValue returns NULL for other headers\n");
+   }
+
+   uint32_t recordId = 0;
+   assertIntEqual(parseAcknowledgement("{\"ack\":1234}", &recordId), 1, "parseAcknowledgement accepts acknowledgement");
+   assertIntEqual(recordId, 1234, "parseAcknowledgement returns record id");
+   assertIntEqual(parseAcknowledgement("{\"status\":\"ok\", \"ack\" : 7 }", &recordId), 1, "parseAcknowledgement accepts spaces");
+   assertIntEqual(recordId, 7, "parseAcknowledgement returns record id after spaces");
+   assertIntEqual(parseAcknowledgement("{\"ack\":-1}", &recordId), 0, "parseAcknowledgement rejects negative record id");
+   assertIntEqual(parseAcknowledgement("{\"ack\":null}", &recordId), 0, "parseAcknowledgement rejects missing record id");
+   assertIntEqual(parseAcknowledgement("{\"acknowledged\":3}", &recordId), 0, "parseAcknowledgement rejects other properties");
+   assertIntEqual(parseAcknowledgement("", &recordId), 0, "parseAcknowledgement rejects empty body");
+   assertIntEqual(parseAcknowledgement(NULL, &recordId), 0, "parseAcknowledgement rejects missing body");
+   assertIntEqual(recordId, 7, "parseAcknowledgement keeps record id if there is no acknowledgement");
+
+   return 0;
+}
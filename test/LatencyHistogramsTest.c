@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/LatencyHistograms.h"
+
+static void assertEqual(char const * actual, char const * expected, char const * description) {
+   if (strcmp(actual, expected) != 0) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %s\n", expected);
+      printf("\tactual  : %s\n\n", actual);
+   }
+}
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   assertIntEqual(getHistogramBucket(0), 0, "bucket of 0 us");
+   assertIntEqual(getHistogramBucket(1), 1, "bucket of 1 us");
+   assertIntEqual(getHistogramBucket(100), 7, "bucket of 100 us");
+   assertIntEqual(getHistogramBucket(UINT32_MAX), HISTOGRAM_BUCKET_COUNT - 1, "long durations go to the last bucket");
+
+   char buffer[200];
+   formatHistograms(buffer, sizeof(buffer));
+   assertEqual(buffer, "{}", "no samples");
+   
+   for (int i = 0; i < 98; i++) {
+      recordDuration(PROFILED_PULSE_LATENCY, 10);
+   }
+   recordDuration(PROFILED_PULSE_LATENCY, 100);
+   recordDuration(PROFILED_PULSE_LATENCY, 300);
+   const HISTOGRAM *histogram = getHistogram(PROFILED_PULSE_LATENCY, 0);
+   assertIntEqual(histogram->count, 100, "sample count");
+   assertIntEqual(histogram->counts[4], 98, "bucket count");
+   assertIntEqual(histogram->maxUs, 300, "maximum");
+   assertIntEqual(getPercentileUs(histogram, 50), 16, "median");
+   assertIntEqual(getPercentileUs(histogram, 99), 128, "99th percentile");
+   assertIntEqual(getPercentileUs(histogram, 100), 300, "100th percentile is the maximum");
+   assertIntEqual(getHistogram(PROFILED_PULSE_LATENCY, 1) == NULL, 1, "no completed window yet");
+   assertIntEqual(getHistogram(PROFILED_VALUE_COUNT, 0) == NULL, 1, "invalid value");
+
+   rotateHistogramWindow();
+   recordDuration(PROFILED_ADC_READ, 40);
+   recordDuration(PROFILED_PULSE_LATENCY, 1000);
+   assertIntEqual(getHistogram(PROFILED_PULSE_LATENCY, 0)->count, 1, "new window");
+   assertIntEqual(getHistogram(PROFILED_PULSE_LATENCY, 1)->count, 100, "previous window");
+
+   HISTOGRAM merged;
+   mergeHistograms(PROFILED_PULSE_LATENCY, &merged);
+   assertIntEqual(merged.count, 101, "merged count");
+   assertIntEqual(merged.maxUs, 1000, "merged maximum");
+
+   int length = formatHistograms(buffer, sizeof(buffer));
+   assertEqual(buffer, "{\"pulse\":[101,16,512,1000],\"adc\":[1,40,40,40]}", "formatted histograms");
+   assertIntEqual(length, strlen(buffer), "length of the formatted histograms");
+   assertIntEqual(formatHistograms(buffer, length), -1, "no space for the null byte");
+
+   for (int i = 0; i < HISTOGRAM_WINDOW_COUNT - 1; i++) {
+      rotateHistogramWindow();
+   }
+   mergeHistograms(PROFILED_PULSE_LATENCY, &merged);
+   assertIntEqual(merged.count, 1, "oldest window got dropped");
+   assertIntEqual(getHistogram(PROFILED_PULSE_LATENCY, HISTOGRAM_WINDOW_COUNT) == NULL, 1, "window beyond the ring");
+
+   recordDuration(PROFILED_FIRST_PHASE + PHASE_REQUEST_TRANSFER, 2500000);
+   assertIntEqual(getPercentileUs(getHistogram(PROFILED_FIRST_PHASE + PHASE_REQUEST_TRANSFER, 0), 50), 2500000, "percentile limited by the maximum");
+   assertIntEqual(strcmp(getProfiledValueName(PROFILED_FIRST_PHASE + PHASE_REQUEST_TRANSFER), "transfer"), 0, "name of a phase");
+
+   resetHistograms();
+   mergeHistograms(PROFILED_PULSE_LATENCY, &merged);
+   assertIntEqual(merged.count, 0, "reset");
+
+   for (int value = 0; value < PROFILED_VALUE_COUNT; value++) {
+      assertIntEqual(strlen(getProfiledValueName(value)) <= MAX_VALUE_NAME_LENGTH, 1, "name fits into the maximum length");
+   }
+
+   // a day of 4 windows of GSM publishments: 60 pulses per second, one ADC read per second and one publishment per minute
+   char profile[MAX_FORMATTED_HISTOGRAMS_LENGTH + 1];
+   for (int window = 0; window < HISTOGRAM_WINDOW_COUNT; window++) {
+      for (int i = 0; i < 21600; i++) {
+         recordDuration(PROFILED_PULSE_LATENCY, 12 + (i % 50));
+      }
+      for (int i = 0; i < 21600; i++) {
+         recordDuration(PROFILED_ADC_READ, 41 + (i % 7));
+      }
+      for (int i = 0; i < 360; i++) {
+         for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            recordDuration(PROFILED_FIRST_PHASE + phase, 1234567 + (i * 9973) + (phase * 100000));
+         }
+      }
+      rotateHistogramWindow();
+   }
+   length = formatHistograms(profile, sizeof(profile));
+   assertIntEqual(length > 384, 1, "realistic profile is longer than the former buffer");
+   assertIntEqual(length, strlen(profile), "realistic profile fits into the buffer");
+
+   recordDuration(PROFILED_PULSE_LATENCY, UINT32_MAX);
+   assertIntEqual(formatHistograms(profile, sizeof(profile)) > 0, 1, "maximum durations fit into the buffer");
+   resetHistograms();
+
+   return 0;
+}
\ No newline at end of file
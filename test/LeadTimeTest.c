@@ -0,0 +1,59 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/LeadTime.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   initializeLeadTime(10000, 45000);
+   assertIntEqual(getLeadTimeMs(), 10000, "lead time starts with minimum");
+
+   recordBringUpDuration(8000, true);
+   assertIntEqual(getLeadTimeStatistics()->smoothedBringUpMs, 8000, "first duration initializes smoothed duration");
+   assertIntEqual(getLeadTimeStatistics()->bringUpDeviationMs, 4000, "first duration initializes deviation");
+   assertIntEqual(getLeadTimeMs(), 24000, "lead time is smoothed duration plus four times the deviation");
+
+   recordBringUpDuration(8000, true);
+   assertIntEqual(getLeadTimeStatistics()->smoothedBringUpMs, 8000, "smoothed duration of equal durations");
+   assertIntEqual(getLeadTimeStatistics()->bringUpDeviationMs, 3000, "deviation decreases with equal durations");
+   assertIntEqual(getLeadTimeMs(), 20000, "lead time decreases with equal durations");
+
+   for (int i = 0; i < 50; i++) {
+      recordBringUpDuration(1000, true);
+   }
+   assertIntEqual(getLeadTimeMs(), 10000, "lead time does not get shorter than the minimum");
+
+   recordBringUpDuration(60000, false);
+   assertIntEqual(getLeadTimeMs(), 10000, "failed preparations do not influence lead time");
+   assertIntEqual(getLeadTimeStatistics()->failedPreparations, 1, "failed preparations get counted");
+   assertIntEqual(getLeadTimeStatistics()->lastBringUpMs, 60000, "last duration includes failed preparations");
+
+   for (int i = 0; i < 5; i++) {
+      recordBringUpDuration(100000, true);
+   }
+   assertIntEqual(getLeadTimeMs(), 45000, "lead time does not get longer than the maximum");
+   assertIntEqual(getLeadTimeStatistics()->maxBringUpMs, 100000, "max bring up duration");
+   assertIntEqual(getLeadTimeStatistics()->preparations, 58, "preparations get counted");
+
+   recordPreparationOutcome(true);
+   recordPreparationOutcome(true);
+   recordPreparationOutcome(false);
+   assertIntEqual(getLeadTimeStatistics()->preparedInTime, 2, "preparations in time");
+   assertIntEqual(getLeadTimeStatistics()->preparedTooLate, 1, "preparations too late");
+
+   initializeLeadTime(5000, 1000);
+   assertIntEqual(getLeadTimeMs(), 5000, "maximum lower than minimum gets ignored");
+
+   return 0;
+}
\ No newline at end of file
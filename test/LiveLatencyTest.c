@@ -0,0 +1,59 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/LiveLatency.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   resetLiveLatency();
+   assertIntEqual(getLiveDataAgeMs(5000), 0, "no age without delivered live data");
+
+   recordLiveMessage(10, 60000);
+   recordDeliveredMessages(7, 3, 61000);
+   assertIntEqual(getLiveLatencyStatistics()->deliveries, 0, "older messages do not contain the live message");
+
+   recordDeliveredMessages(10, 1, 64000);
+   assertIntEqual(getLiveLatencyStatistics()->deliveries, 1, "delivered live message");
+   assertIntEqual(getLiveLatencyStatistics()->lastMs, 4000, "latency of the live message");
+   assertIntEqual(getLiveLatencyStatistics()->smoothedMs, 4000, "first latency initializes the smoothed latency");
+   assertIntEqual(getLiveLatencyStatistics()->histogram[0], 1, "latency below 10 s");
+   assertIntEqual(getLiveDataAgeMs(70000), 10000, "age of the live data");
+
+   recordDeliveredMessages(10, 1, 66000);
+   assertIntEqual(getLiveLatencyStatistics()->deliveries, 1, "live message gets counted once");
+
+   recordLiveMessage(11, 120000);
+   recordLiveMessage(12, 180000);
+   assertIntEqual(getLiveLatencyStatistics()->superseded, 1, "undelivered live message got superseded");
+   assertIntEqual(getLiveDataAgeMs(200000), 140000, "age grows till the next live message gets delivered");
+
+   recordDeliveredMessages(11, 2, 216000);
+   assertIntEqual(getLiveLatencyStatistics()->deliveries, 2, "live message delivered together with older ones");
+   assertIntEqual(getLiveLatencyStatistics()->lastMs, 36000, "latency of the second live message");
+   assertIntEqual(getLiveLatencyStatistics()->smoothedMs, 8000, "smoothed latency");
+   assertIntEqual(getLiveLatencyStatistics()->maxMs, 36000, "maximum latency");
+   assertIntEqual(getLiveLatencyStatistics()->histogram[3], 1, "latency below 60 s");
+   assertIntEqual(getLiveDataAgeMs(216000), 36000, "age after the delivery");
+
+   recordLiveMessage(13, 240000);
+   recordDeliveredMessages(13, 1, 400000);
+   assertIntEqual(getLiveLatencyStatistics()->histogram[LIVE_LATENCY_BUCKET_COUNT - 1], 1, "latency of a minute or more");
+   assertIntEqual(getLiveLatencyStatistics()->smoothedMs, 27000, "smoothed latency follows slowly");
+
+   resetLiveLatency();
+   assertIntEqual(getLiveLatencyStatistics()->deliveries, 0, "reset statistics");
+   assertIntEqual(getLiveDataAgeMs(500000), 0, "reset age");
+
+   return 0;
+}
\ No newline at end of file
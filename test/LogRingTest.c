@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/LogRing.h"
+
+static void assertEqual(char const * actual, char const * expected, char const * description) {
+   if (strcmp(actual, expected) != 0) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %s\n", expected);
+      printf("\tactual  : %s\n\n", actual);
+   }
+}
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+   LOG_RECORD record;
+   char buffer[100];
+
+   assertIntEqual(takeLogRecord(&record), 0, "empty ring");
+
+   assertIntEqual(appendLogRecord(1000, LOG_FORMAT_AT_COMMAND, "AT+CSQ", 0, 0, 0), 1, "append");
+   assertIntEqual(appendLogRecord(2000, LOG_FORMAT_SEND_FAILED, "www.my-service.com", 1234, 0x7004, 0), 1, "append with args");
+   assertIntEqual(takeLogRecord(&record), 1, "take first record");
+   assertIntEqual(record.timestampUs, 1000, "timestamp");
+   formatLogRecord(&record, buffer, sizeof(buffer));
+   assertEqual(buffer, "out: \"AT+CSQ\"", "formatted AT command");
+   assertIntEqual(takeLogRecord(&record), 1, "take second record");
+   int length = formatLogRecord(&record, buffer, sizeof(buffer));
+   assertEqual(buffer, "failed to send 1234 bytes to www.my-service.com (error 0x7004)", "formatted args and text");
+   assertIntEqual(length, strlen(buffer), "length of the message");
+   assertIntEqual(takeLogRecord(&record), 0, "ring empty again");
+
+   formatLogRecord(&record, buffer, 10);
+   assertEqual(buffer, "failed to", "truncated message");
+   record.format = LOG_FORMAT_COUNT;
+   formatLogRecord(&record, buffer, sizeof(buffer));
+   assertEqual(buffer, "unknown format 5", "unknown format");
+
+   char longText[100];
+   memset(longText, 'A', sizeof(longText) - 1);
+   longText[sizeof(longText) - 1] = 0;
+   appendLogRecord(3000, LOG_FORMAT_AT_RESPONSE, longText, 0, 0, 0);
+   takeLogRecord(&record);
+   assertIntEqual(strlen(record.text), LOG_RECORD_TEXT_LENGTH - 1, "long text gets truncated");
+
+   for (int i = 0; i < LOG_RING_CAPACITY; i++) {
+      appendLogRecord(i, LOG_FORMAT_MESSAGE_LENGTH, NULL, i, 0, 0);
+   }
+   assertIntEqual(appendLogRecord(0, LOG_FORMAT_MESSAGE_LENGTH, NULL, 0, 0, 0), 0, "full ring");
+   assertIntEqual(getDroppedLogRecordCount(), 1, "dropped records");
+   takeLogRecord(&record);
+   assertIntEqual(record.args[0], 0, "oldest record first");
+   assertIntEqual(appendLogRecord(0, LOG_FORMAT_ENVELOPE_LENGTH, NULL, 999, 0, 0), 1, "space after taking a record");
+   int count = 1;
+   while (takeLogRecord(&record)) {
+      count++;
+   }
+   assertIntEqual(count, LOG_RING_CAPACITY + 1, "all records taken");
+   assertIntEqual(record.args[0], 999, "newest record last");
+   
+   setLogLevel(LOG_TAG_GSM_MODULE, LOG_LEVEL_WARN);
+   assertIntEqual(isLogFormatEnabled(LOG_FORMAT_AT_COMMAND), 0, "level of the tag disables info records");
+   assertIntEqual(appendLogRecord(0, LOG_FORMAT_AT_COMMAND, "AT", 0, 0, 0), 0, "disabled record does not get appended");
+   assertIntEqual(getDroppedLogRecordCount(), 1, "disabled records do not count as dropped");
+   assertIntEqual(isLogFormatEnabled(LOG_FORMAT_MESSAGE_LENGTH), 1, "other tags stay enabled");
+   setLogLevel(LOG_TAG_WIFI, LOG_LEVEL_NONE);
+   assertIntEqual(isLogFormatEnabled(LOG_FORMAT_SEND_FAILED), 0, "level none disables errors");
+   
+   assertIntEqual(getLogFormatLevel(LOG_FORMAT_SEND_FAILED), LOG_LEVEL_ERROR, "level of a format");
+   assertIntEqual(getLogFormatTag(LOG_FORMAT_AT_RESPONSE), LOG_TAG_GSM_MODULE, "tag of a format");
+   assertEqual(getLogTagName(LOG_TAG_WIFI), "wifi", "tag name");
+
+   resetLogRing();
+   assertIntEqual(isLogFormatEnabled(LOG_FORMAT_AT_COMMAND), 1, "reset levels");
+   assertIntEqual(getDroppedLogRecordCount(), 0, "reset dropped records");
+
+   return 0;
+}
\ No newline at end of file
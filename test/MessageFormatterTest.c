@@ -43,48 +43,48 @@ int main(int argc, char* argv[]) {
    char *expected = "{\"anemometerPulses\":[],\"directionVaneValues\":[],\"secondsSincePreviousMessage\":0}";
    char *message  = createJsonPayload(anemometerPulses, directionVaneValues, 0, 0);	
    assertEqual(message, expected, "empty message");
-   free(message);
+   release(message);
    
    expected = "{\"anemometerPulses\":[0,1,2,3,4],\"directionVaneValues\":[0,10,20,30,40],\"secondsSincePreviousMessage\":67}";
    message  = createJsonPayload(anemometerPulses, directionVaneValues, 5, 67);	
    assertEqual(message, expected, "message with 5 measurements and secondsSincePreviousMessage greater 0");
-   free(message);
+   release(message);
  
    expected = "{\"anemometerPulses\":[0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51,52,53,54,55,56,57,58,59],\"directionVaneValues\":[0,10,20,30,40,50,60,70,80,90,100,110,120,130,140,150,160,170,180,190,200,210,220,230,240,250,260,270,280,290,300,310,320,330,340,350,360,370,380,390,400,410,420,430,440,450,460,470,480,490,500,510,520,530,540,550,560,570,580,590],\"secondsSincePreviousMessage\":126}";
    message = createJsonPayload(anemometerPulses, directionVaneValues, 60, 126);	
    assertEqual(message, expected, "message with 60 measurements and some secondsSincePreviousMessage");
-   free(message);
+   release(message);
  
    expected = "{\"version\":\"2.0.0\",\"sequenceId\":0,\"messages\":[],\"errors\":[]}";
    char *envelope = createJsonEnvelope(&pendingMessages);
    assertEqual(envelope, expected, "message envelope without messages");
-   free(envelope);
+   release(envelope);
 
    addToPendingMessages(&pendingMessages, "this is a test");
-   expected = "{\"version\":\"2.0.0\",\"sequenceId\":1,\"messages\":[this is a test],\"errors\":[]}";
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":1,\"firstRecordId\":0,\"oldestRecordId\":0,\"messages\":[this is a test],\"errors\":[]}";
    envelope = createJsonEnvelope(&pendingMessages);
    assertEqual(envelope, expected, "message envelope with one message");
-   free(envelope);
+   release(envelope);
    
    addToPendingMessages(&pendingMessages, "2nd test");
-   expected = "{\"version\":\"2.0.0\",\"sequenceId\":2,\"messages\":[this is a test,2nd test],\"errors\":[]}";
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":2,\"firstRecordId\":0,\"oldestRecordId\":0,\"messages\":[this is a test,2nd test],\"errors\":[]}";
    envelope = createJsonEnvelope(&pendingMessages);
    assertEqual(envelope, expected, "message envelope with two message");
-   free(envelope);
+   release(envelope);
    
-   expected = "{\"version\":\"2.0.0\",\"sequenceId\":999,\"messages\":[this is a test,2nd test],\"errors\":[]}";
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":999,\"firstRecordId\":0,\"oldestRecordId\":0,\"messages\":[this is a test,2nd test],\"errors\":[]}";
    envelope = createJsonEnvelope(&pendingMessages);
    for(int i = 3; i < 999; i++) {
-      free(envelope);
+      release(envelope);
       envelope = createJsonEnvelope(&pendingMessages);
    }
    assertEqual(envelope, expected, "message with max sequence ID");
-   free(envelope);
+   release(envelope);
    
-   expected = "{\"version\":\"2.0.0\",\"sequenceId\":0,\"messages\":[this is a test,2nd test],\"errors\":[]}";
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":0,\"firstRecordId\":0,\"oldestRecordId\":0,\"messages\":[this is a test,2nd test],\"errors\":[]}";
    envelope = createJsonEnvelope(&pendingMessages);
    assertEqual(envelope, expected, "message with wrap around of sequence ID");
-   free(envelope);
+   release(envelope);
    
    clearPendingMessages(&pendingMessages);
    clearErrorMessages();
@@ -92,13 +92,13 @@ int main(int argc, char* argv[]) {
    expected = "{\"version\":\"2.0.0\",\"sequenceId\":1,\"messages\":[],\"errors\":[\"error I\"]}";
    envelope = createJsonEnvelope(&pendingMessages);
    assertEqual(envelope, expected, "message with an error");
-   free(envelope);
+   release(envelope);
    
    addErrorMessage("second ERR");
    expected = "{\"version\":\"2.0.0\",\"sequenceId\":2,\"messages\":[],\"errors\":[\"error I\",\"second ERR\"]}";
    envelope = createJsonEnvelope(&pendingMessages);
    assertEqual(envelope, expected, "message with another error");
-   free(envelope);
+   release(envelope);
 
    resetTestingMemory();
    clearPendingMessages(&pendingMessages);
@@ -107,7 +107,7 @@ int main(int argc, char* argv[]) {
    int expectedErrorsDataLength  = 1;
    int expectedMessagesLength    = 13;
    int expectedErrorsLength      = 1;
-   int expectedTotalLength       = 73;
+   int expectedTotalLength       = 110;
 
    addToPendingMessages(&pendingMessages, "0123456789");
    envelope = createJsonEnvelope(&pendingMessages);
@@ -116,7 +116,7 @@ int main(int argc, char* argv[]) {
    assertIntEqual(getTestingMemoryInvocation(1), expectedMessagesLength,   "createJsonEnvelope: memory allocation (A) - messagesLength");
    assertIntEqual(getTestingMemoryInvocation(2), expectedErrorsLength,     "createJsonEnvelope: memory allocation (A) - errorsLength");
    assertIntEqual(getTestingMemoryInvocation(3), expectedTotalLength,      "createJsonEnvelope: memory allocation (A) - totalLength");
-   free(envelope);
+   release(envelope);
 
    resetTestingMemory();
    clearPendingMessages(&pendingMessages);
@@ -134,7 +134,7 @@ int main(int argc, char* argv[]) {
    assertIntEqual(getTestingMemoryInvocation(1), expectedMessagesLength,   "createJsonEnvelope: memory allocation (B) - messagesLength");
    assertIntEqual(getTestingMemoryInvocation(2), expectedErrorsLength,     "createJsonEnvelope: memory allocation (B) - errorsLength");
    assertIntEqual(getTestingMemoryInvocation(3), expectedTotalLength,      "createJsonEnvelope: memory allocation (B) - totalLength");
-   free(envelope);
+   release(envelope);
 
    resetTestingMemory();
    clearPendingMessages(&pendingMessages);
@@ -143,7 +143,7 @@ int main(int argc, char* argv[]) {
    expectedErrorsDataLength  = 13;
    expectedMessagesLength    = 9;
    expectedErrorsLength      = 9;
-   expectedTotalLength       = 81;
+   expectedTotalLength       = 118;
    
    addToPendingMessages(&pendingMessages, "123");
    addToPendingMessages(&pendingMessages, "45");
@@ -155,7 +155,71 @@ int main(int argc, char* argv[]) {
    assertIntEqual(getTestingMemoryInvocation(1), expectedMessagesLength,   "createJsonEnvelope: memory allocation (C) - messagesLength");
    assertIntEqual(getTestingMemoryInvocation(2), expectedErrorsLength,     "createJsonEnvelope: memory allocation (C) - errorsLength");
    assertIntEqual(getTestingMemoryInvocation(3), expectedTotalLength,      "createJsonEnvelope: memory allocation (C) - totalLength");
-   free(envelope);
+   release(envelope);
+
+   clearPendingMessages(&pendingMessages);
+   clearErrorMessages();
+   addToPendingMessages(&pendingMessages, "A");
+   addToPendingMessages(&pendingMessages, "B");
+   addToPendingMessages(&pendingMessages, "C");
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":6,\"firstRecordId\":5,\"oldestRecordId\":5,\"messages\":[A,B],\"secondsSinceLastMessage\":75,\"errors\":[]}";
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 0, 2, 75);
+   assertEqual(envelope, expected, "message envelope with a range of messages and their age");
+   release(envelope);
+
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":7,\"firstRecordId\":7,\"oldestRecordId\":5,\"messages\":[C],\"errors\":[]}";
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 2, 1, 0);
+   assertEqual(envelope, expected, "message envelope with the newest message only");
+   release(envelope);
+
+   assertIntEqual(peekNextSequenceId(), 8, "peeking does not consume the sequence ID");
+   assertIntEqual(peekNextSequenceId(), 8, "peeking twice returns the same sequence ID");
+   setNextSequenceId(42);
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":42,\"firstRecordId\":7,\"oldestRecordId\":5,\"messages\":[C],\"errors\":[]}";
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 2, 1, 0);
+   assertEqual(envelope, expected, "message envelope with restored sequence ID");
+   release(envelope);
+   setNextSequenceId(1000);
+   assertIntEqual(peekNextSequenceId(), 0, "sequence ID out of range");
+
+   setEnvelopeAttachment("memory", "{\"peak\":12}");
+   setEnvelopeAttachment("other", "[1]");
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":0,\"firstRecordId\":7,\"oldestRecordId\":5,\"messages\":[C],\"memory\":{\"peak\":12},\"other\":[1],\"errors\":[]}";
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 2, 1, 0);
+   assertEqual(envelope, expected, "message envelope with attachments");
+   release(envelope);
+   setEnvelopeAttachment("memory", "{\"peak\":34}");
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":1,\"firstRecordId\":7,\"oldestRecordId\":5,\"messages\":[C],\"secondsSinceLastMessage\":5,\"memory\":{\"peak\":34},\"other\":[1],\"errors\":[]}";
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 2, 1, 5);
+   assertEqual(envelope, expected, "message envelope with replaced attachment and age");
+   release(envelope);
+   setEnvelopeAttachment("memory", NULL);
+   setEnvelopeAttachment("unknown", NULL);
+   expected = "{\"version\":\"2.0.0\",\"sequenceId\":2,\"firstRecordId\":7,\"oldestRecordId\":5,\"messages\":[C],\"other\":[1],\"errors\":[]}";
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 2, 1, 0);
+   assertEqual(envelope, expected, "message envelope with removed attachment");
+   release(envelope);
+
+   resetTestingMemory();
+   size_t expectedLength = getJsonEnvelopeLength(&pendingMessages, 0, 3, 120);
+   assertIntEqual(getTestingMemoryInvocationCount(), 0, "getJsonEnvelopeLength: nothing allocated");
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 0, 3, 120);
+   assertIntEqual(expectedLength, strlen(envelope), "getJsonEnvelopeLength: range with age and attachment");
+   release(envelope);
+   setEnvelopeAttachment("other", NULL);
+   addErrorMessage("GSM_MODULE_NOT_REGISTERED");
+   addErrorMessage("HTTP_RESPONSE_CODE_500");
+   setNextSequenceId(998);
+   expectedLength = getJsonEnvelopeLength(&pendingMessages, 1, 2, 0);
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 1, 2, 0);
+   assertIntEqual(expectedLength, strlen(envelope), "getJsonEnvelopeLength: errors and three digit sequence ID");
+   release(envelope);
+   expectedLength = getJsonEnvelopeLength(&pendingMessages, 0, 0, 0);
+   envelope = createJsonEnvelopeForRange(&pendingMessages, 0, 0, 0);
+   assertIntEqual(expectedLength, strlen(envelope), "getJsonEnvelopeLength: no messages");
+   release(envelope);
+   clearErrorMessages();
+   setNextSequenceId(0);
 
    resetTestingMemory();
    int expectedAnemometerDataLength    = 360;
@@ -166,7 +230,28 @@ int main(int argc, char* argv[]) {
    assertIntEqual(getTestingMemoryInvocation(0), expectedAnemometerDataLength,      "createJsonPayload: memory allocation - anemometerDataLength");
    assertIntEqual(getTestingMemoryInvocation(1), expectedDirectionVaneDataLength,   "createJsonPayload: memory allocation - directionVaneDataLength");
    assertIntEqual(getTestingMemoryInvocation(2), expectedTotalLength,               "createJsonPayload: memory allocation - totalLength");
-   free(message);
+   release(message);
+
+   useTestingArena(TESTING_ARENA_MAX_SIZE);
+   message = createJsonPayload(anemometerPulses, directionVaneValues, 60, 126);
+   assertIntEqual(getMemoryStatistics().liveAllocations, 1, "arena: temporary buffers of the payload got released");
+   envelope = createJsonEnvelope(&pendingMessages);
+   assertIntEqual(getMemoryStatistics().liveAllocations, 2, "arena: temporary buffers of the envelope got released");
+   assertIntEqual(finishAllocationCycle(), 0, "arena: reset refused while payload and envelope are in use");
+   release(message);
+   release(envelope);
+   assertIntEqual(finishAllocationCycle(), 1, "arena: reset after payload and envelope got released");
+   assertIntEqual(getMemoryStatistics().usedBytes, 0, "arena: empty after the reset");
+
+   stopUsingTestingArena();
+   char *messageFromHeap = createJsonPayload(anemometerPulses, directionVaneValues, 60, 126);
+   useTestingArena(500);
+   message = createJsonPayload(anemometerPulses, directionVaneValues, 60, 126);
+   assertEqual(message, messageFromHeap, "arena: payload falls back to the heap when the arena overflows");
+   assertIntEqual(getMemoryStatistics().overflows, 2, "arena: overflow count");
+   release(message);
+   release(messageFromHeap);
+   stopUsingTestingArena();
 
    return 0;
 }
\ No newline at end of file
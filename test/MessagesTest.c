@@ -16,6 +16,14 @@ static void assertEqual(char const * actual, char const * expected, char const *
    }
 }
 
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
 static int countNotNullMessages() {
    int notNullMessageCount = 0;
    for (int i = 0; i < MAX_NUMBER_OF_MESSAGES_TO_KEEP; i++) {
@@ -76,5 +84,24 @@ int main(int argc, char* argv[]) {
       assertMessageIsEqualTo(i, text);
    }
 
+   removePendingMessages(&pendingMessages, 1, 2);
+   assertPendingMessagesContainsMessageCount(MAX_NUMBER_OF_MESSAGES_TO_KEEP - 2);
+   assertMessageIsEqualTo(0, "test 16");
+   assertMessageIsEqualTo(1, "test 19");
+   assertMessageIsEqualTo(2, "test 20");
+   assertIntEqual(getContiguousMessageCount(&pendingMessages, 0), 1, "removed messages interrupt the contiguous run");
+   assertIntEqual(getContiguousMessageCount(&pendingMessages, 1), 2, "contiguous run of the newest messages");
+   assertIntEqual(getContiguousMessageCount(&pendingMessages, 3), 0, "no contiguous run after the last message");
+
+   removePendingMessages(&pendingMessages, 2, 5);
+   assertPendingMessagesContainsMessageCount(2);
+   assertMessageIsEqualTo(1, "test 19");
+
+   clearPendingMessages(&pendingMessages);
+   addToPendingMessagesWithTime(&pendingMessages, "A", 1000);
+   addToPendingMessagesWithTime(&pendingMessages, "B", 1060);
+   assertIntEqual(pendingMessages.recordedAt[1], 1060, "recording time gets stored");
+   assertIntEqual(getContiguousMessageCount(&pendingMessages, 0), 2, "record numbers continue after clearing");
+
    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/PhaseTimings.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   resetPublishPhaseStatistics();
+
+   startPublishPhases(1000);
+   enterPublishPhase(PHASE_QUEUED, 1000);
+   enterPublishPhase(PHASE_MODEM_ACTIVATION, 1010);
+   enterPublishPhase(PHASE_NETWORK_REGISTRATION, 3010);
+   enterPublishPhase(PHASE_CONNECTION_SETUP, 4010);
+   enterPublishPhase(PHASE_REQUEST_TRANSFER, 4510);
+   enterPublishPhase(PHASE_RESPONSE_WAIT, 4610);
+   finishPublishPhases(5610);
+
+   assertIntEqual(getPublishPhaseStatistics(PHASE_QUEUED)->lastDurationMs, 10, "queued duration");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_MODEM_ACTIVATION)->lastDurationMs, 2000, "modem activation duration");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_NETWORK_REGISTRATION)->lastDurationMs, 1000, "network registration duration");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_CONNECTION_SETUP)->lastDurationMs, 500, "connection setup duration");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_REQUEST_TRANSFER)->lastDurationMs, 100, "request transfer duration");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_RESPONSE_WAIT)->lastDurationMs, 1000, "response wait duration");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_TEARDOWN)->lastDurationMs, 0, "phase that did not occur");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_TEARDOWN)->count, 0, "count of phase that did not occur");
+   assertIntEqual(getLastPublishDurationMs(), 4610, "total publish duration");
+
+   startPublishPhases(10000);
+   enterPublishPhase(PHASE_MODEM_ACTIVATION, 10000);
+   enterPublishPhase(PHASE_RECOVERY, 13000);
+   enterPublishPhase(PHASE_MODEM_ACTIVATION, 15000);
+   finishPublishPhases(16000);
+
+   const PHASE_STATISTICS *activation = getPublishPhaseStatistics(PHASE_MODEM_ACTIVATION);
+   assertIntEqual(activation->lastDurationMs, 4000, "re-entered phase accumulates its duration");
+   assertIntEqual(activation->maxDurationMs, 4000, "max duration");
+   assertIntEqual(activation->totalDurationMs, 6000, "total duration");
+   assertIntEqual(activation->count, 2, "count of publishments containing the phase");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_QUEUED)->lastDurationMs, 0, "last duration gets reset by new publishment");
+   assertIntEqual(getPublishPhaseStatistics(PHASE_QUEUED)->maxDurationMs, 10, "max duration survives new publishment");
+
+   resetPublishPhaseStatistics();
+   assertIntEqual(getPublishPhaseStatistics(PHASE_MODEM_ACTIVATION)->count, 0, "reset clears statistics");
+
+   return 0;
+}
\ No newline at end of file
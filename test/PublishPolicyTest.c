@@ -0,0 +1,127 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/PublishPolicy.h"
+
+static PENDING_MESSAGES pendingMessages;
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+static void assertRange(MESSAGE_RANGE actual, int expectedFirst, int expectedCount, char const * description) {
+   if (actual.first != expectedFirst || actual.count != expectedCount) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: first=%d count=%d\n", expectedFirst, expectedCount);
+      printf("\tactual  : first=%d count=%d\n\n", actual.first, actual.count);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   initializePendingMessages(&pendingMessages);
+   assertRange(selectMessagesToPublish(&pendingMessages, true), 0, 0, "nothing to publish");
+
+   addToPendingMessages(&pendingMessages, "A");
+   assertRange(selectMessagesToPublish(&pendingMessages, true), 0, 1, "single message with good signal");
+   assertRange(selectMessagesToPublish(&pendingMessages, false), 0, 1, "single message with poor signal");
+
+   addToPendingMessages(&pendingMessages, "B");
+   addToPendingMessages(&pendingMessages, "C");
+   assertRange(selectMessagesToPublish(&pendingMessages, true), 0, 3, "whole backlog with good signal");
+   assertRange(selectMessagesToPublish(&pendingMessages, false), 2, 1, "newest message only with poor signal");
+
+   removePendingMessages(&pendingMessages, 2, 1);
+   addToPendingMessages(&pendingMessages, "D");
+   assertRange(selectMessagesToPublish(&pendingMessages, true), 0, 2, "oldest contiguous run with good signal");
+
+   removePendingMessages(&pendingMessages, 0, 2);
+   assertRange(selectMessagesToPublish(&pendingMessages, true), 0, 1, "remaining message with good signal");
+
+   addToPendingMessages(&pendingMessages, "E");
+   assertRange(selectLiveMessagesToPublish(&pendingMessages, true, PUBLISH_ORDER_OLDEST_FIRST), 0, 2, "oldest run first with good signal");
+   assertRange(selectLiveMessagesToPublish(&pendingMessages, false, PUBLISH_ORDER_OLDEST_FIRST), 1, 1, "newest message only with poor signal");
+   assertRange(selectLiveMessagesToPublish(&pendingMessages, true, PUBLISH_ORDER_NEWEST_FIRST), 1, 1, "newest message first with good signal");
+   assertRange(selectLiveMessagesToPublish(&pendingMessages, false, PUBLISH_ORDER_NEWEST_FIRST), 1, 1, "newest message first with poor signal");
+
+   clearPendingMessages(&pendingMessages);
+   assertRange(selectBacklogToDrain(&pendingMessages, 0, 100), 0, 0, "nothing to drain");
+
+   addToPendingMessages(&pendingMessages, "AAAA");
+   addToPendingMessages(&pendingMessages, "BBBB");
+   addToPendingMessages(&pendingMessages, "CCCC");
+   addToPendingMessages(&pendingMessages, "DDDD");
+   assertRange(selectBacklogToDrain(&pendingMessages, 0, 100), 0, 4, "whole backlog fits into the budget");
+   assertRange(selectBacklogToDrain(&pendingMessages, 0, 14), 0, 3, "messages and separators fill the budget exactly");
+   assertRange(selectBacklogToDrain(&pendingMessages, 0, 13), 0, 2, "message exceeding the budget gets left out");
+   assertRange(selectBacklogToDrain(&pendingMessages, 0, 2), 0, 1, "at least one message gets selected");
+   assertRange(selectBacklogToDrain(&pendingMessages, 2, 100), 2, 2, "drain continues after the messages in flight");
+   assertRange(selectBacklogToDrain(&pendingMessages, 4, 100), 4, 0, "nothing left after the messages in flight");
+
+   removePendingMessages(&pendingMessages, 1, 1);
+   assertRange(selectBacklogToDrain(&pendingMessages, 0, 100), 0, 1, "only contiguous messages get drained together");
+
+   clearPendingMessages(&pendingMessages);
+   addToPendingMessages(&pendingMessages, "F");
+   addToPendingMessages(&pendingMessages, "G");
+   addToPendingMessages(&pendingMessages, "H");
+   MESSAGE_RANGE published = { 0, 3 };
+   uint32_t firstRecord    = pendingMessages.recordNumber[0];
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, true, firstRecord + 2 }), 0, 3, "all messages acknowledged");
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, true, firstRecord + 1 }), 0, 2, "partially acknowledged");
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, true, firstRecord - 1 }), 0, 0, "nothing acknowledged");
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, true, firstRecord + 9 }), 0, 3, "acknowledgement beyond the range ignored");
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 500, false, 0, true, firstRecord + 9 }), 0, 0, "acknowledgement beyond the range ignored on error");
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, false, 0 }), 0, 3, "status code without acknowledgement");
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ -1, true, 0, false, 0 }), 0, 0, "response timed out");
+   published.first = 2;
+   published.count = 1;
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, true, firstRecord + 2 }), 0, 3, "acknowledgement covers the messages of previous envelopes");
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, true, firstRecord - 1 }), 2, 1, "acknowledgement before the range ignored");
+   removePendingMessages(&pendingMessages, 1, 1);
+   published.first = 1;
+   assertRange(getDeliveredMessages(&pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, true, firstRecord + 2 }), 0, 2, "acknowledgement covers messages with a gap in between");
+   addToPendingMessages(&pendingMessages, "G");
+   published.first = 0;
+   published.count = 3;
+
+   assertIntEqual(isDeliveryUnknown(false, &pendingMessages, published, &(UPLINK_RESULT){ -1, true, 0, false, 0 }), true, "response timed out");
+   assertIntEqual(isDeliveryUnknown(false, &pendingMessages, published, &(UPLINK_RESULT){ 0, true, 0, false, 0 }), true, "no response");
+   assertIntEqual(isDeliveryUnknown(false, &pendingMessages, published, &(UPLINK_RESULT){ 500, false, 0, false, 0 }), false, "messages not stored");
+   assertIntEqual(isDeliveryUnknown(true, &pendingMessages, published, &(UPLINK_RESULT){ 500, false, 0, false, 0 }), true, "error response does not settle it");
+   assertIntEqual(isDeliveryUnknown(true, &pendingMessages, published, &(UPLINK_RESULT){ 200, false, 0, false, 0 }), false, "status code settles it");
+   assertIntEqual(isDeliveryUnknown(true, &pendingMessages, published, &(UPLINK_RESULT){ 500, false, 0, true, firstRecord }), false, "acknowledgement settles it");
+   assertIntEqual(isDeliveryUnknown(true, &pendingMessages, published, &(UPLINK_RESULT){ 500, false, 0, true, firstRecord + 9 }), true, "acknowledgement beyond the range does not settle it");
+
+   clearPendingMessages(&pendingMessages);
+   addToPendingMessages(&pendingMessages, "F");
+   addToPendingMessages(&pendingMessages, "G");
+   addToPendingMessages(&pendingMessages, "H");
+   firstRecord     = pendingMessages.recordNumber[0];
+   published.first = 1;
+   published.count = 2;
+
+   assertIntEqual(isAcknowledgementInRange(&pendingMessages, published, firstRecord), true, "nothing of the range stored");
+   assertIntEqual(isAcknowledgementInRange(&pendingMessages, published, firstRecord + 2), true, "whole range stored");
+   assertIntEqual(isAcknowledgementInRange(&pendingMessages, published, firstRecord - 1), false, "acknowledgement before the range");
+   assertIntEqual(isAcknowledgementInRange(&pendingMessages, published, firstRecord + 3), false, "acknowledgement beyond the range");
+   assertIntEqual(isAcknowledgementInRange(&pendingMessages, published, 5000), false, "acknowledgement of a previous boot");
+   published.count = 0;
+   assertIntEqual(isAcknowledgementInRange(&pendingMessages, published, firstRecord + 1), false, "empty range");
+
+   clearPendingMessages(&pendingMessages);
+   pendingMessages.nextRecordNumber = 0;
+   addToPendingMessages(&pendingMessages, "I");
+   published.first = 0;
+   published.count = 1;
+   assertIntEqual(isAcknowledgementInRange(&pendingMessages, published, UINT32_MAX), true, "nothing of the very first record stored");
+
+   return 0;
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/RetryPolicy.h"
+
+static uint32_t virtualClockMs = 0;
+static CIRCUIT_BREAKER breaker;
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+static void assertTrue(int condition, char const * description) {
+   if (!condition) {
+      printf("ERROR: %s\n", description);
+   }
+}
+
+/*
+ * Simulates a publishment whose attempts fail after attemptDurationMs and returns the number of attempts.
+ */
+static int simulateFailingPublishment(uint32_t budgetInMs, uint32_t attemptDurationMs, uint32_t randomValue) {
+   RETRY_BUDGET budget;
+   int attempts          = 0;
+   int32_t retryDelayMs  = 0;
+   
+   startRetryBudget(&budget, virtualClockMs, budgetInMs);
+   
+   while (retryDelayMs >= 0) {
+      attempts++;
+      virtualClockMs += attemptDurationMs;
+      retryDelayMs = getRetryDelayMs(&budget, virtualClockMs, randomValue);
+      if (retryDelayMs >= 0) {
+         virtualClockMs += retryDelayMs;
+      }
+   }
+   return attempts;
+}
+
+int main(int argc, char* argv[]) {  
+
+   RETRY_BUDGET budget;
+   virtualClockMs = 1000;
+   startRetryBudget(&budget, virtualClockMs, 60000);
+   assertIntEqual(getRetryDelayMs(&budget, virtualClockMs, 0), INITIAL_BACKOFF_MS / 2, "first delay without jitter");
+   assertIntEqual(getRetryDelayMs(&budget, virtualClockMs, 0), INITIAL_BACKOFF_MS, "delay doubles");
+   assertIntEqual(getRetryDelayMs(&budget, virtualClockMs, 2000), 2 * INITIAL_BACKOFF_MS + 2000, "jitter adds up to half of the delay");
+   assertIntEqual(getRetryDelayMs(&budget, virtualClockMs, 4001), 4 * INITIAL_BACKOFF_MS, "jitter wraps around");
+   for (int i = 0; i < 10; i++) {
+      getRetryDelayMs(&budget, virtualClockMs, 0);
+   }
+   assertIntEqual(getRetryDelayMs(&budget, virtualClockMs, 0xffffffff), MAX_BACKOFF_MS / 2 + (0xffffffff % (MAX_BACKOFF_MS / 2 + 1)), "delay is limited");
+   assertIntEqual(getRetryDelayMs(&budget, virtualClockMs + 50000, 0), -1, "no retry if the next attempt does not fit into the budget");
+
+   virtualClockMs = 0xfffff000;
+   uint32_t startedAt = virtualClockMs;
+   int attempts = simulateFailingPublishment(50000, 8000, 12345);
+   assertTrue((virtualClockMs - startedAt) <= 50000, "failing attempts do not exceed the budget (including overflow of the clock)");
+   assertIntEqual(attempts, 5, "number of attempts within the budget");
+
+   startedAt = virtualClockMs;
+   attempts  = simulateFailingPublishment(10000, 8000, 0);
+   assertIntEqual(attempts, 1, "short budget allows a single attempt only");
+
+   resetCircuitBreaker(&breaker);
+   virtualClockMs = 0;
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs), 1, "closed breaker allows attempts");
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_SERVER, virtualClockMs), RECOVERY_NONE, "server errors do not need a recovery");
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_SERVER, virtualClockMs), RECOVERY_NONE, "repeated server errors do not need a recovery");
+
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_NETWORK, virtualClockMs), RECOVERY_NONE, "first network failure gets tolerated");
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_NETWORK, virtualClockMs), RECOVERY_SOFT_RESET, "repeated network failures cause soft reset");
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_NETWORK, virtualClockMs), RECOVERY_NONE, "failure after soft reset gets tolerated");
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_NETWORK, virtualClockMs), RECOVERY_FUNCTIONALITY_RESET, "escalation to functionality reset");
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs), 1, "breaker still closed");
+   recordUplinkOutcome(&breaker, FAILURE_NETWORK, virtualClockMs);
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_NETWORK, virtualClockMs), RECOVERY_POWER_CYCLE, "escalation to power cycle");
+   assertIntEqual(breaker.state, BREAKER_OPEN, "breaker opens after strongest recovery");
+   assertIntEqual(isCircuitBreakerOpen(&breaker, virtualClockMs + INITIAL_COOLDOWN_MS - 1), 1, "breaker is open during cooldown");
+   assertIntEqual(isCircuitBreakerOpen(&breaker, virtualClockMs + INITIAL_COOLDOWN_MS), 0, "cooldown of breaker elapsed");
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs + INITIAL_COOLDOWN_MS - 1), 0, "open breaker rejects attempts");
+   assertIntEqual(breaker.rejectedAttempts, 1, "rejected attempts get counted");
+
+   virtualClockMs += INITIAL_COOLDOWN_MS;
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs), 1, "breaker allows an attempt after the cooldown");
+   assertIntEqual(breaker.state, BREAKER_HALF_OPEN, "breaker is half open");
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_NETWORK, virtualClockMs), RECOVERY_POWER_CYCLE, "failure of half open breaker causes strongest recovery");
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs + INITIAL_COOLDOWN_MS), 0, "cooldown doubles");
+   virtualClockMs += 2 * INITIAL_COOLDOWN_MS;
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs), 1, "breaker allows an attempt after the doubled cooldown");
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_NONE, virtualClockMs), RECOVERY_NONE, "success needs no recovery");
+   assertIntEqual(breaker.state, BREAKER_CLOSED, "success closes the breaker");
+   assertIntEqual(breaker.recoveries[RECOVERY_POWER_CYCLE], 2, "power cycles get counted");
+
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_MODEM_UNRESPONSIVE, virtualClockMs), RECOVERY_POWER_CYCLE, "unresponsive modem gets power cycled immediately");
+   virtualClockMs += INITIAL_COOLDOWN_MS;
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs), 1, "cooldown got reset by success");
+   recordUplinkOutcome(&breaker, FAILURE_NONE, virtualClockMs);
+
+   recordUplinkOutcome(&breaker, FAILURE_REGISTRATION, virtualClockMs);
+   assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_REGISTRATION, virtualClockMs), RECOVERY_FUNCTIONALITY_RESET, "missing registration causes functionality reset");
+   for (int i = 0; i < 10; i++) {
+      virtualClockMs += MAX_COOLDOWN_MS;
+      isUplinkAllowed(&breaker, virtualClockMs);
+      assertIntEqual(recordUplinkOutcome(&breaker, FAILURE_REGISTRATION, virtualClockMs), RECOVERY_FUNCTIONALITY_RESET, "missing registration never causes power cycle");
+   }
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs + MAX_COOLDOWN_MS - 1), 0, "cooldown is limited");
+   assertIntEqual(isUplinkAllowed(&breaker, virtualClockMs + MAX_COOLDOWN_MS), 1, "limited cooldown elapsed");
+   
+   assertTrue(strcmp(getRecoveryActionName(RECOVERY_POWER_CYCLE), "powerCycle") == 0, "name of recovery action");
+   assertTrue(strcmp(getFailureClassName(FAILURE_REGISTRATION), "registration") == 0, "name of failure class");
+
+   return 0;
+}
\ No newline at end of file
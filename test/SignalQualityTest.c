@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/SignalQuality.h"
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   assertIntEqual(parseSignalQuality("+CSQ: 17,0"), 17, "parse signal quality");
+   assertIntEqual(parseSignalQuality("+CSQ: 99,99"), RSSI_UNKNOWN, "parse unknown signal quality");
+   assertIntEqual(parseSignalQuality("+CSQ: 45,0"), -1, "signal quality out of range");
+   assertIntEqual(parseSignalQuality("+CREG: 0,1"), -1, "not a signal quality response");
+   assertIntEqual(parseSignalQuality("+CSQ:"), -1, "signal quality response without value");
+
+   assertIntEqual(parseRegistrationStatus("+CREG: 0,1"), REGISTRATION_HOME, "parse registration status");
+   assertIntEqual(parseRegistrationStatus("+CREG: 2,5,\"1A2B\",\"3C4D\""), REGISTRATION_ROAMING, "parse registration status with location");
+   assertIntEqual(parseRegistrationStatus("+CREG: 0"), -1, "registration status missing");
+   assertIntEqual(parseRegistrationStatus("OK"), -1, "not a registration response");
+
+   resetSignalQuality();
+   assertIntEqual(getSmoothedRssi(), -1, "no signal quality known");
+   assertIntEqual(isSignalGood(), 1, "unknown signal counts as good");
+   assertIntEqual(isCoverageProblem(100), 0, "no coverage problem without information");
+
+   recordSignalQuality(20, 100);
+   assertIntEqual(getSmoothedRssi(), 20, "first sample initializes the estimate");
+   recordSignalQuality(4, 160);
+   assertIntEqual(getSmoothedRssi(), 16, "estimate moves a quarter towards the new sample");
+   assertIntEqual(isSignalGood(), 1, "single poor sample does not make the signal poor");
+   assertIntEqual(isCoverageProblem(160), 1, "poor latest sample indicates a coverage problem");
+   assertIntEqual(isCoverageProblem(160 + SIGNAL_SAMPLE_MAX_AGE_SECONDS + 1), 0, "outdated samples get ignored");
+
+   recordSignalQuality(RSSI_UNKNOWN, 220);
+   recordSignalQuality(RSSI_UNKNOWN, 280);
+   recordSignalQuality(RSSI_UNKNOWN, 340);
+   assertIntEqual(isSignalGood(), 0, "repeatedly unknown signal is poor");
+
+   recordSignalQuality(25, 400);
+   assertIntEqual(isCoverageProblem(400), 0, "good latest sample is no coverage problem");
+   recordRegistrationStatus(REGISTRATION_SEARCHING, 410);
+   assertIntEqual(isCoverageProblem(410), 1, "searching for a network is a coverage problem");
+   recordRegistrationStatus(REGISTRATION_HOME, 420);
+   assertIntEqual(isCoverageProblem(420), 0, "registered again");
+
+   SIGNAL_SAMPLE samples[SIGNAL_HISTORY_LENGTH];
+   assertIntEqual(getSignalHistory(samples, 2), 2, "history limited by caller");
+   assertIntEqual(samples[0].rssi, RSSI_UNKNOWN, "history is sorted oldest first");
+   assertIntEqual(samples[1].rssi, 25, "history contains newest sample last");
+
+   for (int i = 0; i < SIGNAL_HISTORY_LENGTH + 3; i++) {
+      recordSignalQuality(i % 32, 500 + i);
+   }
+   assertIntEqual(getSignalHistory(samples, SIGNAL_HISTORY_LENGTH), SIGNAL_HISTORY_LENGTH, "history is full");
+   assertIntEqual(samples[0].timeInSeconds, 503, "oldest samples get overwritten");
+   assertIntEqual(samples[SIGNAL_HISTORY_LENGTH - 1].registrationStatus, REGISTRATION_HOME, "samples contain registration status");
+
+   return 0;
+}
\ No newline at end of file
@@ -0,0 +1,840 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../main/BacklogDrain.h"
+#include "../main/EnvelopePacker.h"
+#include "../main/ErrorMessages.h"
+#include "../main/LiveLatency.h"
+#include "../main/MessageFormatter.h"
+#include "../main/Messages.h"
+#include "../main/PublishPolicy.h"
+#include "../main/RetryPolicy.h"
+#include "HeapUsage.h"
+#include "TestingMemory.h"
+
+/*
+ * Runs the acquisition and the uplink pipeline of main.c on a virtual clock with synthetic wind and a stand-in for the
+ * transport, e.g.
+ *
+ *    simulator --days 7 --wind storm --uplink outage --csv > storm.csv
+ *
+ * The simulation is deterministic (same seed, same results). It uses the modules of the firmware for the formatting,
+ * the pending messages, the publish order, the packing of the envelopes, the backlog drain, the acknowledgements, the
+ * retries and the circuit breaker. The tasks of main.c and the uplink task get replaced by events on the virtual clock 
+ * that follow the same timing:
+ *
+ * - The collector counts the pulses while it waits 1000 ms (vTaskDelay on a tick boundary) and takes a sample. The
+ *   sample taken when the 60 values of a publishment are complete gets discarded (like in valueCollectorTask).
+ * - The debounce task counts a pulse and ignores the following ones till the delay of 1000 / 89 ms (rounded down to
+ *   ticks) elapsed.
+ * - The main loop runs every 250 ms.
+ * - An uplink job runs its attempts (including the retry delays and recoveries) in parallel to the sampling.
+ * - The stand-in for the service stores the envelopes of the delivered attempts and of some attempts whose response 
+ *   timed out, and acknowledges the highest record id up to which it stored all records from the oldest pending one on (--ack off: 
+ *   status code only).
+ *
+ * Not simulated: the preparation of the connection, deep sleep, the transport selection (one transport), the prebuilding
+ * of the drain envelopes and the attachments of the envelopes.
+ */
+
+#define MEASUREMENTS_PER_PUBLISHMENT      60
+#define MAX_PULSES_PER_SECOND             89
+#define OK_RESPONSE                       200
+#define PUBLISH_BUDGET_IN_MS              50000
+#define MIN_BACKLOG_BUDGET_IN_MS          10000
+#define BACKLOG_SAFETY_MARGIN_IN_MS       5000
+#define MAIN_LOOP_PERIOD_US               250000ull
+#define WAIT_POLL_PERIOD_US               100000ull
+#define UPLINK_STARTUP_US                 8000000ull
+#define US_PER_MS                         1000ull
+#define US_PER_SECOND                     1000000ull
+#define US_PER_HOUR                       (3600ull * US_PER_SECOND)
+#define DEFAULT_TICK_MS                   10
+#define DEFAULT_SAMPLE_OVERHEAD_US        300
+#define PUBLISH_LATENCY_BUCKET_MS         100
+#define PUBLISH_LATENCY_BUCKET_COUNT      601   // the last bucket contains the latencies of 60 s and more
+#define MAX_DATA_LENGTH                   0     // no limit of the transport
+#define HEAP_SIZE                         (160 * 1024)
+#define ARENA_SIZE                        16384
+#define DRAIN_ENVELOPE_BUDGET_BYTES       4095
+#define RESPONSE_LOST_CHANCE              0.3   // of an attempt that timed out, the service stored the envelope anyway
+#define STORED_BEYOND_GAP_CAPACITY        256
+
+typedef enum {
+   WIND_CALM,
+   WIND_GUSTY,
+   WIND_STORM
+} WindProfile;
+
+typedef enum {
+   UPLINK_STEADY,
+   UPLINK_FLAKY,
+   UPLINK_OUTAGE
+} UplinkPattern;
+
+typedef struct {
+   WindProfile wind;
+   UplinkPattern uplink;
+   int days;
+   uint32_t seed;
+   bool goodSignal;
+   PublishOrder order;
+   bool drain;
+   bool acknowledge;
+   size_t envelopeBytes;
+   uint64_t tickUs;
+   uint64_t sampleOverheadUs;
+   bool csv;
+} CONFIGURATION;
+
+typedef struct {
+   uint64_t pulsesGenerated;
+   uint64_t pulsesCounted;
+   uint64_t pulsesLostByDebounce;
+   uint64_t pulsesLostBetweenSamples;
+   uint32_t samplesStored;
+   uint32_t samplesDiscarded;
+   uint32_t samplesMissed;
+   uint32_t messagesRecorded;
+   uint32_t messagesOverwritten;
+   uint32_t messagesDelivered;
+   uint32_t publishments;
+   uint32_t failedPublishments;
+   uint32_t attempts;
+   uint32_t drainedEnvelopes;
+   uint32_t duplicateRecords;
+   uint32_t maxBacklog;
+   uint32_t latencyHistogram[PUBLISH_LATENCY_BUCKET_COUNT];
+   uint32_t latencyCount;
+   uint32_t maxLatencyMs;
+   long peakHeapBytes;
+} STATISTICS;
+
+typedef struct {
+   uint64_t doneAtUs;
+   int httpStatusCode;
+   uint32_t durationMs;
+   int attempts;
+   bool acknowledged;
+   uint32_t acknowledgedRecordId;
+} UPLINK_OUTCOME;
+
+static CONFIGURATION configuration = {
+   .wind             = WIND_GUSTY,
+   .uplink           = UPLINK_STEADY,
+   .days             = 1,
+   .seed             = 1,
+   .goodSignal       = true,
+   .order            = PUBLISH_ORDER_NEWEST_FIRST,
+   .drain            = true,
+   .acknowledge      = true,
+   .envelopeBytes    = 0,
+   .tickUs           = DEFAULT_TICK_MS * US_PER_MS,
+   .sampleOverheadUs = DEFAULT_SAMPLE_OVERHEAD_US,
+   .csv              = false
+};
+
+static uint32_t randomState;
+
+// wind
+static uint64_t nextPulseUs        = 0;
+static uint64_t debounceUntilUs    = 0;
+static uint64_t gustUntilUs        = 0;
+static uint64_t nextGustCheckUs    = 0;
+static double gustHz               = 0;
+static double directionDegrees     = 180;
+static uint32_t pulseCount         = 0;
+
+// collector (valueCollectorTask)
+static uint64_t windowStartedAtUs  = 0;
+static uint64_t nextSampleUs       = 0;
+static bool collectorWaiting       = false;
+static uint64_t waitingSinceUs     = 0;
+static size_t nextIndex            = 0;
+static uint16_t anemometerPulses[MEASUREMENTS_PER_PUBLISHMENT];
+static uint16_t directionVaneValues[MEASUREMENTS_PER_PUBLISHMENT];
+static uint16_t completedAnemometerPulses[MEASUREMENTS_PER_PUBLISHMENT];
+static uint16_t completedDirectionVaneValues[MEASUREMENTS_PER_PUBLISHMENT];
+static uint64_t firstSampleUs      = 0;
+static bool firstSampleTaken       = false;
+
+// main loop
+static PENDING_MESSAGES pendingMessages;
+static MESSAGE_RANGE publishedRange;
+static bool sendMeasuredValues     = false;
+static bool publishInFlight        = false;
+static bool publishBacklog         = false;
+static bool deliveryUnknown        = false;
+static bool jsonEnvelopeDrained    = false;
+static char *jsonEnvelope          = NULL;
+static time_t timeOfCompletion;
+static time_t timeOfPreviousMessage;
+static UPLINK_OUTCOME uplinkOutcome;
+static CIRCUIT_BREAKER breaker;
+
+// stand-in for the service: all records below recordsWithoutGap got stored (or never arrive), some beyond it too
+static uint32_t recordsWithoutGap  = 0;
+static uint32_t storedBeyondGap[STORED_BEYOND_GAP_CAPACITY + MAX_NUMBER_OF_MESSAGES_TO_KEEP];  // plus the records of an envelope
+static int storedBeyondGapCount    = 0;
+
+static STATISTICS hourStatistics;
+static STATISTICS totalStatistics;
+
+static uint32_t nextRandom() {
+   // xorshift32
+   randomState ^= randomState << 13;
+   randomState ^= randomState >> 17;
+   randomState ^= randomState << 5;
+   return randomState;
+}
+
+static double uniform() {
+   return (nextRandom() >> 8) / (double)(1u << 24);
+}
+
+static double exponential(double mean) {
+   return -mean * log(1.0 - uniform());
+}
+
+static uint32_t toMs(uint64_t us) {
+   // the firmware uses 32 bit milliseconds too
+   return (uint32_t)(us / US_PER_MS);
+}
+
+static void addLatency(STATISTICS *statistics, uint32_t latencyMs) {
+   uint32_t bucket = latencyMs / PUBLISH_LATENCY_BUCKET_MS;
+   statistics->latencyHistogram[(bucket < PUBLISH_LATENCY_BUCKET_COUNT) ? bucket : PUBLISH_LATENCY_BUCKET_COUNT - 1]++;
+   statistics->latencyCount++;
+   statistics->maxLatencyMs = (latencyMs > statistics->maxLatencyMs) ? latencyMs : statistics->maxLatencyMs;
+}
+
+/*
+ * Returns the upper bound of the bucket that contains the percentile (at most the maximum), because the simulation 
+ * must not allocate heap for its statistics.
+ */
+static uint32_t getPercentileMs(const STATISTICS *statistics, int percent) {
+   uint32_t threshold   = (statistics->latencyCount * percent + 99) / 100;
+   uint32_t accumulated = 0;
+
+   for (int bucket = 0; bucket < PUBLISH_LATENCY_BUCKET_COUNT - 1 && threshold > 0; bucket++) {
+      accumulated += statistics->latencyHistogram[bucket];
+      if (accumulated >= threshold) {
+         uint32_t upperBound = (bucket + 1) * PUBLISH_LATENCY_BUCKET_MS;
+         return (upperBound < statistics->maxLatencyMs) ? upperBound : statistics->maxLatencyMs;
+      }
+   }
+   return statistics->maxLatencyMs;
+}
+
+/*
+ * Pulses per second of the anemometer (89 Hz is the maximum the debouncing can count).
+ */
+static double getWindHz(uint64_t nowUs) {
+   double hours   = (double)nowUs / US_PER_HOUR;
+   double base    = 0;
+   double gustMin = 0;
+   double gustMax = 0;
+   double chance  = 0;
+
+   switch (configuration.wind) {
+      case WIND_CALM:   base = 0.8 + 0.6 * sin(2 * M_PI * hours * 6);  break;
+      case WIND_GUSTY:  base = 15 + 5 * sin(2 * M_PI * hours);         gustMin = 15; gustMax = 30; chance = 1.0 / 30; break;
+      case WIND_STORM:  base = 75 + 15 * sin(2 * M_PI * hours);        gustMin = 20; gustMax = 45; chance = 1.0 / 20; break;
+   }
+
+   // a gust can start once per second and lasts 3 - 10 seconds
+   while (nowUs >= nextGustCheckUs) {
+      if (nextGustCheckUs >= gustUntilUs && uniform() < chance) {
+         gustHz      = gustMin + uniform() * (gustMax - gustMin);
+         gustUntilUs = nextGustCheckUs + (3 + nextRandom() % 8) * US_PER_SECOND;
+      }
+      nextGustCheckUs += US_PER_SECOND;
+   }
+
+   double hz = base + ((nowUs < gustUntilUs) ? gustHz : 0);
+   return (hz > 0) ? hz : 0;
+}
+
+/*
+ * The ISR queues a pulse only if the queue (length 1) is empty. The debounce task counts it and sleeps 1000 / 89 ms
+ * (vTaskDelay -> ends on a tick boundary) and drops a pulse queued in the meantime.
+ */
+static void generatePulsesTill(uint64_t tillUs) {
+   uint64_t debounceTicks = (1000 / MAX_PULSES_PER_SECOND) * US_PER_MS / configuration.tickUs;
+
+   while (nextPulseUs < tillUs) {
+      uint64_t pulseUs = nextPulseUs;
+      double hz        = getWindHz(pulseUs);
+
+      if (hz < 0.1) {
+         nextPulseUs += US_PER_SECOND;
+         continue;
+      }
+
+      hourStatistics.pulsesGenerated++;
+      if (pulseUs >= debounceUntilUs) {
+         pulseCount++;
+         hourStatistics.pulsesCounted++;
+         debounceUntilUs = (pulseUs / configuration.tickUs + debounceTicks) * configuration.tickUs;
+      } else {
+         hourStatistics.pulsesLostByDebounce++;
+      }
+
+      // the intervals vary by +/- 10 %
+      nextPulseUs = pulseUs + (uint64_t)((US_PER_SECOND / hz) * (0.9 + 0.2 * uniform())) + 1;
+   }
+}
+
+static uint16_t readDirectionVane() {
+   double step       = (configuration.wind == WIND_CALM) ? 5 : (configuration.wind == WIND_GUSTY ? 20 : 35);
+   directionDegrees += (uniform() - 0.5) * 2 * step;
+   directionDegrees  = fmod(directionDegrees + 360, 360);
+   double raw        = directionDegrees / 360 * 4095 + (uniform() - 0.5) * 20;
+   return (raw < 0) ? 0 : (raw > 4095 ? 4095 : (uint16_t)raw);
+}
+
+static uint64_t getTickStart(uint64_t timeUs) {
+   return (timeUs / configuration.tickUs) * configuration.tickUs;
+}
+
+static void startSampleWindow(uint64_t nowUs) {
+   // pulses counted while the collector did not wait for a sample get lost (pulseCount = 0)
+   generatePulsesTill(nowUs);
+   hourStatistics.pulsesLostBetweenSamples += pulseCount;
+   pulseCount        = 0;
+   windowStartedAtUs = nowUs;
+   nextSampleUs      = getTickStart(nowUs) + 1000 * US_PER_MS;
+}
+
+static void takeSample(uint64_t nowUs) {
+   generatePulsesTill(nowUs);
+   uint16_t pulses             = pulseCount;
+   uint16_t directionVaneValue = readDirectionVane();
+   pulseCount                  = 0;
+
+   if (!firstSampleTaken) {
+      firstSampleUs    = nowUs;
+      firstSampleTaken = true;
+   }
+
+   if (nextIndex < MEASUREMENTS_PER_PUBLISHMENT) {
+      anemometerPulses[nextIndex]    = pulses;
+      directionVaneValues[nextIndex] = directionVaneValue;
+      nextIndex++;
+      hourStatistics.samplesStored++;
+      startSampleWindow(nowUs + configuration.sampleOverheadUs);
+      return;
+   }
+
+   hourStatistics.samplesDiscarded++;
+   if (sendMeasuredValues) {
+      collectorWaiting = true;
+      waitingSinceUs   = nowUs;
+      nextSampleUs     = UINT64_MAX;
+      return;
+   }
+   memcpy(completedAnemometerPulses, anemometerPulses, sizeof(anemometerPulses));
+   memcpy(completedDirectionVaneValues, directionVaneValues, sizeof(directionVaneValues));
+   timeOfCompletion   = nowUs / US_PER_SECOND;
+   sendMeasuredValues = true;
+   nextIndex          = 0;
+   startSampleWindow(nowUs + configuration.sampleOverheadUs);
+}
+
+/*
+ * The collector polls every 100 ms while it waits till the previous values got sent.
+ */
+static void resumeCollector(uint64_t nowUs) {
+   uint64_t waitedUs  = nowUs - waitingSinceUs;
+   uint64_t resumedUs = waitingSinceUs + ((waitedUs + WAIT_POLL_PERIOD_US - 1) / WAIT_POLL_PERIOD_US) * WAIT_POLL_PERIOD_US;
+
+   hourStatistics.samplesMissed += (resumedUs - waitingSinceUs) / US_PER_SECOND;
+   collectorWaiting = false;
+   memcpy(completedAnemometerPulses, anemometerPulses, sizeof(anemometerPulses));
+   memcpy(completedDirectionVaneValues, directionVaneValues, sizeof(directionVaneValues));
+   timeOfCompletion   = resumedUs / US_PER_SECOND;
+   sendMeasuredValues = true;
+   nextIndex          = 0;
+   startSampleWindow(resumedUs + configuration.sampleOverheadUs);
+}
+
+static bool isOutage(uint64_t nowUs) {
+   uint64_t hourOfDay = (nowUs / US_PER_HOUR) % 24;
+   return configuration.uplink == UPLINK_OUTAGE && hourOfDay >= 2 && hourOfDay < 5;
+}
+
+/*
+ * Returns the duration of an attempt and its failure class (FAILURE_NONE = delivered).
+ */
+static uint32_t simulateAttempt(uint64_t nowUs, FailureClass *failureClass) {
+   double failureRate = (configuration.uplink == UPLINK_FLAKY) ? 0.25 : 0.03;
+   double baseMs      = (configuration.uplink == UPLINK_FLAKY) ? 5000 : 3000;
+   double meanMs      = (configuration.uplink == UPLINK_FLAKY) ? 4000 : 2000;
+
+   if (isOutage(nowUs)) {
+      *failureClass = FAILURE_REGISTRATION;
+      return 10000;
+   }
+
+   uint32_t durationMs = (uint32_t)(baseMs + exponential(meanMs));
+   if (uniform() >= failureRate) {
+      *failureClass = FAILURE_NONE;
+      return (durationMs < 20000) ? durationMs : 20000;
+   }
+
+   double kind = uniform();
+   if (kind < 0.6) {
+      *failureClass = FAILURE_NETWORK;
+      return 20000;
+   }
+   if (kind < 0.9) {
+      *failureClass = FAILURE_SERVER;
+      return durationMs;
+   }
+   *failureClass = FAILURE_REGISTRATION;
+   return 10000;
+}
+
+static uint32_t getRecoveryDurationMs(RecoveryAction action) {
+   switch (action) {
+      case RECOVERY_SOFT_RESET:           return 1000;
+      case RECOVERY_FUNCTIONALITY_RESET:  return 5000;
+      case RECOVERY_POWER_CYCLE:          return 15000;
+      default:                            return 0;
+   }
+}
+
+static int findStoredBeyondGap(uint32_t recordId) {
+   for (int i = 0; i < storedBeyondGapCount; i++) {
+      if (storedBeyondGap[i] == recordId) {
+         return i;
+      }
+   }
+   return -1;
+}
+
+/*
+ * Moves the gap of the service behind the records it stored and behind the ones the sensor does not keep anymore 
+ * (oldestRecordId of the envelope, see README.md). When it keeps STORED_BEYOND_GAP_CAPACITY records beyond the gap, it
+ * stops waiting for the records of the gap.
+ */
+static void advanceGap(uint32_t oldestRecordId) {
+   recordsWithoutGap = (oldestRecordId > recordsWithoutGap) ? oldestRecordId : recordsWithoutGap;
+   for (int i = storedBeyondGapCount - 1; i >= 0; i--) {
+      if (storedBeyondGap[i] < recordsWithoutGap) {
+         storedBeyondGap[i] = storedBeyondGap[--storedBeyondGapCount];
+      }
+   }
+   while (storedBeyondGapCount > 0) {
+      int index = findStoredBeyondGap(recordsWithoutGap);
+      if (index >= 0) {
+         storedBeyondGap[index] = storedBeyondGap[--storedBeyondGapCount];
+      } else if (storedBeyondGapCount < STORED_BEYOND_GAP_CAPACITY) {
+         break;
+      }
+      recordsWithoutGap++;
+   }
+}
+
+/*
+ * The service stores the records of the published envelope and counts the ones it received before.
+ */
+static void storeInService() {
+   advanceGap(pendingMessages.recordNumber[0]);
+   for (int i = publishedRange.first; i < publishedRange.first + publishedRange.count; i++) {
+      uint32_t recordId = pendingMessages.recordNumber[i];
+      bool duplicate    = recordId < recordsWithoutGap || findStoredBeyondGap(recordId) >= 0;
+      hourStatistics.duplicateRecords += duplicate ? 1 : 0;
+      if (!duplicate) {
+         storedBeyondGap[storedBeyondGapCount++] = recordId;
+      }
+   }
+
+   advanceGap(pendingMessages.recordNumber[0]);
+}
+
+/*
+ * Same sequence of attempts as processJob(...) in Uplink.c.
+ */
+static UPLINK_OUTCOME simulateUplinkJob(uint64_t submittedAtUs, uint32_t budgetInMs) {
+   UPLINK_OUTCOME outcome = { submittedAtUs, 0, 0, 0, false, 0 };
+   uint64_t deadlineUs    = submittedAtUs + budgetInMs * US_PER_MS;
+   uint64_t nowUs         = submittedAtUs;
+   int32_t retryDelayMs   = 0;
+   RETRY_BUDGET budget;
+
+   startRetryBudget(&budget, toMs(submittedAtUs), budgetInMs);
+
+   while (retryDelayMs >= 0 && nowUs < deadlineUs) {
+      if (!isUplinkAllowed(&breaker, toMs(nowUs))) {
+         addErrorMessage("UPLINK_CIRCUIT_OPEN");
+         break;
+      }
+
+      FailureClass failureClass;
+      uint64_t durationUs = simulateAttempt(nowUs, &failureClass) * US_PER_MS;
+      if (nowUs + durationUs > deadlineUs) {
+         durationUs   = deadlineUs - nowUs;
+         failureClass = FAILURE_NETWORK;
+      }
+      nowUs += durationUs;
+      outcome.attempts++;
+      outcome.httpStatusCode = (failureClass == FAILURE_NONE) ? OK_RESPONSE : (failureClass == FAILURE_SERVER ? 500 : 0);
+      if (failureClass == FAILURE_NONE || (failureClass == FAILURE_NETWORK && uniform() < RESPONSE_LOST_CHANCE)) {
+         storeInService();
+      }
+      outcome.acknowledged         = configuration.acknowledge && failureClass == FAILURE_NONE && recordsWithoutGap > 0;
+      outcome.acknowledgedRecordId = recordsWithoutGap - 1;
+
+      RecoveryAction action = recordUplinkOutcome(&breaker, failureClass, toMs(nowUs));
+      nowUs                += getRecoveryDurationMs(action) * US_PER_MS;
+
+      if (failureClass == FAILURE_NONE) {
+         break;
+      }
+      if (failureClass == FAILURE_SERVER) {
+         addErrorMessage("HTTP_RESPONSE_CODE_500");
+      }
+
+      retryDelayMs = getRetryDelayMs(&budget, toMs(nowUs), nextRandom());
+      if (retryDelayMs >= 0) {
+         nowUs += retryDelayMs * US_PER_MS;
+      }
+   }
+
+   if (outcome.httpStatusCode != OK_RESPONSE && nowUs >= deadlineUs) {
+      addErrorMessage("PUBLISH_DEADLINE_EXCEEDED");
+   }
+   outcome.doneAtUs   = nowUs;
+   outcome.durationMs = toMs(nowUs - submittedAtUs);
+   return outcome;
+}
+
+static void submitEnvelope(uint64_t nowUs, MESSAGE_RANGE range, uint32_t budgetInMs) {
+   int indexOfLastMessage           = range.first + range.count - 1;
+   uint32_t secondsSinceLastMessage = nowUs / US_PER_SECOND - pendingMessages.recordedAt[indexOfLastMessage];
+
+   publishedRange  = range;
+   jsonEnvelope    = createJsonEnvelopeForRange(&pendingMessages, range.first, range.count, secondsSinceLastMessage);
+   uplinkOutcome   = simulateUplinkJob(nowUs, budgetInMs);
+   publishInFlight = true;
+   hourStatistics.publishments++;
+   hourStatistics.attempts += uplinkOutcome.attempts;
+}
+
+/*
+ * Same selection and packing as publishPendingMessages(...) in main.c.
+ */
+static void publishPendingMessages(uint64_t nowUs, uint32_t budgetInMs, bool liveData) {
+   bool backlogAllowed      = configuration.goodSignal && !deliveryUnknown;
+   MESSAGE_RANGE candidates = liveData ? selectLiveMessagesToPublish(&pendingMessages, backlogAllowed, configuration.order)
+                                       : selectMessagesToPublish(&pendingMessages, backlogAllowed);
+   if (candidates.count == 0) {
+      return;
+   }
+
+   MESSAGE_RANGE range = packEnvelope(&pendingMessages, candidates, configuration.envelopeBytes, nowUs / US_PER_SECOND);
+   if (range.count == 0) {
+      addErrorMessage("ENVELOPE_EXCEEDS_BUDGET");
+      return;
+   }
+   submitEnvelope(nowUs, range, budgetInMs);
+}
+
+static uint32_t getBacklogBudgetInMs() {
+   uint32_t timeLeftInMs = (MEASUREMENTS_PER_PUBLISHMENT - nextIndex) * 1000;
+   return (timeLeftInMs > BACKLOG_SAFETY_MARGIN_IN_MS) ? timeLeftInMs - BACKLOG_SAFETY_MARGIN_IN_MS : 0;
+}
+
+static void publishBacklogIfTimeLeft(uint64_t nowUs) {
+   uint32_t budgetInMs = getBacklogBudgetInMs();
+
+   if (budgetInMs >= MIN_BACKLOG_BUDGET_IN_MS) {
+      publishPendingMessages(nowUs, budgetInMs, false);
+   }
+   publishBacklog = false;
+}
+
+/*
+ * Same as continueBacklogDrain() in main.c, but the next envelope does not get built in advance.
+ */
+static void continueBacklogDrain(uint64_t nowUs) {
+   if (pendingMessages.count == 0 || !configuration.goodSignal) {
+      stopBacklogDrain(toMs(nowUs), pendingMessages.count == 0);
+      return;
+   }
+
+   uint32_t budgetInMs = getBacklogBudgetInMs();
+   if (budgetInMs < MIN_BACKLOG_BUDGET_IN_MS) {
+      return;
+   }
+
+   size_t budgetInBytes     = (configuration.envelopeBytes < DRAIN_ENVELOPE_BUDGET_BYTES) ? configuration.envelopeBytes : DRAIN_ENVELOPE_BUDGET_BYTES;
+   MESSAGE_RANGE candidates = selectBacklogToDrain(&pendingMessages, 0, budgetInBytes);
+   MESSAGE_RANGE range      = packEnvelope(&pendingMessages, candidates, budgetInBytes, nowUs / US_PER_SECOND);
+   if (range.count == 0) {
+      stopBacklogDrain(toMs(nowUs), false);
+      return;
+   }
+   jsonEnvelopeDrained = true;
+   submitEnvelope(nowUs, range, budgetInMs);
+}
+
+static void sendMeasuredValuesToServer(uint64_t nowUs) {
+   uint16_t secondSincePreviousMessage = 0;
+   time_t now                          = timeOfCompletion;
+
+   if (pendingMessages.count == 0) {
+      timeOfPreviousMessage = now;
+   } else {
+      secondSincePreviousMessage = now - timeOfPreviousMessage;
+      timeOfPreviousMessage      = now;
+   }
+
+   if (pendingMessages.count == MAX_NUMBER_OF_MESSAGES_TO_KEEP) {
+      hourStatistics.messagesOverwritten++;
+   }
+   char* jsonMessage = createJsonPayload(completedAnemometerPulses, completedDirectionVaneValues, MEASUREMENTS_PER_PUBLISHMENT, secondSincePreviousMessage);
+   addToPendingMessagesWithTime(&pendingMessages, jsonMessage, now);
+   release(jsonMessage);
+   hourStatistics.messagesRecorded++;
+   recordLiveMessage(pendingMessages.recordNumber[pendingMessages.count - 1], now * 1000);
+   publishPendingMessages(nowUs, PUBLISH_BUDGET_IN_MS, true);
+}
+
+/*
+ * Same as handlePublishResult(...) in main.c.
+ */
+static void handlePublishResult(uint64_t nowUs) {
+   UPLINK_RESULT result    = { uplinkOutcome.httpStatusCode, false, uplinkOutcome.durationMs, uplinkOutcome.acknowledged, uplinkOutcome.acknowledgedRecordId };
+   deliveryUnknown         = isDeliveryUnknown(deliveryUnknown, &pendingMessages, publishedRange, &result);
+   MESSAGE_RANGE delivered = getDeliveredMessages(&pendingMessages, publishedRange, &result);
+
+   for (int i = delivered.first; i < delivered.first + delivered.count; i++) {
+      recordDeliveredMessages(pendingMessages.recordNumber[i], 1, toMs(nowUs));
+   }
+   removePendingMessages(&pendingMessages, delivered.first, delivered.count);
+   hourStatistics.messagesDelivered += delivered.count;
+   hourStatistics.drainedEnvelopes  += (jsonEnvelopeDrained && delivered.count > 0) ? 1 : 0;
+
+   if (uplinkOutcome.httpStatusCode == OK_RESPONSE) {
+      clearErrorMessages();
+      addLatency(&hourStatistics, uplinkOutcome.durationMs);
+   } else {
+      hourStatistics.failedPublishments++;
+   }
+
+   if (uplinkOutcome.httpStatusCode == OK_RESPONSE && delivered.count > 0) {
+      publishBacklog = pendingMessages.count > 0 && configuration.goodSignal;
+      if (configuration.drain && publishBacklog) {
+         if (!isBacklogDrainActive()) {
+            startBacklogDrain(toMs(nowUs));
+         }
+         publishBacklog = false;
+      }
+   } else if (isBacklogDrainActive()) {
+      stopBacklogDrain(toMs(nowUs), false);
+   }
+
+   release(jsonEnvelope);
+   jsonEnvelope        = NULL;
+   jsonEnvelopeDrained = false;
+   publishInFlight     = false;
+}
+
+static void runMainLoop(uint64_t nowUs) {
+   if (publishInFlight && nowUs >= uplinkOutcome.doneAtUs) {
+      handlePublishResult(nowUs);
+   }
+   if (nowUs < UPLINK_STARTUP_US) {
+      return;
+   }
+   if (sendMeasuredValues && !publishInFlight) {
+      sendMeasuredValuesToServer(nowUs);
+      sendMeasuredValues = false;
+      if (collectorWaiting) {
+         resumeCollector(nowUs);
+      }
+   }
+   if (publishBacklog && !publishInFlight && !sendMeasuredValues) {
+      publishBacklogIfTimeLeft(nowUs);
+   }
+   if (isBacklogDrainActive() && !publishInFlight && !sendMeasuredValues) {
+      continueBacklogDrain(nowUs);
+   }
+   if (pendingMessages.count > hourStatistics.maxBacklog) {
+      hourStatistics.maxBacklog = pendingMessages.count;
+   }
+}
+
+/*
+ * Elapsed time minus one second per stored sample.
+ */
+static int64_t getDriftMs(uint64_t nowUs, uint32_t samplesStored) {
+   if (!firstSampleTaken) {
+      return 0;
+   }
+   return ((int64_t)(nowUs - firstSampleUs) - (int64_t)(samplesStored - 1) * (int64_t)US_PER_SECOND) / (int64_t)US_PER_MS;
+}
+
+static void addToTotal(const STATISTICS *hour) {
+   totalStatistics.pulsesGenerated          += hour->pulsesGenerated;
+   totalStatistics.pulsesCounted            += hour->pulsesCounted;
+   totalStatistics.pulsesLostByDebounce     += hour->pulsesLostByDebounce;
+   totalStatistics.pulsesLostBetweenSamples += hour->pulsesLostBetweenSamples;
+   totalStatistics.samplesStored            += hour->samplesStored;
+   totalStatistics.samplesDiscarded         += hour->samplesDiscarded;
+   totalStatistics.samplesMissed            += hour->samplesMissed;
+   totalStatistics.messagesRecorded         += hour->messagesRecorded;
+   totalStatistics.messagesOverwritten      += hour->messagesOverwritten;
+   totalStatistics.messagesDelivered        += hour->messagesDelivered;
+   totalStatistics.publishments             += hour->publishments;
+   totalStatistics.failedPublishments       += hour->failedPublishments;
+   totalStatistics.attempts                 += hour->attempts;
+   totalStatistics.drainedEnvelopes         += hour->drainedEnvelopes;
+   totalStatistics.duplicateRecords         += hour->duplicateRecords;
+   totalStatistics.maxBacklog                = (hour->maxBacklog > totalStatistics.maxBacklog) ? hour->maxBacklog : totalStatistics.maxBacklog;
+   totalStatistics.peakHeapBytes             = (hour->peakHeapBytes > totalStatistics.peakHeapBytes) ? hour->peakHeapBytes : totalStatistics.peakHeapBytes;
+   totalStatistics.latencyCount             += hour->latencyCount;
+   totalStatistics.maxLatencyMs              = (hour->maxLatencyMs > totalStatistics.maxLatencyMs) ? hour->maxLatencyMs : totalStatistics.maxLatencyMs;
+   for (int bucket = 0; bucket < PUBLISH_LATENCY_BUCKET_COUNT; bucket++) {
+      totalStatistics.latencyHistogram[bucket] += hour->latencyHistogram[bucket];
+   }
+}
+
+static void printHeader() {
+   if (configuration.csv) {
+      printf("hour,pulses,pulses_lost_debounce,pulses_lost_between_samples,samples,samples_discarded,samples_missed,drift_ms,"
+         "messages,messages_overwritten,messages_delivered,publishments,failed_publishments,attempts,latency_p50_ms,latency_p95_ms,"
+         "latency_max_ms,max_backlog,live_heap_bytes,peak_heap_bytes,drained_envelopes,duplicate_records\n");
+   }
+}
+
+static void printHour(int hour, const STATISTICS *statistics, int64_t driftMs) {
+   if (configuration.csv) {
+      printf("%d,%llu,%llu,%llu,%u,%u,%u,%lld,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%ld,%ld,%u,%u\n", hour, (unsigned long long)statistics->pulsesGenerated,
+         (unsigned long long)statistics->pulsesLostByDebounce, (unsigned long long)statistics->pulsesLostBetweenSamples, statistics->samplesStored,
+         statistics->samplesDiscarded, statistics->samplesMissed, (long long)driftMs, statistics->messagesRecorded, statistics->messagesOverwritten,
+         statistics->messagesDelivered, statistics->publishments, statistics->failedPublishments, statistics->attempts, getPercentileMs(statistics, 50),
+         getPercentileMs(statistics, 95), statistics->maxLatencyMs, statistics->maxBacklog, getLiveHeapBytes(), statistics->peakHeapBytes,
+         statistics->drainedEnvelopes, statistics->duplicateRecords);
+   }
+}
+
+static void printSummary(int64_t driftMs) {
+   const STATISTICS *total                    = &totalStatistics;
+   const LIVE_LATENCY_STATISTICS *liveLatency = getLiveLatencyStatistics();
+   FILE *output                               = configuration.csv ? stderr : stdout;
+
+   fprintf(output, "simulated days:         %d\n", configuration.days);
+   fprintf(output, "pulses:                 %llu generated, %llu counted, %llu lost by debouncing, %llu lost between samples\n",
+      (unsigned long long)total->pulsesGenerated, (unsigned long long)total->pulsesCounted, (unsigned long long)total->pulsesLostByDebounce,
+      (unsigned long long)total->pulsesLostBetweenSamples);
+   fprintf(output, "samples:                %u stored, %u discarded, %u missed (waiting for the main loop)\n", total->samplesStored,
+      total->samplesDiscarded, total->samplesMissed);
+   fprintf(output, "drift:                  %lld ms\n", (long long)driftMs);
+   fprintf(output, "messages:               %u recorded, %u delivered, %u overwritten, max backlog %u\n", total->messagesRecorded,
+      total->messagesDelivered, total->messagesOverwritten, total->maxBacklog);
+   fprintf(output, "publishments:           %u (%u failed, %u attempts)\n", total->publishments, total->failedPublishments, total->attempts);
+   fprintf(output, "publish latency:        p50 %u ms, p95 %u ms, max %u ms\n", getPercentileMs(total, 50), getPercentileMs(total, 95),
+      total->maxLatencyMs);
+   fprintf(output, "live data latency:      smoothed %u ms, max %u ms (%u delivered, %u superseded)\n", liveLatency->smoothedMs, 
+      liveLatency->maxMs, liveLatency->deliveries, liveLatency->superseded);
+   fprintf(output, "backlog:                %u envelopes drained, %u records received twice by the service\n", total->drainedEnvelopes,
+      total->duplicateRecords);
+   fprintf(output, "heap:                   %ld bytes in use, peak %ld bytes\n", getLiveHeapBytes(), total->peakHeapBytes);
+}
+
+static bool parseArguments(int argc, char* argv[]) {
+   for (int i = 1; i < argc; i++) {
+      const char *value = (i + 1 < argc) ? argv[i + 1] : "";
+      if (strcmp(argv[i], "--csv") == 0) {
+         configuration.csv = true;
+         continue;
+      } else if (strcmp(argv[i], "--days") == 0) {
+         configuration.days = atoi(value);
+      } else if (strcmp(argv[i], "--seed") == 0) {
+         configuration.seed = strtoul(value, NULL, 10);
+      } else if (strcmp(argv[i], "--tick-ms") == 0) {
+         configuration.tickUs = atoi(value) * US_PER_MS;
+      } else if (strcmp(argv[i], "--sample-overhead-us") == 0) {
+         configuration.sampleOverheadUs = strtoul(value, NULL, 10);
+      } else if (strcmp(argv[i], "--signal") == 0) {
+         configuration.goodSignal = strcmp(value, "poor") != 0;
+      } else if (strcmp(argv[i], "--order") == 0) {
+         configuration.order = (strcmp(value, "oldest") == 0) ? PUBLISH_ORDER_OLDEST_FIRST : PUBLISH_ORDER_NEWEST_FIRST;
+      } else if (strcmp(argv[i], "--drain") == 0) {
+         configuration.drain = strcmp(value, "off") != 0;
+      } else if (strcmp(argv[i], "--ack") == 0) {
+         configuration.acknowledge = strcmp(value, "off") != 0;
+      } else if (strcmp(argv[i], "--envelope-bytes") == 0) {
+         configuration.envelopeBytes = strtoul(value, NULL, 10);
+      } else if (strcmp(argv[i], "--wind") == 0) {
+         configuration.wind = (strcmp(value, "calm") == 0) ? WIND_CALM : (strcmp(value, "storm") == 0 ? WIND_STORM : WIND_GUSTY);
+      } else if (strcmp(argv[i], "--uplink") == 0) {
+         configuration.uplink = (strcmp(value, "flaky") == 0) ? UPLINK_FLAKY : (strcmp(value, "outage") == 0 ? UPLINK_OUTAGE : UPLINK_STEADY);
+      } else {
+         return false;
+      }
+      i++;
+   }
+   return configuration.days > 0 && configuration.tickUs > 0 && configuration.seed != 0;
+}
+
+int main(int argc, char* argv[]) {
+   if (!parseArguments(argc, argv)) {
+      fprintf(stderr, "usage: %s [--days N] [--wind calm|gusty|storm] [--uplink steady|flaky|outage] [--signal good|poor] [--seed N] "
+         "[--order newest|oldest] [--drain on|off] [--ack on|off] [--envelope-bytes N] [--tick-ms N] [--sample-overhead-us N] [--csv]\n", argv[0]);
+      return 2;
+   }
+
+   randomState = configuration.seed;
+   if (configuration.envelopeBytes == 0) {
+      configuration.envelopeBytes = getEnvelopeByteBudget(MAX_DATA_LENGTH, HEAP_SIZE, ARENA_SIZE, 0);
+   }
+   initializePendingMessages(&pendingMessages);
+   clearErrorMessages();
+   resetCircuitBreaker(&breaker);
+   startSampleWindow(0);
+   printHeader();
+
+   uint64_t nextMainLoopUs = MAIN_LOOP_PERIOD_US;
+   uint64_t endUs          = configuration.days * 24 * US_PER_HOUR;
+   uint64_t nextHourUs     = US_PER_HOUR;
+   int hour                = 0;
+   int64_t driftMs         = 0;
+
+   resetPeakHeapBytes();
+   while (nextHourUs <= endUs) {
+      uint64_t nowUs = (nextSampleUs < nextMainLoopUs) ? nextSampleUs : nextMainLoopUs;
+
+      if (nowUs >= nextHourUs) {
+         hourStatistics.peakHeapBytes = getPeakHeapBytes();
+         driftMs                      = getDriftMs(nextHourUs, totalStatistics.samplesStored + hourStatistics.samplesStored);
+         printHour(hour++, &hourStatistics, driftMs);
+         addToTotal(&hourStatistics);
+         memset(&hourStatistics, 0, sizeof(hourStatistics));
+         resetPeakHeapBytes();
+         nextHourUs += US_PER_HOUR;
+         continue;
+      }
+
+      if (nowUs == nextSampleUs) {
+         takeSample(nowUs);
+      } else {
+         runMainLoop(nowUs);
+         nextMainLoopUs += MAIN_LOOP_PERIOD_US;
+      }
+   }
+
+   printSummary(driftMs);
+   release(jsonEnvelope);
+   clearPendingMessages(&pendingMessages);
+   return 0;
+}
\ No newline at end of file
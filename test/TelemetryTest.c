@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/Telemetry.h"
+
+static void assertEqual(char const * actual, char const * expected, char const * description) {
+   if (strcmp(actual, expected) != 0) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %s\n", expected);
+      printf("\tactual  : %s\n\n", actual);
+   }
+}
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   assertIntEqual(isTelemetryDue(0), 0, "interval 0 disables the telemetry");
+   assertIntEqual(isTelemetryDue(3), 1, "first envelope");
+   assertIntEqual(isTelemetryDue(3), 0, "second envelope");
+   assertIntEqual(isTelemetryDue(3), 0, "third envelope");
+   assertIntEqual(isTelemetryDue(3), 1, "fourth envelope");
+   assertIntEqual(getTelemetryEnvelopeCount(), 4, "envelope count");
+   setTelemetryEnvelopeCount(4);
+   assertIntEqual(isTelemetryDue(3), 0, "restored envelope count continues the interval");
+   assertIntEqual(isTelemetryDue(3), 0, "restored envelope count continues the interval (2)");
+   assertIntEqual(isTelemetryDue(3), 1, "restored envelope count continues the interval (3)");
+
+   recordSentBytes(1000);
+   recordSentBytes(234);
+   recordRetry();
+   recordMissedSamples(2);
+   recordMissedSamples(1);
+   const TELEMETRY_COUNTERS *counters = getTelemetryCounters();
+   assertIntEqual(counters->sentBytes, 1234, "sent bytes");
+   assertIntEqual(counters->retries, 1, "retries");
+   assertIntEqual(counters->missedSamples, 3, "missed samples");
+
+   TELEMETRY telemetry;
+   memset(&telemetry, 0, sizeof(TELEMETRY));
+   telemetry.uptimeSeconds          = 3600;
+   telemetry.freeHeapBytes          = 150000;
+   telemetry.minimumFreeHeapBytes   = 120000;
+   telemetry.taskCount              = 2;
+   telemetry.stackHighWaterMarks[0] = 2000;
+   telemetry.stackHighWaterMarks[1] = 1500;
+   telemetry.phaseDurationsMs[PHASE_QUEUED]             = 5;
+   telemetry.phaseDurationsMs[PHASE_REQUEST_TRANSFER]   = 1200;
+   telemetry.liveLatencyMs[0]       = 4200;
+   telemetry.liveLatencyMs[1]       = 5100;
+   telemetry.liveLatencyMs[2]       = 31000;
+   telemetry.transportCount         = 2;
+   telemetry.transports[0].successRate = 1000;
+   telemetry.transports[0].latencyMs   = 8750;
+   telemetry.transports[1].successRate = 750;
+   telemetry.transports[1].latencyMs   = 400;
+   telemetry.rssi                   = 15;
+   telemetry.counters               = *counters;
+
+   char buffer[256];
+   int length = formatTelemetry(buffer, sizeof(buffer), &telemetry);
+   assertEqual(buffer, "{\"up\":3600,\"heap\":[150000,120000],\"stack\":[2000,1500],\"phases\":[5,0,0,0,0,1200,0,0,0,0],\"live\":[4200,5100,31000],\"transports\":[[1000,8750],[750,400]],\"rssi\":15,\"tx\":1234,\"retries\":1,\"missed\":3}", "formatted telemetry");
+   assertIntEqual(length, strlen(buffer), "length of the formatted telemetry");
+   assertIntEqual(formatTelemetry(buffer, 30, &telemetry), -1, "buffer too small");
+   assertIntEqual(formatTelemetry(buffer, length, &telemetry), -1, "no space for the null byte");
+
+   telemetry.taskCount = 0;
+   formatTelemetry(buffer, sizeof(buffer), &telemetry);
+   assertIntEqual(strstr(buffer, "\"stack\":[]") != NULL, 1, "no tasks");
+   telemetry.transportCount = 0;
+   formatTelemetry(buffer, sizeof(buffer), &telemetry);
+   assertIntEqual(strstr(buffer, "\"transports\":[]") != NULL, 1, "no transports");
+
+   resetTelemetry();
+   assertIntEqual(getTelemetryCounters()->sentBytes, 0, "reset counters");
+   assertIntEqual(isTelemetryDue(3), 1, "reset envelope count");
+
+   return 0;
+}
\ No newline at end of file
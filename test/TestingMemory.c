@@ -8,11 +8,48 @@
 static int capturedSizes[CAPTOR_SIZE];
 static int invocationCount = 0;
 
-void* allocate( size_t sizeInBytes ) {
+static uint8_t region[TESTING_ARENA_MAX_SIZE] __attribute__((aligned(ARENA_ALIGNMENT)));
+static ARENA arena;
+static bool arenaInUse = false;
+static HEAP_STATISTICS heapStatistics;
+
+void* allocate( size_t sizeInBytes, AllocationTag tag ) {
    if (invocationCount < CAPTOR_SIZE) {
       capturedSizes[invocationCount++] = sizeInBytes;
    } 
-   return malloc(sizeInBytes);
+   size_t requiredBytes = sizeInBytes + ALLOCATION_HEADER_SIZE;
+   void *storage        = arenaInUse ? allocateFromArena(&arena, requiredBytes) : NULL;
+   storage              = (storage == NULL) ? malloc(requiredBytes) : storage;
+   recordAllocation(tag, sizeInBytes, 0);
+   return writeAllocationHeader(storage, tag, sizeInBytes);
+}
+
+void release( void *pointer ) {
+   if (pointer == NULL) {
+      return;
+   }
+   AllocationTag tag;
+   size_t sizeInBytes;
+   void *storage = readAllocationHeader(pointer, &tag, &sizeInBytes);
+   recordRelease(tag, sizeInBytes);
+
+   if (isInArena(&arena, storage)) {
+      releaseToArena(&arena, storage);
+   } else {
+      free(storage);
+   }
+}
+
+bool finishAllocationCycle() {
+   return resetArena(&arena);
+}
+
+ARENA_STATISTICS getMemoryStatistics() {
+   return arena.statistics;
+}
+
+HEAP_STATISTICS getHeapStatistics() {
+   return heapStatistics;
 }
 
 void resetTestingMemory() {
@@ -28,4 +65,18 @@ int getTestingMemoryInvocationCount() {
 
 int getTestingMemoryInvocation(int index) {
    return (index < 0 || index >= invocationCount) ? -1 : capturedSizes[index];
+}
+
+void useTestingArena(size_t sizeInBytes) {
+   initializeArena(&arena, region, sizeInBytes < TESTING_ARENA_MAX_SIZE ? sizeInBytes : TESTING_ARENA_MAX_SIZE);
+   arenaInUse = true;
+}
+
+void stopUsingTestingArena() {
+   initializeArena(&arena, NULL, 0);
+   arenaInUse = false;
+}
+
+void setTestingHeapStatistics(HEAP_STATISTICS statistics) {
+   heapStatistics = statistics;
 }
\ No newline at end of file
@@ -1,10 +1,39 @@
 #ifndef windsensor_testing_memory_h
 #define windsensor_testing_memory_h
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../main/AllocationStatistics.h"
+#include "../main/Arena.h"
+
+#define TESTING_ARENA_MAX_SIZE   4096
+
+/**
+ * Allocates size bytes of uninitialized storage and records it in the allocation statistics. The storage gets taken 
+ * from the testing arena if it is in use.
+ **/
+void* allocate( size_t sizeInBytes, AllocationTag tag );
+
+/**
+ * Releases storage returned by allocate(...).
+ **/
+void release( void *pointer );
+
+/**
+ * Resets the testing arena. Returns false if storage of the arena is still in use.
+ **/
+bool finishAllocationCycle();
+
 /**
- * Allocates size bytes of uninitialized storage.
+ * Returns the usage of the testing arena.
  **/
-void* allocate( size_t sizeInBytes );
+ARENA_STATISTICS getMemoryStatistics();
+
+/**
+ * Returns the heap statistics provided by setTestingHeapStatistics(...).
+ **/
+HEAP_STATISTICS getHeapStatistics();
 
 /**
  * Resets the argument capture.
@@ -21,4 +50,20 @@ int getTestingMemoryInvocationCount();
  **/
 int getTestingMemoryInvocation(int index);
 
+/**
+ * Subsequent allocations use an arena of the provided size (at most TESTING_ARENA_MAX_SIZE) and fall back to the 
+ * heap if it is exhausted.
+ **/
+void useTestingArena(size_t sizeInBytes);
+
+/**
+ * Subsequent allocations use the heap.
+ **/
+void stopUsingTestingArena();
+
+/**
+ * Defines the value getHeapStatistics() returns.
+ **/
+void setTestingHeapStatistics(HEAP_STATISTICS statistics);
+
 #endif
\ No newline at end of file
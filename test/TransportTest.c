@@ -0,0 +1,87 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/Transport.h"
+
+static TRANSPORT gsm  = { .name = "gsm" };
+static TRANSPORT wifi = { .name = "wifi" };
+
+static void assertIntEqual(int actual, int expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %d\n", expected);
+      printf("\tactual  : %d\n\n", actual);
+   }
+}
+
+static void assertSelected(TRANSPORT *actual, TRANSPORT *expected, char const * description) {
+   if (actual != expected) {
+      printf("ERROR: %s\n", description);
+      printf("\texpected: %s\n", (expected == NULL) ? "NULL" : expected->name);
+      printf("\tactual  : %s\n\n", (actual == NULL) ? "NULL" : actual->name);
+   }
+}
+
+int main(int argc, char* argv[]) {  
+
+   assertSelected(selectTransport(NULL, 0), NULL, "no transport registered");
+
+   assertIntEqual(registerTransport(&gsm), 1, "register first transport");
+   assertSelected(selectTransport(NULL, 0), &gsm, "single transport");
+   assertSelected(selectTransport(&gsm, 0), NULL, "single transport excluded");
+
+   assertIntEqual(registerTransport(&wifi), 1, "register second transport");
+   assertIntEqual(registerTransport(&wifi), 0, "too many transports");
+   assertIntEqual(getTransportCount(), 2, "transport count");
+   assertSelected(selectTransport(NULL, 0), &gsm, "first registered transport wins without statistics");
+
+   recordTransportOutcome(&gsm, true, 9000);
+   assertIntEqual(gsm.statistics.successRate, 1000, "first success");
+   assertIntEqual(gsm.statistics.smoothedLatencyMs, 9000, "first latency");
+   assertSelected(selectTransport(NULL, 0), &wifi, "untried transport has no latency");
+
+   recordTransportOutcome(&wifi, true, 400);
+   assertSelected(selectTransport(NULL, 0), &wifi, "lower latency wins");
+   
+   recordTransportOutcome(&wifi, false, 10000);
+   assertIntEqual(wifi.statistics.successRate, 750, "failure reduces success rate");
+   assertIntEqual(wifi.statistics.smoothedLatencyMs, 400, "failures do not influence latency");
+   assertSelected(selectTransport(NULL, 0), &gsm, "higher success rate wins");
+   assertSelected(selectTransport(&gsm, 0), &wifi, "failover to the other transport");
+
+   recordTransportOutcome(&gsm, true, 7000);
+   assertIntEqual(gsm.statistics.smoothedLatencyMs, 8750, "latency gets smoothed");
+   recordTransportOutcome(&gsm, false, 10000);
+   recordTransportOutcome(&wifi, true, 400);
+   assertSelected(selectTransport(NULL, 0), &wifi, "similar success rate and lower latency wins");
+
+   recordUplinkOutcome(&wifi.breaker, FAILURE_MODEM_UNRESPONSIVE, 1000);
+   assertSelected(selectTransport(NULL, 1000), &gsm, "transport with open circuit breaker does not get selected");
+   assertSelected(selectTransport(&gsm, 1000), NULL, "no transport available");
+   assertSelected(selectTransport(NULL, 1000 + INITIAL_COOLDOWN_MS), &wifi, "transport available again after cooldown");
+
+   for (int i = 0; i < 10; i++) {
+      recordTransportOutcome(&gsm, false, 10000);
+   }
+   assertSelected(selectTransport(&wifi, 1000 + INITIAL_COOLDOWN_MS), &gsm, "failing transport gets selected when it is the only one");
+   for (int i = 0; i < PROBE_INTERVAL; i++) {
+      assertSelected(selectTransport(NULL, 1000 + INITIAL_COOLDOWN_MS), &wifi, "failing transport does not get selected");
+   }
+   assertSelected(selectTransport(NULL, 1000 + INITIAL_COOLDOWN_MS), &gsm, "unused transport gets probed");
+   assertSelected(selectTransport(NULL, 1000 + INITIAL_COOLDOWN_MS), &wifi, "probing happens once");
+
+   assertIntEqual(getMaxTransportDataLength(), 0, "no transport limits the data");
+   gsm.maxDataLength = 4000;
+   assertIntEqual(getMaxTransportDataLength(), 4000, "limit of a single transport");
+   wifi.maxDataLength = 3000;
+   assertIntEqual(getMaxTransportDataLength(), 3000, "smallest limit wins");
+
+   removeAllTransports();
+   assertIntEqual(getTransportCount(), 0, "all transports removed");
+   assertIntEqual(getMaxTransportDataLength(), 0, "no limit without transports");
+
+   return 0;
+}
\ No newline at end of file